@@ -1,13 +1,32 @@
 INCLUDEPATH += $$PWD
 
 SOURCES += \
+    $$PWD/arena.cpp \
+    $$PWD/bufferpool.cpp \
+    $$PWD/crc32.cpp \
+    $$PWD/fragmenter.cpp \
+    $$PWD/frameassembler.cpp \
+    $$PWD/interface.cpp \
+    $$PWD/latencyhistogram.cpp \
+    $$PWD/packageview.cpp \
     $$PWD/parser.cpp
 
 HEADERS += \
+    $$PWD/arena.h \
+    $$PWD/bufferpool.h \
     $$PWD/coords.h \
+    $$PWD/crc32.h \
+    $$PWD/fragmenter.h \
+    $$PWD/frameassembler.h \
     $$PWD/global.h \
     $$PWD/interface.h \
+    $$PWD/latencyhistogram.h \
+    $$PWD/packageview.h \
     $$PWD/parser.h \
+    $$PWD/policyqueue.h \
     $$PWD/protocol.h \
+    $$PWD/schema.h \
+    $$PWD/smallvector.h \
+    $$PWD/spscqueue.h \
     $$PWD/structs.h
 
@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <new>
+
+#include "arena.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_ARENA_CPP
+#define GF_ARENA_CPP
+
+    Arena::Arena(size_t _blockSize):
+        blockSize(_blockSize > 0 ? _blockSize : 1)
+    {
+    }
+
+    Arena::~Arena()
+    {
+        for (const Block &block: blocks)
+            ::operator delete(block.data);
+    }
+
+    void *Arena::allocate(size_t size, size_t align)
+    {
+        while (current < blocks.size())
+        {
+            const Block &block = blocks[current];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+            const size_t start = static_cast<size_t>(((base + offset + align - 1) & ~(uintptr_t(align) - 1)) - base);
+
+            if (start + size <= block.size)
+            {
+                offset = start + size;
+                usedBytes += size;
+                return block.data + start;
+            }
+
+            // Следующий блок (после reset() блоки используются повторно)
+            current++;
+            offset = 0;
+        }
+
+        // Рабочий объем арены еще не достигнут
+        const size_t needed = size + align;
+        const size_t newSize = needed > blockSize ? needed : blockSize;
+        blocks.push_back(Block{static_cast<char *>(::operator new(newSize)), newSize});
+        current = blocks.size() - 1;
+        offset = 0;
+
+        return allocate(size, align);
+    }
+
+    void Arena::reset()
+    {
+        current = 0;
+        offset = 0;
+        usedBytes = 0;
+    }
+
+    size_t Arena::capacity() const
+    {
+        size_t result = 0;
+        for (const Block &block: blocks)
+            result += block.size;
+
+        return result;
+    }
+
+#endif // GF_ARENA_CPP
+
+} // namespace GroupFlight
@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <vector>
+
+namespace GroupFlight
+{
+
+#ifndef GF_ARENA_H
+#define GF_ARENA_H
+
+    //! \brief Арена: выделение памяти сдвигом указателя и освобождение всего сразу
+    //! Используется для временных данных разбора одной порции принятых пакетов:
+    //! после обработки порции вызывается reset(), и память переиспользуется без обращения к куче.
+    //! Новые блоки выделяются только пока арена не достигла рабочего объема
+    class Arena
+    {
+    public:
+        explicit Arena(size_t blockSize = 64 * 1024);
+        ~Arena();
+
+        Arena(const Arena &) = delete;
+        Arena &operator=(const Arena &) = delete;
+
+        //! \brief Выделение size байт с выравниванием align (степень двойки)
+        void *allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+        template<typename T>
+        T *allocate(size_t count) { return static_cast<T *>(allocate(count * sizeof(T), alignof(T))); }
+
+        //! \brief Освобождение всех выделений; блоки сохраняются для следующей порции
+        void reset();
+
+        //! \brief Выделено байт с последнего reset()
+        size_t used() const { return usedBytes; }
+
+        //! \brief Общий объем блоков
+        size_t capacity() const;
+
+    private:
+        struct Block
+        {
+            char *data;
+            size_t size;
+        };
+
+        std::vector<Block> blocks;
+        size_t current = 0;     // Блок, из которого идет выделение
+        size_t offset = 0;      // Занято в текущем блоке
+        size_t usedBytes = 0;
+        size_t blockSize;
+    };
+
+    //! \brief Распределитель памяти для стандартных контейнеров поверх арены
+    //! Освобождение отдельных элементов не выполняется: память возвращается при Arena::reset(),
+    //! поэтому контейнер не должен использоваться после сброса арены
+    template<typename T>
+    class ArenaAllocator
+    {
+    public:
+        using value_type = T;
+
+        explicit ArenaAllocator(Arena &_arena): arena(&_arena){}
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U> &other): arena(other.arena){}
+
+        T *allocate(size_t count) { return arena->allocate<T>(count); }
+        void deallocate(T *, size_t){}
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+    private:
+        template<typename U> friend class ArenaAllocator;
+
+        Arena *arena;
+    };
+
+#endif // GF_ARENA_H
+
+} // namespace GroupFlight
@@ -0,0 +1,30 @@
+#include "bufferpool.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_BUFFERPOOL_CPP
+#define GF_BUFFERPOOL_CPP
+
+    PacketBufferPool::PacketBufferPool(size_t count, size_t _slabSize):
+        slabSize(_slabSize > 0 ? _slabSize : k_maxPackageSize),
+        memory(count * slabSize)
+    {
+        // Вектор свободных буферов заполнен заранее: push_back при возврате не выделяет память
+        freeList.reserve(count);
+        for (size_t i = count; i > 0; i--)
+            freeList.push_back(memory.data() + (i - 1) * slabSize);
+    }
+
+    PacketBufferPool::Buffer PacketBufferPool::acquire()
+    {
+        if (freeList.empty()) return Buffer();
+
+        char *slab = freeList.back();
+        freeList.pop_back();
+        return Buffer(this, slab);
+    }
+
+#endif // GF_BUFFERPOOL_CPP
+
+} // namespace GroupFlight
@@ -0,0 +1,96 @@
+#include <cstddef>
+#include <vector>
+
+#include "protocol.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_BUFFERPOOL_H
+#define GF_BUFFERPOOL_H
+
+    //! \brief Пул буферов приема фиксированного размера (по умолчанию k_maxPackageSize)
+    //! Память под все буферы выделяется при создании пула, выдача и возврат буфера
+    //! не обращаются к куче. Пул не потокобезопасен
+    class PacketBufferPool
+    {
+    public:
+        //! \brief Буфер из пула; возвращается в пул при уничтожении
+        class Buffer
+        {
+        public:
+            Buffer(): pool(nullptr), slab(nullptr), length(0){}
+            ~Buffer(){ release(); }
+
+            Buffer(Buffer &&other): pool(other.pool), slab(other.slab), length(other.length)
+            { other.pool = nullptr; other.slab = nullptr; other.length = 0; }
+
+            Buffer &operator=(Buffer &&other)
+            {
+                if (this != &other)
+                {
+                    release();
+                    pool = other.pool; slab = other.slab; length = other.length;
+                    other.pool = nullptr; other.slab = nullptr; other.length = 0;
+                }
+                return *this;
+            }
+
+            Buffer(const Buffer &) = delete;
+            Buffer &operator=(const Buffer &) = delete;
+
+            //! Пул исчерпан - буфер пуст
+            explicit operator bool() const { return slab != nullptr; }
+
+            char *data() { return slab; }
+            const char *data() const { return slab; }
+            size_t capacity() const { return pool ? pool->slabSize : 0; }
+
+            //! Размер записанных данных
+            size_t size() const { return length; }
+            void setSize(size_t size) { length = size; }
+
+            //! \brief Досрочный возврат буфера в пул
+            void release()
+            {
+                if (pool) pool->release(slab);
+                pool = nullptr;
+                slab = nullptr;
+                length = 0;
+            }
+
+        private:
+            friend class PacketBufferPool;
+
+            Buffer(PacketBufferPool *_pool, char *_slab): pool(_pool), slab(_slab), length(0){}
+
+            PacketBufferPool *pool;
+            char *slab;
+            size_t length;
+        };
+
+        explicit PacketBufferPool(size_t count = 64, size_t slabSize = k_maxPackageSize);
+
+        PacketBufferPool(const PacketBufferPool &) = delete;
+        PacketBufferPool &operator=(const PacketBufferPool &) = delete;
+
+        //! \brief Получение свободного буфера (пустой буфер, если все буферы заняты)
+        Buffer acquire();
+
+        //! \brief Количество свободных буферов
+        size_t available() const { return freeList.size(); }
+
+        size_t count() const { return memory.size() / slabSize; }
+        size_t bufferSize() const { return slabSize; }
+
+    private:
+        void release(char *slab) { freeList.push_back(slab); }
+
+        size_t slabSize;
+        std::vector<char> memory;
+        std::vector<char *> freeList;
+    };
+
+#endif // GF_BUFFERPOOL_H
+
+} // namespace GroupFlight
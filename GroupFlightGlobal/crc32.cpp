@@ -0,0 +1,310 @@
+#include <atomic>
+
+#include "crc32.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define GF_CRC32_X86
+#include <emmintrin.h>
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define GF_CRC32_TARGET
+#else
+#include <cpuid.h>
+#define GF_CRC32_TARGET __attribute__((target("sse4.1,pclmul")))
+#endif
+#endif
+
+namespace GroupFlight
+{
+
+#ifndef GF_CRC32_CPP
+#define GF_CRC32_CPP
+
+    namespace
+    {
+        constexpr uint32_t k_polynomial = 0xEDB88320UL;     // Отраженный полином IEEE 802.3
+        constexpr int k_slices = 16;                        // Количество таблиц для slicing-by-16
+
+        //! Таблицы для slicing-by-N: table[0] - классическая побайтовая таблица,
+        //! table[k][i] - CRC байта i, за которым следуют k нулевых байт
+        struct Crc32Tables
+        {
+            uint32_t table[k_slices][256];
+        };
+
+        constexpr Crc32Tables makeTables()
+        {
+            Crc32Tables result{};
+
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t crc = i;
+                for (int j = 0; j < 8; j++)
+                    crc = (crc & 1) ? ((crc >> 1) ^ k_polynomial) : (crc >> 1);
+                result.table[0][i] = crc;
+            }
+
+            for (int k = 1; k < k_slices; k++)
+                for (int i = 0; i < 256; i++)
+                {
+                    const uint32_t prev = result.table[k - 1][i];
+                    result.table[k][i] = (prev >> 8) ^ result.table[0][prev & 0xFF];
+                }
+
+            return result;
+        }
+
+        constexpr Crc32Tables k_tables = makeTables();
+
+        static_assert(k_tables.table[0][1] == 0x77073096UL, "CRC32 table is broken");
+        static_assert(k_tables.table[0][255] == 0x2D02EF8DUL, "CRC32 table is broken");
+
+        inline uint32_t load32(const unsigned char *p)
+        {
+            return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                   (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        }
+
+        uint32_t updateTable(uint32_t crc, const unsigned char *buf, size_t len)
+        {
+            const auto &t = k_tables.table[0];
+            while (len--)
+                crc = t[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+            return crc;
+        }
+
+        uint32_t updateSlice8(uint32_t crc, const unsigned char *buf, size_t len)
+        {
+            const auto &t = k_tables.table;
+
+            while (len >= 8)
+            {
+                const uint32_t one = load32(buf) ^ crc;
+                const uint32_t two = load32(buf + 4);
+                crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+                      t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+                buf += 8;
+                len -= 8;
+            }
+
+            return updateTable(crc, buf, len);
+        }
+
+        uint32_t updateSlice16(uint32_t crc, const unsigned char *buf, size_t len)
+        {
+            const auto &t = k_tables.table;
+
+            while (len >= 16)
+            {
+                const uint32_t one = load32(buf) ^ crc;
+                const uint32_t two = load32(buf + 4);
+                const uint32_t three = load32(buf + 8);
+                const uint32_t four = load32(buf + 12);
+                crc = t[15][one & 0xFF] ^ t[14][(one >> 8) & 0xFF] ^ t[13][(one >> 16) & 0xFF] ^ t[12][one >> 24] ^
+                      t[11][two & 0xFF] ^ t[10][(two >> 8) & 0xFF] ^ t[9][(two >> 16) & 0xFF] ^ t[8][two >> 24] ^
+                      t[7][three & 0xFF] ^ t[6][(three >> 8) & 0xFF] ^ t[5][(three >> 16) & 0xFF] ^ t[4][three >> 24] ^
+                      t[3][four & 0xFF] ^ t[2][(four >> 8) & 0xFF] ^ t[1][(four >> 16) & 0xFF] ^ t[0][four >> 24];
+                buf += 16;
+                len -= 16;
+            }
+
+            return updateSlice8(crc, buf, len);
+        }
+
+#ifdef GF_CRC32_X86
+        //! Минимальный размер данных, с которого выгодна свертка через PCLMULQDQ
+        constexpr size_t k_pclmulMinSize = 64;
+
+        //! Свертка блоков по 16 байт (Intel, "Fast CRC Computation for Generic Polynomials
+        //! Using PCLMULQDQ Instruction"), константы для отраженного полинома 0xEDB88320.
+        //! len >= 64 и кратно 16, crc - внутреннее (инвертированное) состояние
+        GF_CRC32_TARGET uint32_t foldPclmul(uint32_t crc, const unsigned char *buf, size_t len)
+        {
+            alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+            alignas(16) static const uint64_t k3k4[] = { 0x01751997d0ULL, 0x00ccaa009eULL };
+            alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124ULL, 0x0000000000ULL };
+            alignas(16) static const uint64_t poly[] = { 0x01db710641ULL, 0x01f7011641ULL };
+
+            __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+            x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x00));
+            x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x10));
+            x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x20));
+            x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x30));
+            x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+            x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k1k2));
+
+            buf += 64;
+            len -= 64;
+
+            // Параллельная свертка четырех потоков по 64 байта
+            while (len >= 64)
+            {
+                x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+                x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+                x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+                x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+                x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+                x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+                x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+                x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+                y5 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x00));
+                y6 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x10));
+                y7 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x20));
+                y8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + 0x30));
+
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+                x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+                x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+                x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+                buf += 64;
+                len -= 64;
+            }
+
+            // Свертка четырех потоков в один 128-битный
+            x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(k3k4));
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+            x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+            // Оставшиеся блоки по 16 байт
+            while (len >= 16)
+            {
+                x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf));
+
+                x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+                x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+                x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+                buf += 16;
+                len -= 16;
+            }
+
+            // Свертка 128 -> 64 бит
+            x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+            x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+            x1 = _mm_srli_si128(x1, 8);
+            x1 = _mm_xor_si128(x1, x2);
+
+            x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(k5k0));
+
+            x2 = _mm_srli_si128(x1, 4);
+            x1 = _mm_and_si128(x1, x3);
+            x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            // Редукция Барретта до 32 бит
+            x0 = _mm_load_si128(reinterpret_cast<const __m128i *>(poly));
+
+            x2 = _mm_and_si128(x1, x3);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+            x2 = _mm_and_si128(x2, x3);
+            x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+            x1 = _mm_xor_si128(x1, x2);
+
+            return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+        }
+
+        uint32_t updatePclmul(uint32_t crc, const unsigned char *buf, size_t len)
+        {
+            if (len >= k_pclmulMinSize)
+            {
+                const size_t chunk = len & ~static_cast<size_t>(15);
+                crc = foldPclmul(crc, buf, chunk);
+                buf += chunk;
+                len -= chunk;
+            }
+
+            return updateSlice16(crc, buf, len);
+        }
+
+        bool isPclmulSupported()
+        {
+#if defined(_MSC_VER)
+            int info[4] = {0, 0, 0, 0};
+            __cpuid(info, 1);
+            const unsigned int ecx = static_cast<unsigned int>(info[2]);
+#else
+            unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+#endif
+            const bool pclmul = (ecx >> 1) & 1;
+            const bool sse41 = (ecx >> 19) & 1;
+            return pclmul && sse41;
+        }
+#else
+        bool isPclmulSupported() { return false; }
+#endif // GF_CRC32_X86
+
+        Crc32Engine detectEngine()
+        {
+            return isPclmulSupported() ? Crc32Engine::Pclmul : Crc32Engine::Slice16;
+        }
+
+        std::atomic<Crc32Engine> &currentEngine()
+        {
+            static std::atomic<Crc32Engine> engine(detectEngine());
+            return engine;
+        }
+
+        uint32_t update(uint32_t crc, const unsigned char *buf, size_t len)
+        {
+            switch (currentEngine().load(std::memory_order_relaxed))
+            {
+            case Crc32Engine::Table: return updateTable(crc, buf, len);
+            case Crc32Engine::Slice8: return updateSlice8(crc, buf, len);
+#ifdef GF_CRC32_X86
+            case Crc32Engine::Pclmul: return updatePclmul(crc, buf, len);
+#endif
+            default: return updateSlice16(crc, buf, len);
+            }
+        }
+    } // namespace
+
+    void Crc32::update(const char *buf, size_t len)
+    {
+        state = GroupFlight::update(state, reinterpret_cast<const unsigned char *>(buf), len);
+    }
+
+    uint32_t Crc32::calculate(const char *buf, size_t len)
+    {
+        Crc32 crc;
+        crc.update(buf, len);
+        return crc.value();
+    }
+
+    Crc32Engine Crc32::engine()
+    {
+        return currentEngine().load(std::memory_order_relaxed);
+    }
+
+    void Crc32::setEngine(Crc32Engine engine)
+    {
+        if (engine == Crc32Engine::Pclmul && !isPclmulSupported())
+            engine = Crc32Engine::Slice16;
+
+        currentEngine().store(engine, std::memory_order_relaxed);
+    }
+
+    unsigned int crc32(const char *buf, unsigned long len)
+    {
+        return Crc32::calculate(buf, len);
+    }
+
+#endif // GF_CRC32_CPP
+
+} // namespace GroupFlight
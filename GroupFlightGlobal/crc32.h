@@ -0,0 +1,56 @@
+#include <cstddef>
+#include <cstdint>
+
+//! Файл описывает расчет контрольной суммы CRC32 (полином 0xEDB88320, IEEE 802.3),
+//! которой защищаются пакеты модуля "GroupFlight"
+
+namespace GroupFlight
+{
+
+#ifndef GF_CRC32_H
+#define GF_CRC32_H
+
+    //! \brief Реализация расчета, выбираемая во время исполнения
+    enum class Crc32Engine : uint8_t
+    {
+        Table,      //!< Побайтовый табличный расчет
+        Slice8,     //!< Программный расчет по 8 байт за шаг (slicing-by-8)
+        Slice16,    //!< Программный расчет по 16 байт за шаг (slicing-by-16)
+        Pclmul      //!< Свертка блоков инструкцией PCLMULQDQ (SSE4.1 + PCLMUL)
+    };
+
+    //! \brief Инкрементальный расчет CRC32
+    //! Данные можно подавать частями, результат совпадает с расчетом по всему буферу сразу
+    class Crc32
+    {
+    public:
+        Crc32(): state(0xFFFFFFFFUL){}
+
+        //! \brief Добавление очередной порции данных
+        void update(const char *buf, size_t len);
+
+        //! \brief Значение контрольной суммы по всем добавленным данным
+        uint32_t value() const { return state ^ 0xFFFFFFFFUL; }
+
+        void reset(){ state = 0xFFFFFFFFUL; }
+
+        //! \brief Расчет контрольной суммы буфера целиком
+        static uint32_t calculate(const char *buf, size_t len);
+
+        //! \brief Реализация, выбранная для текущего процессора
+        static Crc32Engine engine();
+
+        //! \brief Принудительный выбор реализации (для проверки и замеров)
+        //! Если процессор не поддерживает выбранную реализацию, используется Slice16
+        static void setEngine(Crc32Engine engine);
+
+    private:
+        uint32_t state;
+    };
+
+    //! \brief Контрольная сумма CRC32 буфера (обертка над Crc32::calculate)
+    unsigned int crc32(const char *buf, unsigned long len);
+
+#endif // GF_CRC32_H
+
+} // namespace GroupFlight
@@ -0,0 +1,280 @@
+#include <algorithm>
+
+#include "fragmenter.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_FRAGMENTER_CPP
+#define GF_FRAGMENTER_CPP
+
+    namespace
+    {
+        inline const Pair &pairAt(const Package &package, size_t index) { return package.pairs[index]; }
+        inline Pair pairAt(const PackageView &package, size_t index) { return package.pair(index); }
+
+        inline size_t pairsOf(const Package &package) { return package.pairs.size(); }
+        inline size_t pairsOf(const PackageView &package) { return package.pairsCount(); }
+
+        inline const Timestamps &stampsOf(const Package &package) { return package.stamps; }
+        inline const Timestamps &stampsOf(const PackageView &package) { return package.timestamps(); }
+
+        template<typename Source>
+        bool hasFragmentPairs(const Source &package)
+        {
+            return pairsOf(package) >= k_fragmentPairs &&
+                   pairAt(package, 0).key == DataKey::FragmentMessageId &&
+                   pairAt(package, 1).key == DataKey::FragmentIndex &&
+                   pairAt(package, 2).key == DataKey::FragmentCount;
+        }
+
+        //! Сообщение определяется бортом, источником, типом данных и номером сообщения
+        inline uint64_t messageKey(const Header &header, uint16_t messageId)
+        {
+            return static_cast<uint64_t>(header.boardNumber) |
+                   (static_cast<uint64_t>(header.type) << 32) |
+                   (static_cast<uint64_t>(header.source) << 40) |
+                   (static_cast<uint64_t>(messageId) << 48);
+        }
+    } // namespace
+
+    size_t fragment(const Package &source, uint16_t messageId, std::vector<Package> &result, size_t maxPackageSize)
+    {
+        if (maxPackageSize >= k_maxPackageSize) maxPackageSize = k_maxPackageSize - 1;
+
+        const size_t total = source.pairs.size();
+        if (k_headerSize + total * k_valueSize + k_crcSize <= maxPackageSize)
+        {
+            result.push_back(source);
+            return 1;
+        }
+
+        if (maxPackageSize < k_minFragmentSize || total > k_maxMessagePairs) return 0;
+        const size_t limit = (maxPackageSize - k_headerSize - k_crcSize) / k_valueSize - k_fragmentPairs;
+
+        // Границы фрагментов: после последнего разделителя, попавшего в фрагмент
+        std::vector<size_t> bounds;
+        for (size_t begin = 0; begin < total; )
+        {
+            size_t end = std::min(begin + limit, total);
+            if (end < total)
+            {
+                for (size_t i = end; i > begin; i--)
+                    if (source.pairs[i - 1].key == DataKey::Separator) { end = i; break; }
+            }
+
+            bounds.push_back(end);
+            begin = end;
+        }
+
+        if (bounds.size() > k_maxFragments) return 0;
+
+        const uint16_t count = static_cast<uint16_t>(bounds.size());
+        result.reserve(result.size() + count);
+
+        size_t begin = 0;
+        for (uint16_t index = 0; index < count; index++)
+        {
+            result.push_back(Package(source.header));
+            PairList &pairs = result.back().pairs;
+
+            pairs.reserve(k_fragmentPairs + bounds[index] - begin);
+            pairs.push_back(Pair(DataKey::FragmentMessageId, messageId));
+            pairs.push_back(Pair(DataKey::FragmentIndex, index));
+            pairs.push_back(Pair(DataKey::FragmentCount, count));
+            pairs.insert(pairs.end(), source.pairs.begin() + begin, source.pairs.begin() + bounds[index]);
+
+            begin = bounds[index];
+        }
+
+        return count;
+    }
+
+    bool isFragment(const Package &package)
+    {
+        return hasFragmentPairs(package);
+    }
+
+    bool isFragment(const PackageView &package)
+    {
+        return hasFragmentPairs(package);
+    }
+
+    Reassembler::Reassembler(std::chrono::milliseconds _timeout, size_t perBoard, size_t messages):
+        timeout(_timeout), perBoardLimit(std::max<size_t>(perBoard, 1)), messagesLimit(std::max<size_t>(messages, 1))
+    {
+    }
+
+    bool Reassembler::add(const Package &package, Package &result, Clock::time_point now)
+    {
+        if (!hasFragmentPairs(package))
+        {
+            result = package;
+            return true;
+        }
+
+        return addFragment(package.header, package, result, now);
+    }
+
+    bool Reassembler::add(const PackageView &package, Package &result, Clock::time_point now)
+    {
+        if (!hasFragmentPairs(package))
+        {
+            package.toPackage(result);
+            return true;
+        }
+
+        return addFragment(package.header(), package, result, now);
+    }
+
+    template<typename Source>
+    bool Reassembler::addFragment(const Header &header, const Source &package, Package &result, Clock::time_point now)
+    {
+        expire(now);
+
+        const uint16_t messageId = pairAt(package, 0).value;
+        const uint16_t index = pairAt(package, 1).value;
+        const uint16_t count = pairAt(package, 2).value;
+        const size_t size = pairsOf(package) - k_fragmentPairs;
+
+        // Количество фрагментов задает отправитель: больше, чем дает допустимое сообщение, не принимается
+        if (count == 0 || count > k_maxFragments || index >= count) { counters.invalid++; return false; }
+
+        const uint64_t key = messageKey(header, messageId);
+        auto position = messages.find(key);
+
+        // Номер сообщения использован повторно с другим количеством фрагментов - начинаем заново
+        if (position != messages.end() && position->second.count != count)
+        {
+            erase(position);
+            position = messages.end();
+        }
+
+        if (position == messages.end())
+        {
+            reserve(header.boardNumber, size, true);
+
+            position = messages.emplace(key, Message()).first;
+            Message &message = position->second;
+            message.board = header.boardNumber;
+            message.count = count;
+            message.present.resize(count, false);
+            message.position = order.insert(order.end(), key);
+            boards[header.boardNumber]++;
+        }
+        else
+        {
+            Message &message = position->second;
+            if (message.present[index])
+            {
+                counters.duplicates++;
+                return false;
+            }
+
+            if (message.pairsCount + size > k_maxMessagePairs)
+            {
+                counters.invalid++;
+                erase(position);
+                return false;
+            }
+
+            order.splice(order.end(), order, message.position);
+            reserve(header.boardNumber, size, false);
+        }
+
+        Message &message = position->second;
+        message.updated = now;
+
+        message.parts.push_back(Part{index, std::vector<Pair>()});
+        std::vector<Pair> &part = message.parts.back().pairs;
+        part.reserve(size);
+        for (size_t i = k_fragmentPairs; i < pairsOf(package); i++)
+            part.push_back(pairAt(package, i));
+
+        message.present[index] = true;
+        message.pairsCount += size;
+        pairsCount += size;
+
+        if (message.parts.size() < count) return false;
+
+        std::sort(message.parts.begin(), message.parts.end(),
+                  [](const Part &left, const Part &right){ return left.index < right.index; });
+
+        result.header = header;
+        result.stamps = stampsOf(package);
+        result.pairs.clear();
+        result.pairs.reserve(message.pairsCount);
+        for (const Part &value: message.parts)
+            result.pairs.insert(result.pairs.end(), value.pairs.begin(), value.pairs.end());
+
+        erase(position);
+        counters.completed++;
+        return true;
+    }
+
+    size_t Reassembler::expire(Clock::time_point now)
+    {
+        size_t count = 0;
+
+        // Сообщения упорядочены по времени последнего фрагмента: проверяются только устаревшие
+        while (!order.empty())
+        {
+            auto position = messages.find(order.front());
+            if (now - position->second.updated <= timeout) break;
+
+            erase(position);
+            count++;
+        }
+
+        counters.expired += count;
+        return count;
+    }
+
+    void Reassembler::clear()
+    {
+        messages.clear();
+        order.clear();
+        boards.clear();
+        pairsCount = 0;
+    }
+
+    void Reassembler::erase(std::unordered_map<uint64_t, Message>::iterator message)
+    {
+        auto board = boards.find(message->second.board);
+        if (board != boards.end() && --board->second == 0) boards.erase(board);
+
+        pairsCount -= message->second.pairsCount;
+        order.erase(message->second.position);
+        messages.erase(message);
+    }
+
+    void Reassembler::reserve(uint32_t board, size_t pairs, bool opening)
+    {
+        // Место под новое сообщение борта: вытесняется его сообщение, дольше всех не получавшее фрагментов
+        auto open = boards.find(board);
+        if (opening && open != boards.end() && open->second >= perBoardLimit)
+        {
+            for (uint64_t key: order)
+            {
+                auto position = messages.find(key);
+                if (position->second.board != board) continue;
+
+                erase(position);
+                counters.evicted++;
+                break;
+            }
+        }
+
+        // Пополняемое сообщение уже перенесено в конец order и вытесняется последним
+        const size_t keep = opening ? 0 : 1;
+        while (order.size() > keep &&
+               ((opening && messages.size() >= messagesLimit) || pairsCount + pairs > k_maxPendingPairs))
+        {
+            erase(messages.find(order.front()));
+            counters.evicted++;
+        }
+    }
+
+#endif // GF_FRAGMENTER_CPP
+
+} // namespace GroupFlight
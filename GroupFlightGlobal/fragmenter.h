@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "packageview.h"
+#include "protocol.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_FRAGMENTER_H
+#define GF_FRAGMENTER_H
+
+    static const uint8_t k_fragmentPairs = 3;   // Пары номера сообщения, номера фрагмента и количества фрагментов
+    static const size_t k_minFragmentSize = 512;                // Меньший размер фрагмента не поддерживается
+    static const size_t k_maxMessagePairs = 0x10000 * 10;       // Маршрут из 65536 точек (номер точки - 16 бит) по 10 пар
+    static const size_t k_maxFragments = 8192;                  // Фрагментов в сообщении не больше k_maxMessagePairs
+                                                                // при k_minFragmentSize, даже с границами по разделителям
+
+    //! \brief Разбиение пакета на фрагменты, каждый из которых помещается в maxPackageSize
+    //! Пакет, который помещается целиком, передается без изменений. Фрагменты получают заголовок
+    //! исходного пакета и три пары FragmentMessageId, FragmentIndex, FragmentCount в начале;
+    //! граница фрагмента по возможности проходит после разделителя (DataKey::Separator),
+    //! чтобы точки маршрута и области не разрывались
+    //! \param source - исходный пакет
+    //! \param messageId - номер сообщения (должен отличаться у сообщений одного борта, передаваемых одновременно)
+    //! \param result - фрагменты (добавляются в конец)
+    //! \param maxPackageSize - максимальный размер фрагмента после pack(), не меньше k_minFragmentSize
+    //! \return количество фрагментов (0, если пакет нельзя разбить в заданный размер,
+    //! в нем больше k_maxMessagePairs пар или фрагментов получилось бы больше k_maxFragments)
+    size_t fragment(const Package &source, uint16_t messageId, std::vector<Package> &result,
+                    size_t maxPackageSize = k_maxPackageSize - 1);
+
+    //! \brief Является ли пакет фрагментом
+    bool isFragment(const Package &package);
+    bool isFragment(const PackageView &package);
+
+    //! \brief Сборка пакетов из фрагментов
+    //! Фрагменты одного сообщения могут приходить в любом порядке и вперемешку с фрагментами
+    //! других сообщений и бортов. Сообщение, не получившее новых фрагментов за время timeout, отбрасывается.
+    //! Память ограничена независимо от принятых данных: количество фрагментов сообщения - k_maxFragments,
+    //! пар в сообщении - k_maxMessagePairs, пар во всех сообщениях - k_maxPendingPairs; сверх пределов
+    //! сообщений борта и всех сообщений вытесняются те, что дольше не получали фрагментов
+    class Reassembler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        //! Статистика работы сборщика
+        struct Stats
+        {
+            uint64_t completed = 0;     //!< Собрано сообщений
+            uint64_t expired = 0;       //!< Отброшено сообщений по времени
+            uint64_t duplicates = 0;    //!< Повторно принятых фрагментов
+            uint64_t invalid = 0;       //!< Фрагментов с неверными номерами или сверх пределов сообщения
+            uint64_t evicted = 0;       //!< Вытеснено незаконченных сообщений сверх пределов
+        };
+
+        static const size_t k_maxPendingPairs = 4 * k_maxMessagePairs;
+
+        //! \param perBoard - незаконченных сообщений одного борта
+        //! \param messages - незаконченных сообщений всех бортов
+        explicit Reassembler(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000),
+                             size_t perBoard = 4, size_t messages = 256);
+
+        //! \brief Добавление принятого пакета
+        //! Пакет, не являющийся фрагментом, сразу копируется в result
+        //! \return true, если в result собран целый пакет
+        bool add(const Package &package, Package &result, Clock::time_point now = Clock::now());
+        bool add(const PackageView &package, Package &result, Clock::time_point now = Clock::now());
+
+        //! \brief Удаление сообщений, не получавших фрагментов дольше timeout
+        //! \return количество удаленных сообщений
+        size_t expire(Clock::time_point now = Clock::now());
+
+        //! \brief Количество сообщений, ожидающих фрагментов
+        size_t pending() const { return messages.size(); }
+
+        void clear();
+
+        const Stats &stats() const { return counters; }
+
+    private:
+        struct Part
+        {
+            uint16_t index;
+            std::vector<Pair> pairs;
+        };
+
+        struct Message
+        {
+            uint32_t board = 0;
+            uint16_t count = 0;
+            std::vector<Part> parts;            // В порядке приема; память - только под принятые фрагменты
+            std::vector<bool> present;
+            size_t pairsCount = 0;
+            Clock::time_point updated;
+            std::list<uint64_t>::iterator position;
+        };
+
+        template<typename Source>
+        bool addFragment(const Header &header, const Source &package, Package &result, Clock::time_point now);
+
+        void erase(std::unordered_map<uint64_t, Message>::iterator message);
+
+        // Вытеснение сообщений под pairs пар; opening - под новое сообщение борта board
+        void reserve(uint32_t board, size_t pairs, bool opening);
+
+        std::chrono::milliseconds timeout;
+        size_t perBoardLimit;
+        size_t messagesLimit;
+        std::unordered_map<uint64_t, Message> messages;
+        std::list<uint64_t> order;                          // Сообщения по времени последнего фрагмента
+        std::unordered_map<uint32_t, size_t> boards;        // Незаконченных сообщений борта
+        size_t pairsCount = 0;
+        Stats counters;
+    };
+
+#endif // GF_FRAGMENTER_H
+
+} // namespace GroupFlight
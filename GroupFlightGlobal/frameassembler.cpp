@@ -0,0 +1,207 @@
+#include <cstring>
+
+#include "frameassembler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GF_FRAMEASSEMBLER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace GroupFlight
+{
+
+#ifndef GF_FRAMEASSEMBLER_CPP
+#define GF_FRAMEASSEMBLER_CPP
+
+    namespace
+    {
+        inline unsigned int lowestBit(unsigned int mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+        }
+    } // namespace
+
+    const char *findHeader(const char *begin, const char *end)
+    {
+        const char *pos = begin;
+
+#ifdef GF_FRAMEASSEMBLER_SSE2
+        // Сравнение 16 позиций за шаг: байт i совпадает с первым символом маркера,
+        // байт i+1 - со вторым, байт i+2 - с третьим
+        const __m128i symbol1 = _mm_set1_epi8(k_headSymbol1);
+        const __m128i symbol2 = _mm_set1_epi8(k_headSymbol2);
+        const __m128i symbol3 = _mm_set1_epi8(k_headSymbol3);
+
+        while (end - pos >= 18)
+        {
+            const __m128i eq1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos)), symbol1);
+            const __m128i eq2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos + 1)), symbol2);
+            const __m128i eq3 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pos + 2)), symbol3);
+            const unsigned int mask = static_cast<unsigned int>(
+                        _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(eq1, eq2), eq3)));
+
+            if (mask) return pos + lowestBit(mask);
+            pos += 16;
+        }
+#endif
+
+        while (end - pos >= 3)
+        {
+            pos = static_cast<const char *>(memchr(pos, static_cast<unsigned char>(k_headSymbol1),
+                                                   static_cast<size_t>(end - pos - 2)));
+            if (!pos) return end;
+            if (pos[1] == k_headSymbol2 && pos[2] == k_headSymbol3) return pos;
+            pos++;
+        }
+
+        return end;
+    }
+
+    FrameAssembler::FrameAssembler(size_t capacity):
+        buffer(capacity > k_maxPackageSize ? capacity : k_maxPackageSize + 1)
+    {
+    }
+
+    size_t FrameAssembler::freeSpace()
+    {
+        if (head > 0)
+        {
+            memmove(buffer.data(), buffer.data() + head, tail - head);
+            tail -= head;
+            probe = probe > head ? probe - head : 0;
+            head = 0;
+        }
+
+        return buffer.size() - tail;
+    }
+
+    void FrameAssembler::append(const char *data, size_t size)
+    {
+        if (buffer.size() - tail < size && freeSpace() < size)
+            buffer.resize(tail + size);
+
+        memcpy(buffer.data() + tail, data, size);
+        tail += size;
+    }
+
+    void FrameAssembler::drop(size_t count)
+    {
+        head += count;
+        counters.droppedBytes += count;
+    }
+
+    bool FrameAssembler::hasPackageBehind()
+    {
+        if (probe <= head) probe = head + 1;
+
+        PackageView candidate;
+        const char *end = buffer.data() + tail;
+
+        // Первый маркер, пакет за которым еще не пришел целиком: с него проверка продолжится
+        // при следующих данных, а пока поиск идет дальше - за ним могут быть целые пакеты
+        size_t incomplete = tail;
+
+        while (probe < tail)
+        {
+            const char *marker = findHeader(buffer.data() + probe, end);
+            if (marker == end) break;
+
+            const size_t offset = static_cast<size_t>(marker - buffer.data());
+            const size_t available = static_cast<size_t>(end - marker);
+
+            bool whole = available >= k_minPackageSize;
+            if (whole)
+            {
+                const uint16_t packSize = (marker[3] & 0x00ff) | ((marker[4] & 0x00ff) << 8);
+                whole = packSize < k_minPackageSize || available >= packSize;
+            }
+
+            if (!whole)
+            {
+                if (incomplete == tail) incomplete = offset;
+                probe = offset + 1;
+                continue;
+            }
+
+            size_t shift = offset;
+            if (candidate.parse(buffer.data(), tail, shift) == UnpackStatus::Success)
+            {
+                probe = offset;
+                return true;
+            }
+            probe = offset + 1;
+        }
+
+        // Неполный маркер может оказаться в последних двух байтах
+        probe = incomplete < tail ? incomplete : (tail > head + 3 ? tail - 2 : head + 1);
+        return false;
+    }
+
+    bool FrameAssembler::next(PackageView &view)
+    {
+        view.reset();
+
+        while (true)
+        {
+            const char *begin = buffer.data() + head;
+            const char *end = buffer.data() + tail;
+            const char *marker = findHeader(begin, end);
+
+            if (marker == end)
+            {
+                // Неполный маркер может оказаться в последних двух байтах
+                const size_t keep = buffered() < 2 ? buffered() : 2;
+                drop(buffered() - keep);
+                return false;
+            }
+
+            drop(static_cast<size_t>(marker - begin));
+
+            if (buffered() < k_minPackageSize) return false;
+
+            const uint16_t packSize = (marker[3] & 0x00ff) | ((marker[4] & 0x00ff) << 8);
+
+            // Поле размера битое - ищем следующий маркер
+            if (packSize < k_minPackageSize)
+            {
+                counters.resyncs++;
+                drop(1);
+                continue;
+            }
+
+            // Пакет еще не пришел целиком. Если за ним в буфере уже есть целый пакет
+            // с верной контрольной суммой, то поле размера текущего пакета битое
+            if (buffered() < packSize)
+            {
+                if (!hasPackageBehind()) return false;
+
+                counters.resyncs++;
+                drop(1);
+                continue;
+            }
+
+            size_t shift = head;
+            const UnpackStatus status = view.parse(buffer.data(), tail, shift);
+
+            if (status == UnpackStatus::Success)
+            {
+                head = shift;
+                counters.packages++;
+                return true;
+            }
+
+            if (status == UnpackStatus::WrongCrc) counters.crcErrors++;
+            counters.resyncs++;
+            drop(1);
+        }
+    }
+
+#endif // GF_FRAMEASSEMBLER_CPP
+
+} // namespace GroupFlight
@@ -0,0 +1,89 @@
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "packageview.h"
+#include "protocol.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_FRAMEASSEMBLER_H
+#define GF_FRAMEASSEMBLER_H
+
+    //! \brief Поиск маркера начала пакета (0xB0 0x3B 0x7E) в диапазоне [begin, end)
+    //! \return указатель на первый байт маркера или end, если полный маркер не найден
+    const char *findHeader(const char *begin, const char *end);
+
+    //! \brief Сборщик пакетов из потока байт (TCP)
+    //! Принимает данные порциями произвольного размера, выделяет из них целые пакеты,
+    //! а после битого пакета ищет следующий маркер, не теряя пакетов за ним
+    class FrameAssembler
+    {
+    public:
+        //! Статистика работы сборщика
+        struct Stats
+        {
+            uint64_t packages = 0;      //!< Выделено целых пакетов
+            uint64_t resyncs = 0;       //!< Восстановлений синхронизации после битого пакета
+            uint64_t crcErrors = 0;     //!< Пакетов с неверной контрольной суммой
+            uint64_t droppedBytes = 0;  //!< Отброшено байт вне пакетов
+        };
+
+        explicit FrameAssembler(size_t capacity = 2 * k_maxPackageSize);
+
+        //! \brief Добавление порции данных в буфер
+        void append(const char *data, size_t size);
+
+        //! \brief Выделение очередного целого пакета из буфера
+        //! Представление действительно до следующего вызова append() или clear()
+        //! \return false, если для следующего пакета пока недостаточно данных
+        bool next(PackageView &view);
+
+        //! \brief Добавление порции данных и передача всех выделенных пакетов в callback(const PackageView &)
+        //! \return количество выделенных пакетов
+        template<typename Callback>
+        size_t feed(const char *data, size_t size, Callback callback)
+        {
+            size_t count = 0;
+            PackageView view;
+
+            while (size > 0)
+            {
+                const size_t chunk = freeSpace() < size ? freeSpace() : size;
+                append(data, chunk);
+                data += chunk;
+                size -= chunk;
+
+                while (next(view))
+                {
+                    callback(static_cast<const PackageView &>(view));
+                    count++;
+                }
+            }
+
+            return count;
+        }
+
+        //! \brief Объем данных, ожидающих продолжения пакета
+        size_t buffered() const { return tail - head; }
+
+        void clear(){ head = tail = probe = 0; }
+
+        const Stats &stats() const { return counters; }
+
+    private:
+        size_t freeSpace();
+        void drop(size_t count);
+        bool hasPackageBehind();
+
+        std::vector<char> buffer;
+        size_t head = 0;
+        size_t tail = 0;
+        size_t probe = 0;   // Позиция, до которой буфер уже проверен hasPackageBehind()
+        Stats counters;
+    };
+
+#endif // GF_FRAMEASSEMBLER_H
+
+} // namespace GroupFlight
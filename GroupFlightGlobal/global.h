@@ -1,5 +1,16 @@
+#include "arena.h"
+#include "bufferpool.h"
 #include "coords.h"
+#include "crc32.h"
+#include "fragmenter.h"
+#include "frameassembler.h"
 #include "interface.h"
+#include "latencyhistogram.h"
+#include "packageview.h"
 #include "parser.h"
+#include "policyqueue.h"
 #include "protocol.h"
+#include "schema.h"
+#include "smallvector.h"
+#include "spscqueue.h"
 #include "structs.h"
@@ -0,0 +1,175 @@
+#include "interface.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_INTERFACE_CPP
+#define GF_INTERFACE_CPP
+
+    namespace
+    {
+        thread_local bool t_workerThread = false;
+    } // namespace
+
+    AsyncWorker::AsyncWorker(Handler *_target, size_t capacity, QueuePolicy policy, LatencyTracker *_latency):
+        target(_target), latency(_latency), queue(capacity, policy, capacity)
+    {
+        thread = std::thread(&AsyncWorker::run, this);
+    }
+
+    AsyncWorker::~AsyncWorker()
+    {
+        queue.close();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping.store(true, std::memory_order_relaxed);
+        }
+        condition.notify_one();
+
+        if (thread.joinable()) thread.join();
+    }
+
+    bool AsyncWorker::push(const std::shared_ptr<const Package> &package)
+    {
+        Item item;
+        item.package = package;
+
+        // Вытесняется только телеметрия: ее следующий пакет все равно заменит пропущенный
+        const bool telemetry = package && package->header.type == DataType::Telemetry;
+        return push(std::move(item), telemetry, package ? package->header.boardNumber : 0);
+    }
+
+    bool AsyncWorker::push(const std::shared_ptr<const std::vector<char>> &data)
+    {
+        Item item;
+        item.data = data;
+        return push(std::move(item), false, 0);
+    }
+
+    bool AsyncWorker::push(Item &&item, bool lossy, uint32_t board)
+    {
+        if (!queue.push(std::move(item), lossy, board)) return false;
+
+        // Будить поток нужно, только если он уснул; барьер парный барьеру в run()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            condition.notify_one();
+        }
+
+        return true;
+    }
+
+    AsyncWorker::Stats AsyncWorker::stats() const
+    {
+        const PolicyQueue<Item>::Stats queueStats = queue.stats();
+
+        Stats result;
+        result.delivered = deliveredCount.load(std::memory_order_relaxed);
+        result.dropped = queueStats.dropped;
+        result.coalesced = queueStats.coalesced;
+        result.blocked = queueStats.blocked;
+        return result;
+    }
+
+    bool AsyncWorker::inWorkerThread()
+    {
+        return t_workerThread;
+    }
+
+    void AsyncWorker::run()
+    {
+        t_workerThread = true;
+        Item item;
+
+        while (!stopping.load(std::memory_order_relaxed))
+        {
+            if (queue.pop(item))
+            {
+                deliver(item);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mutex);
+            waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            condition.wait(lock, [this]{ return stopping.load(std::memory_order_relaxed) || !queue.empty(); });
+            waiting.store(false, std::memory_order_relaxed);
+        }
+
+        // Маршруты и команды, поставленные до остановки, не теряются; оставшаяся телеметрия отбрасывается
+        while (queue.popLossless(item))
+            deliver(item);
+    }
+
+    void AsyncWorker::deliver(Item &item)
+    {
+        if (item.package && latency && !item.package->stamps.empty())
+            latency->dequeued(item.package->stamps, wallClock());
+
+        if (item.package) target->setSharedPackage(item.package);
+        else if (item.data) target->setData(*item.data);
+        deliveredCount.fetch_add(1, std::memory_order_relaxed);
+
+        // Пакет освобождается сразу, а не при следующем pop
+        item = Item();
+    }
+
+    void Interface::unsubscribe(SubscriptionId id)
+    {
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            auto subscription = std::find_if(subscriptions.begin(), subscriptions.end(),
+                                             [id](const Subscription &item){ return item.id == id; });
+            if (subscription == subscriptions.end()) return;
+
+            subscriptions.erase(subscription);
+            rebuildRoutes();
+        }
+
+        quiesce();
+    }
+
+    void Interface::rebuildRoutes()
+    {
+        std::shared_ptr<Routes> next = std::make_shared<Routes>();
+
+        // Подписка добавляется в группу своей структуры внутри маршрута
+        auto add = [](Route &route, const Subscription &subscription)
+        {
+            auto group = std::find_if(route.begin(), route.end(),
+                                      [&subscription](const std::unique_ptr<RouteGroup> &item)
+                                      { return item->tag == subscription.tag; });
+            if (group == route.end())
+            {
+                route.push_back(subscription.create());
+                group = route.end() - 1;
+            }
+
+            subscription.attach(**group);
+        };
+
+        for (const Subscription &subscription: subscriptions)
+            (*next)[subscription.key];
+
+        // Подписки в порядке оформления; маршрут борта получает и подписки на все борта
+        for (auto &route: *next)
+        {
+            const uint64_t anyBoard = (route.first & ~static_cast<uint64_t>(0xffffffff)) | k_anyBoard;
+
+            for (const Subscription &subscription: subscriptions)
+            {
+                if (subscription.key == route.first || subscription.key == anyBoard)
+                    add(route.second, subscription);
+            }
+        }
+
+        publish(routes, std::shared_ptr<const Routes>(next));
+    }
+
+#endif // GF_INTERFACE_CPP
+
+} // namespace GroupFlight
@@ -1,7 +1,21 @@
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "arena.h"
+#include "frameassembler.h"
+#include "latencyhistogram.h"
+#include "packageview.h"
+#include "parser.h"
 #include "protocol.h"
+#include "policyqueue.h"
 
 #define UNUSED(x) (void)x;
 
@@ -18,44 +32,594 @@ namespace GroupFlight
         virtual ~Handler(){}
         virtual ErrorType setData(const std::vector<char> &data){UNUSED(data); return ErrorType::NoError;}
         virtual ErrorType setPackage(const Package &package){UNUSED(package); return ErrorType::NoError;}
+
+        //! \brief Прием пакета без копирования; представление действительно только во время вызова
+        //! По умолчанию пакет копируется и передается в setPackage
+        virtual ErrorType setPackageView(const PackageView &view)
+        {
+            Package package;
+            view.toPackage(package);
+            return setPackage(package);
+        }
+
+        //! \brief Прием пакета вместе с ареной текущей порции принятых данных
+        //! Временные данные разбора (например, маршрут в std::vector<FlightPoint, ArenaAllocator<FlightPoint>>)
+        //! можно размещать в арене: она сбрасывается после обработки порции.
+        //! По умолчанию арена не используется
+        virtual ErrorType setPackageView(const PackageView &view, Arena &arena)
+        {
+            UNUSED(arena);
+            return setPackageView(view);
+        }
+
+        //! \brief Прием всех пакетов, полученных за один системный вызов
+        //! Представления действительны только во время вызова. По умолчанию пакеты
+        //! передаются по одному в setPackageView
+        virtual void setPackageBatch(const PackageView *views, size_t count, Arena &arena)
+        {
+            for (size_t i = 0; i < count; i++)
+                setPackageView(views[i], arena);
+        }
+
+        //! \brief Прием пакета, общего для всех асинхронных обработчиков (Interface::addAsyncHandler)
+        //! Пакет неизменяем, указатель можно хранить после вызова. По умолчанию передается в setPackage
+        virtual ErrorType setSharedPackage(const std::shared_ptr<const Package> &package)
+        {
+            return setPackage(*package);
+        }
+    };
+
+    //! \brief Поток асинхронного обработчика: пакеты передаются ему через ограниченную очередь
+    //! Писатель очереди - поток, вызывающий Interface::set...ToHandlers. Если обработчик не успевает,
+    //! пакеты телеметрии отбрасываются или объединяются по политике очереди, а маршруты, команды
+    //! и прочие пакеты не теряются: писатель ждет места в очереди и они передаются раньше телеметрии.
+    //! При удалении обработчика поставленные ему маршруты и команды передаются до завершения потока
+    class AsyncWorker
+    {
+    public:
+        //! Статистика обработчика
+        struct Stats
+        {
+            uint64_t delivered = 0;     //!< Передано обработчику
+            uint64_t dropped = 0;       //!< Отброшено или вытеснено: очередь заполнена
+            uint64_t coalesced = 0;     //!< Заменено более новой телеметрией того же борта
+            uint64_t blocked = 0;       //!< Рассылка ждала места в очереди
+        };
+
+        //! \param latency - учет задержки до выдачи пакета из очереди (LatencyTracker::dequeued); nullptr - без учета
+        AsyncWorker(Handler *target, size_t capacity, QueuePolicy policy = QueuePolicy::DropOldest,
+                    LatencyTracker *latency = nullptr);
+        ~AsyncWorker();
+
+        AsyncWorker(const AsyncWorker &) = delete;
+        AsyncWorker &operator=(const AsyncWorker &) = delete;
+
+        bool push(const std::shared_ptr<const Package> &package);
+        bool push(const std::shared_ptr<const std::vector<char>> &data);
+
+        Handler *handler() const { return target; }
+        Stats stats() const;
+
+        //! \brief Вызван ли из потока асинхронного обработчика
+        static bool inWorkerThread();
+
+    private:
+        struct Item
+        {
+            std::shared_ptr<const Package> package;
+            std::shared_ptr<const std::vector<char>> data;
+        };
+
+        bool push(Item &&item, bool lossy, uint32_t board);
+        void run();
+        void deliver(Item &item);
+
+        Handler *target;
+        LatencyTracker *latency;
+        PolicyQueue<Item> queue;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::atomic<bool> waiting{false};
+        std::atomic<bool> stopping{false};
+
+        std::atomic<uint64_t> deliveredCount{0};
+
+        std::thread thread;
     };
 
+    //! \brief Рассылка данных обработчикам
+    //! Список обработчиков копируется при изменении (copy-on-write): рассылка читает неизменяемый
+    //! снимок списка без блокировок, и обработчики можно добавлять и удалять из других потоков.
+    //! Синхронные обработчики вызываются в потоке рассылки, асинхронные - каждый в своем потоке;
+    //! пакет для асинхронных обработчиков разбирается один раз и передается им общим.
+    //! Методы set...ToHandlers вызываются из одного потока (потока рассылки).
+    //! Изменения списка обработчиков и подписок не ждут рассылку и могут вызываться из обработчиков;
+    //! удаление (removeHandler, unsubscribe) из другого потока ждет завершения рассылки, которая
+    //! могла начаться до него, чтобы удаленный больше не вызывался. Из потоков асинхронных обработчиков
+    //! удаление не ждет: рассылка сама может ждать места в очереди такого потока.
+    //! Кроме обработчиков, пакеты получают подписчики (subscribe) - только пакеты с нужными
+    //! источником, типом и номером борта, уже разобранные в структуру
     class Interface : public Handler
     {
     public:
+        //! Подписка на пакеты всех бортов
+        static const uint32_t k_anyBoard = 0xffffffff;
+
+        using SubscriptionId = uint64_t;
+
+        Interface(): handlers(std::make_shared<const Handlers>()), routes(std::make_shared<const Routes>()){}
         virtual ~Interface(){}
 
+        Interface(const Interface &) = delete;
+        Interface &operator=(const Interface &) = delete;
+
+        //! \brief Добавление обработчика; не ждет рассылку
+        //! Добавленный из обработчика получает пакеты со следующей рассылки
         virtual void addHandler(Handler *handler)
         {
             if (!handler) return;
-            handlers.push_back(handler);
+            update([handler](Handlers &list){ list.push_back(Entry{handler, nullptr}); });
+        }
+
+        //! \brief Обработчик в собственном потоке с очередью на capacity пакетов
+        //! Медленный обработчик не задерживает рассылку остальным: его устаревшая телеметрия
+        //! отбрасывается по политике policy. Рассылка ждет только при переполнении очереди
+        //! маршрутами и командами (и телеметрией при QueuePolicy::Block).
+        //! Не ждет рассылку; добавленный из обработчика получает пакеты со следующей рассылки
+        virtual void addAsyncHandler(Handler *handler, size_t capacity = 1024,
+                                     QueuePolicy policy = QueuePolicy::DropOldest)
+        {
+            if (!handler) return;
+
+            std::shared_ptr<AsyncWorker> worker = std::make_shared<AsyncWorker>(handler, capacity, policy, &latencyTracker);
+            update([&worker, handler](Handlers &list){ list.push_back(Entry{handler, std::move(worker)}); });
         }
 
+        //! \brief Удаление обработчика; после возврата обработчик больше не вызывается
+        //! Из другого потока удаление ждет завершения рассылки, начатой до него, а поток асинхронного
+        //! обработчика - передачи ему уже поставленных маршрутов и команд. Из обработчика в потоке
+        //! рассылки не ждет: удаленный обработчик еще может быть вызван до конца текущей рассылки.
+        //! Из потока асинхронного обработчика (в том числе удаляющего сам себя) тоже не ждет: поток
+        //! удаленного асинхронного обработчика завершается в начале следующей рассылки
         virtual void removeHandler(Handler *handler)
         {
             if (!handler) return;
 
-            auto index = std::find(handlers.begin(), handlers.end(), handler);
-            if (index != handlers.end()) handlers.erase(index);
+            std::shared_ptr<AsyncWorker> worker;
+            update([handler, &worker](Handlers &list)
+            {
+                auto index = std::find_if(list.begin(), list.end(),
+                                          [handler](const Entry &entry){ return entry.handler == handler; });
+                if (index == list.end()) return;
+
+                worker = index->worker;
+                list.erase(index);
+            });
+
+            // Поток асинхронного обработчика не ждет рассылку и не завершает потоки обработчиков:
+            // рассылка может ждать места в его очереди, а он сам - быть удаляемым
+            if (AsyncWorker::inWorkerThread())
+            {
+                retire(std::move(worker));
+                return;
+            }
+
+            // После рассылки на старый снимок ссылок не остается: поток обработчика завершается здесь
+            quiesce();
+            worker.reset();
+        }
+
+        virtual size_t handlersCount(){ return std::atomic_load(&handlers)->size(); }
+
+        //! \brief Статистика асинхронного обработчика (пустая для синхронного)
+        AsyncWorker::Stats asyncStats(Handler *handler)
+        {
+            const std::shared_ptr<const Handlers> current = std::atomic_load(&handlers);
+            for (const Entry &entry: *current)
+                if (entry.handler == handler && entry.worker) return entry.worker->stats();
+            return AsyncWorker::Stats();
+        }
+
+        //! \brief Задержки пакетов с отметками времени (Package::stamps, PackageView::timestamps()):
+        //! от приема до разбора и до вызова обработчиков и подписчиков; для асинхронных обработчиков -
+        //! вместе с ожиданием в их очередях
+        LatencyTracker::Snapshot latency() const { return latencyTracker.snapshot(); }
+        void resetLatency() { latencyTracker.reset(); }
+
+        //! \brief Подписка на пакеты источника source с типом type от борта board (k_anyBoard - от всех бортов)
+        //! Пакет разбирается в структуру T (одну из структур parser.h) один раз для всех подписчиков
+        //! на эту структуру и передается в callback(const Header &, const T &) в потоке рассылки.
+        //! Подписки собираются в таблицу маршрутов заранее, при подписке и отписке.
+        //! Не ждет рассылку; подписка из обработчика действует со следующей рассылки
+        //! \return идентификатор для unsubscribe()
+        template<typename T, typename Callback>
+        SubscriptionId subscribe(DataSource source, DataType type, uint32_t board, Callback callback)
+        {
+            std::function<void(const Header &, const T &)> function(std::move(callback));
+
+            Subscription subscription;
+            subscription.key = routeKey(source, type, board);
+            subscription.tag = typeTag<T>();
+            subscription.create = []{ return std::unique_ptr<RouteGroup>(new TypedGroup<T>(typeTag<T>())); };
+            subscription.attach = [function](RouteGroup &group)
+            { static_cast<TypedGroup<T> &>(group).callbacks.push_back(function); };
+
+            std::lock_guard<std::mutex> lock(writeMutex);
+            subscription.id = ++lastSubscription;
+            subscriptions.push_back(std::move(subscription));
+            rebuildRoutes();
+            return lastSubscription;
         }
 
-        virtual size_t handlersCount(){ return handlers.size(); }
+        //! \brief Отмена подписки; после возврата callback больше не вызывается
+        //! Из другого потока ждет завершения рассылки, начатой до отмены; из обработчика или callback
+        //! в потоке рассылки и из потока асинхронного обработчика не ждет, и callback еще может быть
+        //! вызван до конца текущей рассылки
+        void unsubscribe(SubscriptionId id);
 
         virtual void setDataToHandlers(const std::vector<char> &data)
         {
-            for (Handler *handler: handlers)
-                handler->setData(data);
+            const DispatchScope scope(*this);
+            const std::shared_ptr<const Handlers> current = std::atomic_load(&handlers);
+            std::shared_ptr<const std::vector<char>> shared;
+
+            for (const Entry &entry: *current)
+            {
+                if (!entry.worker)
+                {
+                    entry.handler->setData(data);
+                    continue;
+                }
+
+                if (!shared) shared = std::make_shared<const std::vector<char>>(data);
+                entry.worker->push(shared);
+            }
+        }
+
+        //! \brief Прием порции потока байт (TCP, последовательный порт)
+        //! Пакеты, разрезанные между порциями, собираются в assembler - свой у каждого соединения;
+        //! после битого пакета поиск продолжается со следующего маркера. Каждый целый пакет
+        //! передается обработчикам через setPackageViewToHandlers
+        //! \return количество переданных пакетов
+        size_t setStreamToHandlers(FrameAssembler &assembler, const char *data, size_t size)
+        {
+            return assembler.feed(data, size, [this](const PackageView &view){ setPackageViewToHandlers(view); });
         }
 
         virtual void setPackageToHandlers(const Package &package)
         {
-            for (Handler *handler: handlers)
-                handler->setPackage(package);
+            const DispatchScope scope(*this);
+            const std::shared_ptr<const Handlers> current = std::atomic_load(&handlers);
+            std::shared_ptr<const Package> shared;
+            observe(package.stamps);
+
+            for (const Entry &entry: *current)
+            {
+                if (!entry.worker)
+                {
+                    calling(latencyTracker, package.stamps);
+                    entry.handler->setPackage(package);
+                    continue;
+                }
+
+                if (!shared) shared = std::make_shared<const Package>(package);
+                entry.worker->push(shared);
+            }
+
+            route(package.header, package, package.stamps);
+        }
+
+        virtual void setPackageViewToHandlers(const PackageView &view)
+        {
+            const DispatchScope scope(*this);
+            const std::shared_ptr<const Handlers> current = std::atomic_load(&handlers);
+            std::shared_ptr<const Package> shared;
+            observe(view.timestamps());
+
+            for (const Entry &entry: *current)
+            {
+                if (!entry.worker)
+                {
+                    calling(latencyTracker, view.timestamps());
+                    entry.handler->setPackageView(view);
+                    continue;
+                }
+
+                if (!shared) shared = share(view);
+                entry.worker->push(shared);
+            }
+
+            route(view.header(), view, view.timestamps());
+        }
+
+        virtual void setPackageViewToHandlers(const PackageView &view, Arena &arena)
+        {
+            const DispatchScope scope(*this);
+            const std::shared_ptr<const Handlers> current = std::atomic_load(&handlers);
+            std::shared_ptr<const Package> shared;
+            observe(view.timestamps());
+
+            for (const Entry &entry: *current)
+            {
+                if (!entry.worker)
+                {
+                    calling(latencyTracker, view.timestamps());
+                    entry.handler->setPackageView(view, arena);
+                    continue;
+                }
+
+                if (!shared) shared = share(view);
+                entry.worker->push(shared);
+            }
+
+            route(view.header(), view, view.timestamps());
+        }
+
+        virtual void setPackageBatchToHandlers(const PackageView *views, size_t count, Arena &arena)
+        {
+            const DispatchScope scope(*this);
+            const std::shared_ptr<const Handlers> current = std::atomic_load(&handlers);
+            std::vector<std::shared_ptr<const Package>> shared;
+
+            // Отметки проверяются у каждого пакета: в пачке могут быть пакеты без них
+            bool timed = false;
+            for (size_t i = 0; i < count; i++)
+            {
+                observe(views[i].timestamps());
+                if (!views[i].timestamps().empty()) timed = true;
+            }
+
+            for (const Entry &entry: *current)
+            {
+                if (!entry.worker)
+                {
+                    if (timed)
+                    {
+                        const int64_t now = wallClock();
+                        for (size_t i = 0; i < count; i++)
+                            if (!views[i].timestamps().empty()) latencyTracker.delivered(views[i].timestamps(), now);
+                    }
+
+                    entry.handler->setPackageBatch(views, count, arena);
+                    continue;
+                }
+
+                if (shared.empty())
+                {
+                    shared.reserve(count);
+                    for (size_t i = 0; i < count; i++)
+                        shared.push_back(share(views[i]));
+                }
+
+                for (const std::shared_ptr<const Package> &package: shared)
+                    entry.worker->push(package);
+            }
+
+            for (size_t i = 0; i < count; i++)
+                route(views[i].header(), views[i], views[i].timestamps());
         }
 
     private:
-        std::vector<Handler*> handlers;
+        struct Entry
+        {
+            Handler *handler;
+            std::shared_ptr<AsyncWorker> worker;    // nullptr - синхронный обработчик
+        };
+
+        using Handlers = std::vector<Entry>;
+
+        // Подписчики на одну структуру в одном маршруте: пакет разбирается один раз
+        struct RouteGroup
+        {
+            explicit RouteGroup(const void *_tag): tag(_tag){}
+            virtual ~RouteGroup(){}
+
+            virtual void dispatch(const PackageView &view, LatencyTracker *latency) const = 0;
+            virtual void dispatch(const Package &package, LatencyTracker *latency) const = 0;
+
+            const void *tag;
+        };
+
+        template<typename T>
+        struct TypedGroup : RouteGroup
+        {
+            explicit TypedGroup(const void *_tag): RouteGroup(_tag){}
+
+            void dispatch(const PackageView &view, LatencyTracker *latency) const override
+            {
+                T value;
+                fromPairs(view, value);
+                for (const auto &callback: callbacks)
+                {
+                    if (latency) calling(*latency, view.timestamps());
+                    callback(view.header(), value);
+                }
+            }
+
+            void dispatch(const Package &package, LatencyTracker *latency) const override
+            {
+                T value;
+                fromPairs(package.pairs, value);
+                for (const auto &callback: callbacks)
+                {
+                    if (latency) calling(*latency, package.stamps);
+                    callback(package.header, value);
+                }
+            }
+
+            std::vector<std::function<void(const Header &, const T &)>> callbacks;
+        };
+
+        struct Subscription
+        {
+            SubscriptionId id;
+            uint64_t key;
+            const void *tag;
+            std::function<std::unique_ptr<RouteGroup>()> create;
+            std::function<void(RouteGroup &)> attach;
+        };
+
+        // Маршрут - группы подписчиков для одного сочетания (источник, тип, борт). Маршрут конкретного
+        // борта уже включает подписчиков на все борта, маршрут k_anyBoard - для остальных бортов
+        using Route = std::vector<std::unique_ptr<RouteGroup>>;
+        using Routes = std::unordered_map<uint64_t, Route>;
+
+        static uint64_t routeKey(DataSource source, DataType type, uint32_t board)
+        {
+            return (static_cast<uint64_t>(source) << 40) | (static_cast<uint64_t>(type) << 32) | board;
+        }
+
+        // Уникальный адрес для каждого типа структуры (без RTTI)
+        template<typename T>
+        static const void *typeTag()
+        {
+            static const char tag = 0;
+            return &tag;
+        }
+
+        template<typename Source>
+        void route(const Header &header, const Source &source, const Timestamps &stamps)
+        {
+            const std::shared_ptr<const Routes> current = std::atomic_load(&routes);
+            if (current->empty()) return;
+
+            auto found = current->find(routeKey(header.source, header.type, header.boardNumber));
+            if (found == current->end()) found = current->find(routeKey(header.source, header.type, k_anyBoard));
+            if (found == current->end()) return;
+
+            LatencyTracker *latency = stamps.empty() ? nullptr : &latencyTracker;
+            for (const std::unique_ptr<RouteGroup> &group: found->second)
+                group->dispatch(source, latency);
+        }
+
+        void rebuildRoutes();
+
+        // Учет разбора пакета, если у него есть отметки времени
+        void observe(const Timestamps &stamps)
+        {
+            if (!stamps.empty()) latencyTracker.decoded(stamps);
+        }
+
+        // Вызов обработчика или подписчика в потоке рассылки: время берется непосредственно перед вызовом
+        static void calling(LatencyTracker &latency, const Timestamps &stamps)
+        {
+            if (!stamps.empty()) latency.delivered(stamps, wallClock());
+        }
+
+        // Рассылка: счетчик dispatchEpoch нечетный, пока она идет. В начале рассылки завершаются
+        // потоки обработчиков, удаленных из потоков асинхронных обработчиков; в конце будятся
+        // ждущие в quiesce()
+        class DispatchScope
+        {
+        public:
+            explicit DispatchScope(Interface &_owner): owner(_owner)
+            {
+                if (owner.hasRetired.load(std::memory_order_acquire)) owner.releaseRetired();
+
+                owner.dispatchThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                owner.dispatchEpoch.fetch_add(1, std::memory_order_seq_cst);
+            }
+
+            // Барьеры парные барьерам в quiesce(): ждущий либо увидит новую эпоху, либо будет разбужен
+            ~DispatchScope()
+            {
+                owner.dispatchEpoch.fetch_add(1, std::memory_order_seq_cst);
+                if (owner.quiesceWaiters.load(std::memory_order_seq_cst) == 0) return;
+
+                std::lock_guard<std::mutex> lock(owner.quiesceMutex);
+                owner.quiesced.notify_all();
+            }
+
+        private:
+            Interface &owner;
+        };
+
+        // Публикация нового снимка; старый освобождается, когда его перестанут читать
+        // рассылки, начатые до изменения
+        template<typename T>
+        static void publish(std::shared_ptr<const T> &slot, std::shared_ptr<const T> next)
+        {
+            std::atomic_store(&slot, std::move(next));
+        }
+
+        // Ожидание конца рассылки, которая могла прочитать снимок до публикации нового (вызывается
+        // после publish, без writeMutex), без загрузки процессора: ждущего будит ~DispatchScope.
+        // Поток рассылки не ждет сам себя, поток асинхронного обработчика не ждет рассылку,
+        // которая может ждать места в его очереди
+        void quiesce()
+        {
+            const uint64_t epoch = dispatchEpoch.load(std::memory_order_seq_cst);
+            if ((epoch & 1) == 0 || dispatchThread.load(std::memory_order_relaxed) == std::this_thread::get_id() ||
+                AsyncWorker::inWorkerThread())
+                return;
+
+            std::unique_lock<std::mutex> lock(quiesceMutex);
+            quiesceWaiters.fetch_add(1, std::memory_order_seq_cst);
+            quiesced.wait(lock, [this, epoch]{ return dispatchEpoch.load(std::memory_order_seq_cst) != epoch; });
+            quiesceWaiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        // Поток удаленного асинхронного обработчика завершит следующая рассылка
+        void retire(std::shared_ptr<AsyncWorker> worker)
+        {
+            if (!worker) return;
+
+            std::lock_guard<std::mutex> lock(writeMutex);
+            retired.push_back(std::move(worker));
+            hasRetired.store(true, std::memory_order_release);
+        }
+
+        // Потоки завершаются без writeMutex: их обработчики могут изменять список обработчиков
+        void releaseRetired()
+        {
+            std::vector<std::shared_ptr<AsyncWorker>> workers;
+            {
+                std::lock_guard<std::mutex> lock(writeMutex);
+                workers.swap(retired);
+                hasRetired.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        static std::shared_ptr<const Package> share(const PackageView &view)
+        {
+            std::shared_ptr<Package> package = std::make_shared<Package>();
+            view.toPackage(*package);
+            return package;
+        }
+
+        // Новый снимок списка публикуется целиком
+        template<typename Change>
+        void update(Change change)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+
+            std::shared_ptr<Handlers> next = std::make_shared<Handlers>(*std::atomic_load(&handlers));
+            change(*next);
+            publish(handlers, std::shared_ptr<const Handlers>(next));
+        }
+
+        // Объявлен раньше обработчиков: асинхронные обработчики пишут в него до своего удаления
+        LatencyTracker latencyTracker;
+
+        std::mutex writeMutex;
+        std::shared_ptr<const Handlers> handlers;
+
+        std::atomic<uint64_t> dispatchEpoch{0};
+        std::atomic<std::thread::id> dispatchThread{std::thread::id()};
+
+        // Ожидание конца рассылки в quiesce()
+        std::mutex quiesceMutex;
+        std::condition_variable quiesced;
+        std::atomic<unsigned> quiesceWaiters{0};
+
+        // Удаленные из потоков асинхронных обработчиков; изменяются под writeMutex
+        std::vector<std::shared_ptr<AsyncWorker>> retired;
+        std::atomic<bool> hasRetired{false};
 
+        std::vector<Subscription> subscriptions;    // Изменяются под writeMutex
+        SubscriptionId lastSubscription = 0;
+        std::shared_ptr<const Routes> routes;
     };
 
 #endif // INTERFACE_H
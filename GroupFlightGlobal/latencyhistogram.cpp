@@ -0,0 +1,201 @@
+#include <chrono>
+#include <limits>
+
+#include "latencyhistogram.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_LATENCYHISTOGRAM_CPP
+#define GF_LATENCYHISTOGRAM_CPP
+
+    namespace
+    {
+        //! Номер старшего единичного бита (value > 0)
+        inline int highestBit(uint64_t value)
+        {
+#if defined(__GNUC__)
+            return 63 - __builtin_clzll(value);
+#else
+            int result = 0;
+            while (value >>= 1) result++;
+            return result;
+#endif
+        }
+
+        template<typename T>
+        void storeMin(std::atomic<T> &target, T value)
+        {
+            T current = target.load(std::memory_order_relaxed);
+            while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+
+        template<typename T>
+        void storeMax(std::atomic<T> &target, T value)
+        {
+            T current = target.load(std::memory_order_relaxed);
+            while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+        }
+    } // namespace
+
+    int64_t wallClock()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    LatencyHistogram::LatencyHistogram()
+    {
+        reset();
+    }
+
+    size_t LatencyHistogram::bucket(uint64_t nanoseconds)
+    {
+        // Меньше k_subBuckets нс - по интервалу на каждую наносекунду
+        if (nanoseconds < k_subBuckets) return static_cast<size_t>(nanoseconds);
+
+        const int exponent = highestBit(nanoseconds);
+        if (exponent > k_maxExponent) return k_buckets - 1;
+
+        const size_t sub = static_cast<size_t>(nanoseconds >> (exponent - 3)) & (k_subBuckets - 1);
+        return static_cast<size_t>(exponent - 2) * k_subBuckets + sub;
+    }
+
+    uint64_t LatencyHistogram::lowerBound(size_t bucket)
+    {
+        if (bucket < k_subBuckets) return bucket;
+
+        const int exponent = static_cast<int>(bucket / k_subBuckets) + 2;
+        return (k_subBuckets + bucket % k_subBuckets) << (exponent - 3);
+    }
+
+    void LatencyHistogram::record(int64_t nanoseconds)
+    {
+        if (nanoseconds < 0)
+        {
+            negative.fetch_add(1, std::memory_order_relaxed);
+            nanoseconds = 0;
+        }
+
+        buckets[bucket(static_cast<uint64_t>(nanoseconds))].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(static_cast<uint64_t>(nanoseconds), std::memory_order_relaxed);
+        storeMin(minimum, nanoseconds);
+        storeMax(maximum, nanoseconds);
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+    {
+        Snapshot result;
+        for (size_t i = 0; i < k_buckets; i++)
+            result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+
+        result.count = count.load(std::memory_order_relaxed);
+        result.negative = negative.load(std::memory_order_relaxed);
+        if (result.count == 0) return result;
+
+        result.min = minimum.load(std::memory_order_relaxed);
+        result.max = maximum.load(std::memory_order_relaxed);
+        result.mean = double(sum.load(std::memory_order_relaxed)) / double(result.count);
+        return result;
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for (std::atomic<uint64_t> &value: buckets)
+            value.store(0, std::memory_order_relaxed);
+
+        count.store(0, std::memory_order_relaxed);
+        negative.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        minimum.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+        maximum.store(0, std::memory_order_relaxed);
+    }
+
+    int64_t LatencyHistogram::Snapshot::percentile(double p) const
+    {
+        if (count == 0) return 0;
+
+        // Счетчики читаются без общей блокировки: сумма интервалов может немного отличаться от count
+        uint64_t total = 0;
+        for (size_t i = 0; i < k_buckets; i++)
+            total += buckets[i];
+
+        const double target = (p < 0 ? 0 : p > 1 ? 1 : p) * double(total);
+
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < k_buckets; i++)
+        {
+            cumulative += buckets[i];
+            if (buckets[i] == 0 || double(cumulative) < target) continue;
+
+            const int64_t upper = i + 1 < k_buckets ? static_cast<int64_t>(lowerBound(i + 1)) - 1 : max;
+            return upper < min ? min : upper > max ? max : upper;
+        }
+
+        return max;
+    }
+
+    void LatencyHistogram::Snapshot::add(const Snapshot &other)
+    {
+        if (other.count == 0) return;
+
+        min = count == 0 || other.min < min ? other.min : min;
+        max = count == 0 || other.max > max ? other.max : max;
+        mean = (mean * double(count) + other.mean * double(other.count)) / double(count + other.count);
+        count += other.count;
+        negative += other.negative;
+
+        for (size_t i = 0; i < k_buckets; i++)
+            buckets[i] += other.buckets[i];
+    }
+
+    void LatencyTracker::Snapshot::add(const Snapshot &other)
+    {
+        wireToDecode.add(other.wireToDecode);
+        decodeToHandler.add(other.decodeToHandler);
+        wireToHandler.add(other.wireToHandler);
+        decodeToDequeue.add(other.decodeToDequeue);
+        wireToDequeue.add(other.wireToDequeue);
+    }
+
+    void LatencyTracker::decoded(const Timestamps &stamps)
+    {
+        if (stamps.wire != 0 && stamps.decoded != 0) wireToDecode.record(stamps.decoded - stamps.wire);
+    }
+
+    void LatencyTracker::delivered(const Timestamps &stamps, int64_t now)
+    {
+        if (stamps.decoded != 0) decodeToHandler.record(now - stamps.decoded);
+        if (stamps.wire != 0) wireToHandler.record(now - stamps.wire);
+    }
+
+    void LatencyTracker::dequeued(const Timestamps &stamps, int64_t now)
+    {
+        if (stamps.decoded != 0) decodeToDequeue.record(now - stamps.decoded);
+        if (stamps.wire != 0) wireToDequeue.record(now - stamps.wire);
+    }
+
+    LatencyTracker::Snapshot LatencyTracker::snapshot() const
+    {
+        Snapshot result;
+        result.wireToDecode = wireToDecode.snapshot();
+        result.decodeToHandler = decodeToHandler.snapshot();
+        result.wireToHandler = wireToHandler.snapshot();
+        result.decodeToDequeue = decodeToDequeue.snapshot();
+        result.wireToDequeue = wireToDequeue.snapshot();
+        return result;
+    }
+
+    void LatencyTracker::reset()
+    {
+        wireToDecode.reset();
+        decodeToHandler.reset();
+        wireToHandler.reset();
+        decodeToDequeue.reset();
+        wireToDequeue.reset();
+    }
+
+#endif // GF_LATENCYHISTOGRAM_CPP
+
+} // namespace GroupFlight
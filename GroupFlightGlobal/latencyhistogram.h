@@ -0,0 +1,108 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "protocol.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_LATENCYHISTOGRAM_H
+#define GF_LATENCYHISTOGRAM_H
+
+    //! \brief Текущее время в тех же единицах, что и Timestamps: нс от начала эпохи (CLOCK_REALTIME)
+    int64_t wallClock();
+
+    //! \brief Гистограмма задержек с логарифмическими интервалами
+    //! Каждая степень двойки наносекунд делится на k_subBuckets равных интервалов, поэтому
+    //! относительная погрешность процентилей не больше 1 / k_subBuckets при любом масштабе задержек.
+    //! Запись без блокировок, из любого числа потоков
+    class LatencyHistogram
+    {
+    public:
+        static const size_t k_subBuckets = 8;
+        static const int k_maxExponent = 40;    // Задержки от 2^41 нс (~37 мин) попадают в последний интервал
+        static const size_t k_buckets = (k_maxExponent - 2) * k_subBuckets + k_subBuckets;
+
+        //! Копия гистограммы на момент вызова snapshot()
+        struct Snapshot
+        {
+            uint64_t count = 0;
+            uint64_t negative = 0;      //!< Отрицательных задержек (шаг системных часов): записаны как нулевые
+            int64_t min = 0;
+            int64_t max = 0;
+            double mean = 0;
+            uint64_t buckets[k_buckets] = {};
+
+            //! \brief Верхняя граница интервала, в который попадает доля p (0..1) задержек, нс
+            int64_t percentile(double p) const;
+
+            //! \brief Объединение с гистограммой другого источника (например, другого потока приема)
+            void add(const Snapshot &other);
+        };
+
+        LatencyHistogram();
+
+        LatencyHistogram(const LatencyHistogram &) = delete;
+        LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+        //! \brief Запись задержки, нс
+        void record(int64_t nanoseconds);
+
+        Snapshot snapshot() const;
+        void reset();
+
+        //! \brief Номер интервала задержки и нижняя граница интервала
+        static size_t bucket(uint64_t nanoseconds);
+        static uint64_t lowerBound(size_t bucket);
+
+    private:
+        std::atomic<uint64_t> buckets[k_buckets];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> negative;
+        std::atomic<uint64_t> sum;
+        std::atomic<int64_t> minimum;
+        std::atomic<int64_t> maximum;
+    };
+
+    //! \brief Задержки прохождения пакетов по этапам: прием -> разбор -> передача обработчику
+    //! Вызов обработчика в потоке приема и выдача из очереди учитываются раздельно: задержка
+    //! отмечается один раз на каждого получателя, в момент передачи ему. Пакеты без отметки
+    //! нужного этапа не учитываются
+    class LatencyTracker
+    {
+    public:
+        struct Snapshot
+        {
+            LatencyHistogram::Snapshot wireToDecode;        //!< От приема до разбора
+            LatencyHistogram::Snapshot decodeToHandler;     //!< От разбора до вызова обработчика в потоке приема
+            LatencyHistogram::Snapshot wireToHandler;       //!< От приема до вызова обработчика в потоке приема
+            LatencyHistogram::Snapshot decodeToDequeue;     //!< От разбора до выдачи из очереди (с ожиданием в ней)
+            LatencyHistogram::Snapshot wireToDequeue;       //!< От приема до выдачи из очереди
+
+            void add(const Snapshot &other);
+        };
+
+        //! \brief Пакет разобран
+        void decoded(const Timestamps &stamps);
+
+        //! \brief Обработчик вызывается в потоке приема; now берется непосредственно перед вызовом
+        void delivered(const Timestamps &stamps, int64_t now);
+
+        //! \brief Пакет выдан из очереди (асинхронному обработчику, takePackage()) в момент now
+        void dequeued(const Timestamps &stamps, int64_t now);
+
+        Snapshot snapshot() const;
+        void reset();
+
+    private:
+        LatencyHistogram wireToDecode;
+        LatencyHistogram decodeToHandler;
+        LatencyHistogram wireToHandler;
+        LatencyHistogram decodeToDequeue;
+        LatencyHistogram wireToDequeue;
+    };
+
+#endif // GF_LATENCYHISTOGRAM_H
+
+} // namespace GroupFlight
@@ -0,0 +1,78 @@
+#include <cstring>
+
+#include "crc32.h"
+#include "frameassembler.h"
+#include "packageview.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_PACKAGEVIEW_CPP
+#define GF_PACKAGEVIEW_CPP
+
+    namespace
+    {
+        //! Начало следующего пакета после битого: ближайший маркер за началом текущего
+        inline size_t resyncShift(const char *source, size_t size, size_t shift)
+        {
+            return static_cast<size_t>(findHeader(source + shift + 1, source + size) - source);
+        }
+    } // namespace
+
+    UnpackStatus PackageView::parse(const char *source, size_t size, size_t &shift)
+    {
+        reset();
+
+        if (shift >= size || size - shift < k_minPackageSize) { shift = size; return UnpackStatus::SmallPackageSize; }
+
+        const char *shSource = source + shift;
+
+        if (shSource[0] != k_headSymbol1  ||
+            shSource[1] != k_headSymbol2  ||
+            shSource[2] != k_headSymbol3)
+        {
+            shift = resyncShift(source, size, shift);
+            return UnpackStatus::WrongHeaderId;
+        }
+
+        uint16_t size16 = (shSource[3] & 0x00ff) | ((shSource[4] & 0x00ff) << 8);
+        if (size16 < k_minPackageSize) { shift = resyncShift(source, size, shift); return UnpackStatus::WrongHeaderId; }
+        if (size - shift < size16) { shift = resyncShift(source, size, shift); return UnpackStatus::SmallPackageSize; }
+
+        uint32_t crc = 0;
+        memcpy(&crc, shSource + size16 - k_crcSize, k_crcSize);
+
+        if (crc != crc32(shSource, size16 - k_crcSize))
+            { shift = resyncShift(source, size, shift); return UnpackStatus::WrongCrc; }
+
+        packHeader.source = static_cast<DataSource>(shSource[5]);
+        packHeader.type = static_cast<DataType>(shSource[6]);
+        memcpy(&packHeader.boardNumber, shSource + 7, 4);
+
+        packData = shSource;
+        packSize = size16;
+
+        shift = size16 + shift;
+        return UnpackStatus::Success;
+    }
+
+    UnpackStatus PackageView::parse(const char *source, size_t size)
+    {
+        size_t shift = 0;
+        return parse(source, size, shift);
+    }
+
+    void PackageView::toPackage(Package &result) const
+    {
+        result.header = packHeader;
+        result.stamps = packStamps;
+        result.pairs.clear();
+        result.pairs.reserve(pairsCount());
+
+        for (const Pair &value: *this)
+            result.pairs.push_back(value);
+    }
+
+#endif // GF_PACKAGEVIEW_CPP
+
+} // namespace GroupFlight
@@ -0,0 +1,100 @@
+#include <cstddef>
+#include <iterator>
+
+#include "protocol.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_PACKAGEVIEW_H
+#define GF_PACKAGEVIEW_H
+
+    enum class UnpackStatus
+    {
+        UnknownError,
+        Success,
+        WrongCrc,
+        WrongHeaderId,
+        UnknownDataSource,
+        UnknownDataType,
+        SmallPackageSize,
+    };
+
+    //! \brief Представление пакета поверх исходного буфера, без копирования данных
+    //! Заголовок и контрольная сумма проверяются на месте, пары "ключ-значение"
+    //! читаются из буфера по мере обхода. Буфер должен существовать, пока используется представление
+    class PackageView
+    {
+    public:
+        //! \brief Итератор по парам "ключ-значение", каждая пара собирается из 3 байт буфера
+        class Iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Pair;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Pair *;
+            using reference = Pair;
+
+            explicit Iterator(const char *_pos = nullptr): pos(_pos){}
+
+            Pair operator*() const
+            {
+                return Pair(static_cast<DataKey>(pos[0]),
+                            static_cast<uint16_t>((pos[1] & 0x00ff) | ((pos[2] & 0x00ff) << 8)));
+            }
+
+            Iterator &operator++(){ pos += k_valueSize; return *this; }
+            Iterator operator++(int){ Iterator tmp(*this); pos += k_valueSize; return tmp; }
+
+            bool operator==(const Iterator &other) const { return pos == other.pos; }
+            bool operator!=(const Iterator &other) const { return pos != other.pos; }
+
+        private:
+            const char *pos;
+        };
+
+        PackageView(): packData(nullptr), packSize(0){}
+
+        //! \brief Проверка пакета в буфере и привязка представления к нему
+        //! \param source - массив данных
+        //! \param size - размер массива
+        //! \param shift - начало пакета; при успехе - начало следующего пакета,
+        //! при ошибке - следующий маркер начала пакета в массиве (или size, если маркера нет)
+        UnpackStatus parse(const char *source, size_t size, size_t &shift);
+        UnpackStatus parse(const char *source, size_t size);
+
+        bool isValid() const { return packData != nullptr; }
+        void reset(){ packData = nullptr; packSize = 0; packHeader = Header(); packStamps = Timestamps(); }
+
+        const Header &header() const { return packHeader; }
+
+        //! \brief Пакет целиком (заголовок, данные и контрольная сумма)
+        const char *data() const { return packData; }
+        size_t size() const { return packSize; }
+
+        size_t pairsCount() const
+        { return packData ? (packSize - k_headerSize - k_crcSize) / k_valueSize : 0; }
+
+        Pair pair(size_t index) const { return *Iterator(packData + k_headerSize + index * k_valueSize); }
+
+        Iterator begin() const { return Iterator(packData + k_headerSize); }
+        Iterator end() const { return Iterator(packData + k_headerSize + pairsCount() * k_valueSize); }
+
+        //! \brief Отметки времени приема и разбора; задаются принимающей стороной после parse()
+        const Timestamps &timestamps() const { return packStamps; }
+        void setTimestamps(const Timestamps &stamps) { packStamps = stamps; }
+
+        //! \brief Копирование представления в пакет с собственными данными
+        void toPackage(Package &result) const;
+
+    private:
+        const char *packData;
+        uint16_t packSize;
+        Header packHeader;
+        Timestamps packStamps;
+    };
+
+#endif // GF_PACKAGEVIEW_H
+
+} // namespace GroupFlight
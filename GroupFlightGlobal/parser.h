@@ -1,3 +1,4 @@
+#include "packageview.h"
 #include "protocol.h"
 
 namespace GroupFlight
@@ -6,18 +7,7 @@ namespace GroupFlight
 #ifndef GF_PARSER_H
 #define GF_PARSER_H
 
-    enum class UnpackStatus
-    {
-        UnknownError,
-        Success,
-        WrongCrc,
-        WrongHeaderId,
-        UnknownDataSource,
-        UnknownDataType,
-        SmallPackageSize,
-    };
-
-    //! Преобразование структур в последовательность пар "ключ-значение"
+    //! Преобразование структур в последовательность пар "ключ-значение" (по схемам из schema.h)
     void toPairs(const std::vector<FlightPoint> &fPoints, std::vector<Pair> &result);
     void toPairs(const std::vector<Coords> &points,       std::vector<Pair> &result);
     void toPairs(const AreaAfs &area,                     std::vector<Pair> &result);
@@ -43,8 +33,64 @@ namespace GroupFlight
     void fromPairs(const std::vector<Pair> &source, NetworkParams &params);
     void fromPairs(const std::vector<Pair> &source, ManualControl &control);
 
+    //! Преобразование пар "ключ-значение" непосредственно из буфера принятого пакета (без копирования)
+    void fromPairs(const PackageView &source, std::vector<FlightPoint> &fPoints);
+    void fromPairs(const PackageView &source, std::vector<Coords> &points);
+    void fromPairs(const PackageView &source, AreaAfs &area);
+    void fromPairs(const PackageView &source, AreaRln &area);
+    void fromPairs(const PackageView &source, ShootPoint &point);
+    void fromPairs(const PackageView &source, TrackerEnable &value);
+    void fromPairs(const PackageView &source, GroupMode &groupMode);
+    void fromPairs(const PackageView &source, SelfId &selfId);
+    void fromPairs(const PackageView &source, Telemetry &telemetry);
+    void fromPairs(const PackageView &source, NetworkParams &params);
+    void fromPairs(const PackageView &source, ManualControl &control);
+
+    enum class PackStatus
+    {
+        Success,
+        PackageTooLarge,    //!< Размер пакета превышает k_maxPackageSize
+        BufferTooSmall,     //!< В буфере вызывающей стороны недостаточно места
+    };
+
+    //! \brief Положение пакета в общем буфере пакета группы (packBatch)
+    //! Вместе с адресом буфера соответствует элементу iovec для sendmsg/sendmmsg
+    struct PackSlice
+    {
+        size_t offset;
+        size_t size;
+
+        PackSlice(size_t _offset = 0, size_t _size = 0): offset(_offset), size(_size){}
+    };
+
+    //! \brief Размер пакета после преобразования (0, если пакет превышает k_maxPackageSize)
+    size_t packedSize(const Package &source);
+
+    //! Те же преобразования для пар пакета (Package::pairs), без выделения памяти для небольших пакетов.
+    //! Определены для всех структур, перечисленных выше
+    template<typename T> void toPairs(const T &value, PairList &result);
+    template<typename T> void fromPairs(const PairList &source, T &value);
+
     //! \brief Преобразование пакета (заголовок + пары "ключ-значение") в массив std::vector<char>
-    void pack(const Package &source, std::vector<char> &result);
+    //! Массив очищается; при ошибке остается пустым
+    PackStatus pack(const Package &source, std::vector<char> &result);
+
+    //! \brief Преобразование пакета в буфер вызывающей стороны
+    //! \param result - буфер для пакета
+    //! \param capacity - размер буфера
+    //! \param written - записано байт (0 при ошибке)
+    PackStatus pack(const Package &source, char *result, size_t capacity, size_t &written);
+
+    //! \brief Преобразование пакета с добавлением в конец массива
+    //! Массив можно использовать повторно (clear() без освобождения памяти); при ошибке он не меняется
+    PackStatus packAppend(const Package &source, std::vector<char> &result);
+
+    //! \brief Преобразование группы пакетов в один непрерывный массив, пакеты идут друг за другом
+    //! Пакеты добавляются в конец result, положение каждого добавляется в slices.
+    //! На первом пакете с ошибкой преобразование прекращается: в result и slices остаются
+    //! уже преобразованные пакеты, номер пакета с ошибкой равен числу добавленных slices
+    PackStatus packBatch(const Package *source, size_t count, std::vector<char> &result, std::vector<PackSlice> &slices);
+    PackStatus packBatch(const std::vector<Package> &source, std::vector<char> &result, std::vector<PackSlice> &slices);
 
     //! \brief Преобразование массива std::vector<char> в пакет (заголовок + пары "ключ-значение")
     UnpackStatus unpack(const std::vector<char> &source, Package &result);
@@ -52,10 +98,23 @@ namespace GroupFlight
     //! \brief Преобразование массива char* в пакет (заголовок + пары "ключ-значение")
     //! \param source - массив данных для преобразования
     //! \param size - размер массива
-    //! \param shift - начало следующего пакета (если в массиве несколько пакетов, функция преобразует один пакет)
+    //! \param shift - начало следующего пакета (если в массиве несколько пакетов, функция преобразует один пакет);
+    //! после битого пакета - следующий маркер начала пакета, чтобы не терять пакеты за ним
     //! \param result - результат преобразования одного пакета
     UnpackStatus unpack(const char *source, size_t size, size_t &shift, Package &result);
 
+    //! \brief Разбор пакета из массива char* сразу в структуру, без промежуточных пар "ключ-значение"
+    //! Проверяются заголовок, контрольная сумма и тип данных пакета (UnpackStatus::UnknownDataType при несовпадении)
+    //! \param source - массив данных, содержащий один пакет с начала
+    //! \param size - размер массива
+    //! \param result - результат преобразования
+    //! \param header - заголовок пакета (если нужен номер борта и источник данных)
+    UnpackStatus decodeTelemetry(const char *source, size_t size, Telemetry &result, Header *header = nullptr);
+    UnpackStatus decodeRoute(const char *source, size_t size, std::vector<FlightPoint> &result, Header *header = nullptr);
+    UnpackStatus decodeAreaAfs(const char *source, size_t size, AreaAfs &result, Header *header = nullptr);
+    UnpackStatus decodeAreaRln(const char *source, size_t size, AreaRln &result, Header *header = nullptr);
+    UnpackStatus decodeGroupMode(const char *source, size_t size, GroupMode &result, Header *header = nullptr);
+
 #endif // GF_PARSER_H
 
 } // namespace GroupFlight
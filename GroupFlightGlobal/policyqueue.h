@@ -0,0 +1,230 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "spscqueue.h"
+
+namespace GroupFlight
+{
+
+#ifndef GF_POLICYQUEUE_H
+#define GF_POLICYQUEUE_H
+
+    //! Поведение очереди, когда читатель не успевает
+    enum class QueuePolicy
+    {
+        DropNewest,                 //!< Новый элемент отбрасывается
+        DropOldest,                 //!< Вытесняется самый старый элемент
+        CoalesceLatestPerBoard,     //!< Ожидающий элемент борта заменяется новым; вытесняется самый старый
+        Block                       //!< Писатель ждет места в очереди
+    };
+
+    //! \brief Ограниченная очередь с политикой вытеснения для одного писателя и одного читателя
+    //! Две полосы: вытесняемые элементы (lossy, например телеметрия) обрабатываются по политике
+    //! очереди, остальные (маршруты, команды) не теряются - писатель ждет места (или элемент
+    //! отбрасывается, если очередь создана без ожидания). Читатель получает сначала невытесняемые элементы.
+    //! Писатель ждет места без загрузки процессора: его будит pop() или close()
+    template<typename T>
+    class PolicyQueue
+    {
+    public:
+        //! Статистика очереди
+        struct Stats
+        {
+            uint64_t queued = 0;        //!< Принято в очередь
+            uint64_t dropped = 0;       //!< Отброшено или вытеснено
+            uint64_t coalesced = 0;     //!< Заменено более новым элементом того же борта
+            uint64_t blocked = 0;       //!< Писатель ждал места в очереди
+        };
+
+        //! \param capacity - емкость полосы вытесняемых элементов
+        //! \param losslessCapacity - емкость полосы невытесняемых элементов (округляется до степени двойки)
+        //! \param blockLossless - ждать места для невытесняемого элемента (false - отбрасывать)
+        explicit PolicyQueue(size_t capacity = 1024, QueuePolicy _policy = QueuePolicy::DropOldest,
+                             size_t losslessCapacity = 1024, bool blockLossless = true):
+            lossless(losslessCapacity), waitLossless(blockLossless),
+            ring(capacity > 0 ? capacity : 1), boards(ring.size()), queuePolicy(_policy){}
+
+        PolicyQueue(const PolicyQueue &) = delete;
+        PolicyQueue &operator=(const PolicyQueue &) = delete;
+
+        //! \brief Политика меняется, пока очередь не используется
+        void setPolicy(QueuePolicy policy) { queuePolicy = policy; }
+        QueuePolicy policy() const { return queuePolicy; }
+
+        //! \param lossy - элемент можно отбросить или заменить по политике очереди
+        //! \param board - номер борта для CoalesceLatestPerBoard
+        //! \return false, если элемент не поставлен в очередь (отброшен или очередь закрыта)
+        bool push(T &&value, bool lossy, uint32_t board = 0)
+        {
+            if (!lossy) return pushLossless(std::move(value));
+
+            std::unique_lock<std::mutex> lock(mutex);
+
+            if (queuePolicy == QueuePolicy::CoalesceLatestPerBoard)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    const size_t index = (head + i) % ring.size();
+                    if (boards[index] != board) continue;
+
+                    ring[index] = std::move(value);
+                    coalescedCount.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+
+            if (count == ring.size())
+            {
+                switch (queuePolicy)
+                {
+                case QueuePolicy::DropNewest:
+                    droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+
+                case QueuePolicy::Block:
+                    blockedCount.fetch_add(1, std::memory_order_relaxed);
+                    writerWaiting.store(true, std::memory_order_relaxed);
+                    space.wait(lock, [this]{ return count < ring.size() || closed.load(std::memory_order_relaxed); });
+                    writerWaiting.store(false, std::memory_order_relaxed);
+                    if (count == ring.size()) return false;
+                    break;
+
+                default:
+                    ring[head] = T();
+                    head = (head + 1) % ring.size();
+                    count--;
+                    droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+
+            const size_t index = (head + count) % ring.size();
+            ring[index] = std::move(value);
+            boards[index] = board;
+            count++;
+            lossyCount.store(count, std::memory_order_release);
+            queuedCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        //! \return false, если очередь пуста
+        bool pop(T &value)
+        {
+            if (popLossless(value)) return true;
+            if (lossyCount.load(std::memory_order_acquire) == 0) return false;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == 0) return false;
+
+            value = std::move(ring[head]);
+            ring[head] = T();
+            head = (head + 1) % ring.size();
+            count--;
+            lossyCount.store(count, std::memory_order_release);
+            if (writerWaiting.load(std::memory_order_relaxed)) space.notify_one();
+            return true;
+        }
+
+        //! \brief Элемент только из полосы невытесняемых
+        //! \return false, если в ней нет элементов
+        bool popLossless(T &value)
+        {
+            if (!lossless.pop(value)) return false;
+
+            // Будить писателя нужно, только если он ждет; барьер парный барьеру в pushLossless()
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (writerWaiting.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                space.notify_one();
+            }
+
+            return true;
+        }
+
+        bool empty() const { return lossless.empty() && lossyCount.load(std::memory_order_acquire) == 0; }
+
+        //! \brief Прекращение ожидания писателя; дальнейшие элементы, которым нужно ждать, отбрасываются
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed.store(true, std::memory_order_relaxed);
+            space.notify_all();
+        }
+
+        Stats stats() const
+        {
+            Stats result;
+            result.queued = queuedCount.load(std::memory_order_relaxed);
+            result.dropped = droppedCount.load(std::memory_order_relaxed);
+            result.coalesced = coalescedCount.load(std::memory_order_relaxed);
+            result.blocked = blockedCount.load(std::memory_order_relaxed);
+            return result;
+        }
+
+    private:
+        bool pushLossless(T &&value)
+        {
+            if (lossless.push(std::move(value)))
+            {
+                queuedCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            if (!waitLossless)
+            {
+                droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // SpscQueue::push не трогает элемент, пока для него нет места. Признак ожидания
+            // выставляется до повторной попытки: читатель, освободивший место после нее, разбудит писателя
+            blockedCount.fetch_add(1, std::memory_order_relaxed);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            writerWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            bool pushed = false;
+            while (!(pushed = lossless.push(std::move(value))) && !closed.load(std::memory_order_relaxed))
+                space.wait(lock);
+
+            writerWaiting.store(false, std::memory_order_relaxed);
+            if (!pushed) return false;
+
+            queuedCount.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        SpscQueue<T> lossless;
+        const bool waitLossless;
+
+        // Полоса вытесняемых элементов: кольцо под mutex, номера бортов - для объединения
+        std::mutex mutex;
+        std::vector<T> ring;
+        std::vector<uint32_t> boards;
+        size_t head = 0;
+        size_t count = 0;
+        std::atomic<size_t> lossyCount{0};
+
+        QueuePolicy queuePolicy;
+        std::atomic<bool> closed{false};
+
+        // Писатель ждет места в одной из полос
+        std::condition_variable space;
+        std::atomic<bool> writerWaiting{false};
+
+        std::atomic<uint64_t> queuedCount{0};
+        std::atomic<uint64_t> droppedCount{0};
+        std::atomic<uint64_t> coalescedCount{0};
+        std::atomic<uint64_t> blockedCount{0};
+    };
+
+#endif // GF_POLICYQUEUE_H
+
+} // namespace GroupFlight
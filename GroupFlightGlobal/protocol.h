@@ -1,12 +1,23 @@
 #include <cstdint>
 #include <vector>
 
+#include "smallvector.h"
+
 namespace GroupFlight
 {
 
 #ifndef GF_PROTOCOL_H
 #define GF_PROTOCOL_H
 
+    static const uint8_t k_minPackageSize = 19;     // Минимальный размер пакета
+    static const uint64_t k_maxPackageSize = 65535; // Максимальный размер пакета
+    static const uint8_t k_headerSize = 15;         // Размер заголовка пакета
+    static const uint8_t k_valueSize = 3;           // Размер пары "Ключ-Значение"
+    static const uint8_t k_crcSize = 4;             // Размер контрольной суммы
+    static const char k_headSymbol1 = static_cast<char>(0xB0);   // Символ заголовка 1
+    static const char k_headSymbol2 = 0x3B;         // Символ заголовка 2
+    static const char k_headSymbol3 = 0x7E;         // Символ заголовка 3
+
     //! Список устройств с которыми возможно взаимодействие
     enum class Device : uint8_t
     {
@@ -146,7 +157,12 @@ namespace GroupFlight
         MoveLeftFlag = 134,     //!< Движение влево
         MoveRightFlag = 135,   //!< Движение вправо
         MoveUpFlag = 136,      //!< Движение вверх
-        HoldCourseFlag = 137    //!< Удержание курса
+        HoldCourseFlag = 137,   //!< Удержание курса
+
+        //! Фрагментация пакетов, превышающих k_maxPackageSize (первые три пары фрагмента)
+        FragmentMessageId = 138,    //!< Номер сообщения, общий для всех его фрагментов
+        FragmentIndex = 139,        //!< Номер фрагмента в сообщении
+        FragmentCount = 140         //!< Количество фрагментов в сообщении
     };
 
     //! Режим группового полёта борта
@@ -205,6 +221,8 @@ namespace GroupFlight
     };
 
     //! Поле данных представляет из себя последовательность пар "Ключ-Значение"
+    //! Пара упакована без выравнивания: 3 байта, как на линии
+#pragma pack(push, 1)
     struct Pair
     {
         DataKey key;
@@ -212,15 +230,40 @@ namespace GroupFlight
 
         Pair(DataKey _key, uint16_t _value): key(_key), value(_value){}
         Pair(): Pair(DataKey::Error, 0){}
+
+        bool operator==(const Pair &other) const { return key == other.key && value == other.value; }
+        bool operator!=(const Pair &other) const { return !(*this == other); }
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(Pair) == k_valueSize, "Размер пары должен совпадать с ее размером в пакете");
+
+    static const uint8_t k_inlinePairs = 16;    // Пар в пакете без выделения памяти (телеметрия - 15 пар)
+
+    //! Последовательность пар пакета: небольшие пакеты хранятся без выделения памяти
+    using PairList = SmallVector<Pair, k_inlinePairs>;
+
+    //! Отметки времени прохождения пакета, нс от начала эпохи (CLOCK_REALTIME); 0 - отметки нет
+    struct Timestamps
+    {
+        int64_t wire = 0;       //!< Прием: ядром (SO_TIMESTAMPNS) или, если отметки ядра нет, при чтении из сокета
+        int64_t decoded = 0;    //!< Пакет разобран
+
+        //! \brief Нет ни одной отметки: задержки пакета не учитываются
+        bool empty() const { return wire == 0 && decoded == 0; }
     };
 
     //! Пакет состоит из заголовка и последовательности пар "Ключ-Значение"
     struct Package
     {
         Header header;
-        std::vector<Pair> pairs;
+        PairList pairs;
+        Timestamps stamps;      //!< Не передается по сети: заполняется при приеме
 
         Package(const Header &_header, const std::vector<Pair> &_values):
+            header(_header), pairs(_values.begin(), _values.end()){}
+
+        Package(const Header &_header, const PairList &_values):
             header(_header), pairs(_values){}
 
         Package(const Header &_header, const Pair &pair):
@@ -0,0 +1,568 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "protocol.h"
+
+//! Файл описывает схемы преобразования структур протокола в пары "ключ-значение" и обратно.
+//! Схема структуры - список полей с ключом, способом кодирования и доступом к члену структуры.
+//! По схеме на этапе компиляции строятся кодировщик и декодер с таблицей переходов по ключу
+
+namespace GroupFlight
+{
+
+#ifndef GF_SCHEMA_H
+#define GF_SCHEMA_H
+
+namespace Schema
+{
+    // === Доступ к членам структур ===
+
+    //! Член структуры
+    template<typename T, typename M, M T::*Ptr>
+    struct Member
+    {
+        using Owner = T;
+        using Type = M;
+
+        static M &get(T &owner) { return owner.*Ptr; }
+        static const M &get(const T &owner) { return owner.*Ptr; }
+    };
+
+    //! Член вложенной структуры
+    template<typename Outer, typename Inner>
+    struct Path
+    {
+        using Owner = typename Outer::Owner;
+        using Type = typename Inner::Type;
+
+        static Type &get(Owner &owner) { return Inner::get(Outer::get(owner)); }
+        static const Type &get(const Owner &owner) { return Inner::get(Outer::get(owner)); }
+    };
+
+    //! Сама структура (для списков std::vector<T>)
+    template<typename T>
+    struct Self
+    {
+        using Owner = T;
+        using Type = T;
+
+        static T &get(T &owner) { return owner; }
+        static const T &get(const T &owner) { return owner; }
+    };
+
+    template<typename T> using TypeOf = T;
+
+    #define GF_MEMBER(T, m) ::GroupFlight::Schema::Member<T, decltype(T::m), &::GroupFlight::Schema::TypeOf<T>::m>
+    #define GF_MEMBER_PATH(T, m, n) ::GroupFlight::Schema::Path<GF_MEMBER(T, m), GF_MEMBER(decltype(T::m), n)>
+
+    // === Кодирование значений ===
+
+    //! Значение без преобразования (беззнаковые числа, флаги, перечисления)
+    template<typename M>
+    struct Plain
+    {
+        static uint16_t encode(const M &value) { return static_cast<uint16_t>(value); }
+        static M decode(uint16_t value) { return static_cast<M>(value); }
+    };
+
+    //! Целое число со знаком
+    template<typename M>
+    struct Signed
+    {
+        static uint16_t encode(const M &value) { return static_cast<uint16_t>(static_cast<int32_t>(value)); }
+        static M decode(uint16_t value) { return static_cast<M>(static_cast<int16_t>(value)); }
+    };
+
+    //! Число со знаком в десятых долях (углы)
+    template<typename M>
+    struct Tenths
+    {
+        static uint16_t encode(const M &value) { return static_cast<uint16_t>(static_cast<int32_t>(value * 10)); }
+        static M decode(uint16_t value) { return static_cast<M>(static_cast<int16_t>(value)) / 10; }
+    };
+
+    //! 32-битное значение без преобразования
+    template<typename M>
+    struct Raw32
+    {
+        static uint32_t encode(const M &value) { return static_cast<uint32_t>(value); }
+        static M decode(uint32_t value) { return static_cast<M>(value); }
+    };
+
+    //! Координата WGS84 в 1e-7 градуса
+    template<typename M>
+    struct Degrees7
+    {
+        static uint32_t encode(const M &value) { return static_cast<uint32_t>(static_cast<int32_t>(value * 10000000)); }
+        static M decode(uint32_t value) { return static_cast<M>(static_cast<int32_t>(value)) / 10000000.; }
+    };
+
+    // === Поля схемы ===
+
+    //! Значение, передаваемое одной парой
+    template<DataKey Key, template<typename> class Codec, typename Access>
+    struct Value
+    {
+        using Owner = typename Access::Owner;
+        using Type = typename Access::Type;
+
+        static constexpr size_t pairs = 1;  // Количество пар при кодировании
+        static constexpr size_t slots = 0;  // Количество промежуточных 32-битных ячеек при декодировании
+
+        template<typename Out>
+        static void encode(const Owner &owner, Out &out)
+        { out.push_back(Pair(Key, Codec<Type>::encode(Access::get(owner)))); }
+
+        template<int Part>
+        static void decode(Owner &owner, uint32_t *, uint16_t value)
+        { Access::get(owner) = Codec<Type>::decode(value); }
+
+        static void finish(Owner &, const uint32_t *){}
+
+        template<typename Binding, typename Table>
+        static constexpr void install(Table &table)
+        { table.set(Key, &Binding::template entry<Value, 0>); }
+    };
+
+    //! Значение, передаваемое только если оно больше нуля
+    template<DataKey Key, template<typename> class Codec, typename Access>
+    struct Optional : Value<Key, Codec, Access>
+    {
+        template<typename Out>
+        static void encode(const typename Access::Owner &owner, Out &out)
+        { if (Access::get(owner) > 0) Value<Key, Codec, Access>::encode(owner, out); }
+    };
+
+    //! 32-битное значение, передаваемое двумя парами.
+    //! Ключ "LowByte" протокола несет старшие 16 бит, ключ "HighByte" - младшие
+    template<DataKey HighKey, DataKey LowKey, template<typename> class Codec, typename Access>
+    struct Split
+    {
+        using Owner = typename Access::Owner;
+        using Type = typename Access::Type;
+
+        static constexpr size_t pairs = 2;
+        static constexpr size_t slots = 1;
+
+        template<typename Out>
+        static void encode(const Owner &owner, Out &out)
+        {
+            const uint32_t value = Codec<Type>::encode(Access::get(owner));
+            out.push_back(Pair(HighKey, (value >> 16) & 0xffff));
+            out.push_back(Pair(LowKey, value & 0xffff));
+        }
+
+        template<int Part>
+        static void decode(Owner &, uint32_t *slot, uint16_t value)
+        { *slot |= Part == 0 ? ((value << 16) & 0xffff0000) : (value & 0x0000ffff); }
+
+        static void finish(Owner &owner, const uint32_t *slot)
+        { Access::get(owner) = Codec<Type>::decode(*slot); }
+
+        template<typename Binding, typename Table>
+        static constexpr void install(Table &table)
+        {
+            table.set(HighKey, &Binding::template entry<Split, 0>);
+            table.set(LowKey, &Binding::template entry<Split, 1>);
+        }
+    };
+
+    //! Широта и долгота WGS84
+    template<typename LatAccess, typename LonAccess>
+    using LatLon = std::pair<Split<DataKey::LatitudeLowByte, DataKey::LatitudeHighByte, Degrees7, LatAccess>,
+                             Split<DataKey::LongitudeLowByte, DataKey::LongitudeHighByte, Degrees7, LonAccess>>;
+
+    // === Описание структуры ===
+
+    template<typename... F> struct Fields {};
+
+    //! Раскрытие LatLon в два поля
+    template<typename List, typename... F> struct Flatten;
+    template<typename... R> struct Flatten<Fields<R...>> { using Type = Fields<R...>; };
+    template<typename... R, typename A, typename B, typename... F>
+    struct Flatten<Fields<R...>, std::pair<A, B>, F...> : Flatten<Fields<R..., A, B>, F...> {};
+    template<typename... R, typename A, typename... F>
+    struct Flatten<Fields<R...>, A, F...> : Flatten<Fields<R..., A>, F...> {};
+
+    template<typename... F> using FieldList = typename Flatten<Fields<>, F...>::Type;
+
+    //! Структура без списка точек
+    struct NoItems {};
+
+    //! Список точек: поля каждой точки и разделитель после нее.
+    //! CountKey - ключ пары с количеством точек перед списком (DataKey::Error - без нее)
+    template<typename Access, typename ItemFields, DataKey CountKey = DataKey::Error>
+    struct Items {};
+
+    //! Схема структуры, специализируется для каждой структуры протокола
+    template<typename T> struct Layout;
+
+    namespace Detail
+    {
+        template<typename... F>
+        constexpr size_t sumPairs(Fields<F...>) { size_t r = 0; size_t v[] = {0, F::pairs...}; for (size_t x: v) r += x; return r; }
+
+        template<typename... F>
+        constexpr size_t sumSlots(Fields<F...>) { size_t r = 0; size_t v[] = {0, F::slots...}; for (size_t x: v) r += x; return r; }
+
+        template<typename... F>
+        constexpr size_t fieldsCount(Fields<F...>) { return sizeof...(F); }
+
+        template<size_t I, typename... F>
+        constexpr size_t slotOffset(Fields<F...>) { size_t r = 0; size_t v[] = {F::slots..., 0}; for (size_t i = 0; i < I; i++) r += v[i]; return r; }
+
+        template<typename Fn>
+        struct KeyTable
+        {
+            Fn fn[256];
+            bool used[256];
+
+            constexpr void set(DataKey key, Fn f)
+            {
+                // Повтор ключа в схеме делает таблицу не constexpr и прерывает компиляцию
+                if (used[static_cast<uint8_t>(key)]) throw "duplicate key in schema";
+                used[static_cast<uint8_t>(key)] = true;
+                fn[static_cast<uint8_t>(key)] = f;
+            }
+        };
+
+        //! Таблица переходов декодера, строится на этапе компиляции
+        template<typename D>
+        struct DecodeTable
+        {
+            static constexpr typename D::Table value = D::makeTable();
+        };
+
+        template<typename D>
+        constexpr typename D::Table DecodeTable<D>::value;
+
+        template<typename Out, typename Owner, typename... F>
+        inline void encodeFields(const Owner &owner, Out &out, Fields<F...>)
+        {
+            int dummy[] = {0, (F::encode(owner, out), 0)...};
+            (void)dummy;
+        }
+
+        template<typename Owner, typename... F, size_t... I>
+        inline void finishFields(Owner &owner, const uint32_t *slots, Fields<F...> fields, std::index_sequence<I...>)
+        {
+            int dummy[] = {0, (F::finish(owner, slots + slotOffset<I>(fields)), 0)...};
+            (void)dummy;
+            (void)slots;
+            (void)owner;
+            (void)fields;
+        }
+
+        //! Сведения о списке точек структуры
+        template<typename T, typename ItemsSpec> struct ItemsTraits
+        {
+            struct Item {};
+            using ItemFields = Fields<>;
+            static constexpr bool present = false;
+            static constexpr size_t count(const T &) { return 0; }
+
+            template<typename Out> static void encodeCount(const T &, Out &){}
+            template<typename Out> static void encode(const T &, Out &){}
+            static void push(T &, const Item &){}
+        };
+
+        template<typename T, typename Access, typename ItemFieldsList, DataKey CountKey>
+        struct ItemsTraits<T, Items<Access, ItemFieldsList, CountKey>>
+        {
+            using Item = typename Access::Type::value_type;
+            using ItemFields = ItemFieldsList;
+            static constexpr bool present = true;
+            static size_t count(const T &owner) { return Access::get(owner).size(); }
+
+            template<typename Out>
+            static void encodeCount(const T &owner, Out &out)
+            { if (CountKey != DataKey::Error) out.push_back(Pair(CountKey, static_cast<uint16_t>(count(owner)))); }
+
+            template<typename Out>
+            static void encode(const T &owner, Out &out)
+            {
+                for (const Item &item: Access::get(owner))
+                {
+                    encodeFields(item, out, ItemFields());
+                    out.push_back(Pair(DataKey::Separator, 0xffff));
+                }
+            }
+
+            static void push(T &owner, const Item &item) { Access::get(owner).push_back(item); }
+
+            //! Очистка списка без освобождения памяти
+            static void reset(T &owner) { reset(owner, std::is_same<Access, Self<T>>()); }
+
+            //! Структура - сам список точек: распределитель памяти списка сохраняется
+            static void reset(T &owner, std::true_type) { owner.clear(); }
+
+            static void reset(T &owner, std::false_type)
+            {
+                auto items = std::move(Access::get(owner));
+                items.clear();
+                owner = T();
+                Access::get(owner) = std::move(items);
+            }
+        };
+
+        //! Состояние декодера: структура, текущая точка списка и промежуточные ячейки составных полей
+        template<typename T, typename Traits, size_t OwnerSlots, size_t ItemSlots>
+        struct Context
+        {
+            using Item = typename Traits::Item;
+
+            T &owner;
+            Item item;
+            uint32_t ownerSlots[OwnerSlots + 1];
+            uint32_t itemSlots[ItemSlots + 1];
+
+            explicit Context(T &_owner): owner(_owner), item(), ownerSlots(), itemSlots(){}
+
+            T &target(std::false_type) { return owner; }
+            Item &target(std::true_type) { return item; }
+            uint32_t *slots(std::false_type) { return ownerSlots; }
+            uint32_t *slots(std::true_type) { return itemSlots; }
+        };
+
+        //! Привязка поля к таблице переходов: IsItem - поле точки списка, Slot - смещение ячеек поля
+        template<typename Ctx, bool IsItem, size_t Slot>
+        struct Binding
+        {
+            template<typename F, int Part>
+            static void entry(Ctx &ctx, uint16_t value)
+            {
+                using Tag = std::integral_constant<bool, IsItem>;
+                F::template decode<Part>(ctx.target(Tag()), ctx.slots(Tag()) + Slot, value);
+            }
+        };
+
+        template<typename Ctx, bool IsItem, typename Table, typename... F, size_t... I>
+        constexpr void installFields(Table &table, Fields<F...> fields, std::index_sequence<I...>)
+        {
+            int dummy[] = {0, (F::template install<Binding<Ctx, IsItem, slotOffset<I>(fields)>>(table), 0)...};
+            (void)dummy;
+            (void)fields;
+            (void)table;
+        }
+    } // namespace Detail
+
+    //! \brief Кодировщик и декодер структуры T по ее схеме
+    //! \param OwnerFields - поля самой структуры
+    //! \param ItemsSpec - список точек структуры (Items<...>) или NoItems
+    template<typename T, typename OwnerFields, typename ItemsSpec = NoItems>
+    struct Document
+    {
+        using Traits = Detail::ItemsTraits<T, ItemsSpec>;
+        using ItemFields = typename Traits::ItemFields;
+
+        static constexpr size_t ownerSlots = Detail::sumSlots(OwnerFields());
+        static constexpr size_t itemSlots = Detail::sumSlots(ItemFields());
+
+        using Ctx = Detail::Context<T, Traits, ownerSlots, itemSlots>;
+        using Fn = void (*)(Ctx &, uint16_t);
+        using Table = Detail::KeyTable<Fn>;
+
+        //! \brief Количество пар при кодировании
+        static size_t pairsCount(const T &value)
+        {
+            return Detail::sumPairs(OwnerFields()) +
+                   Traits::count(value) * (Detail::sumPairs(ItemFields()) + 1) +
+                   (Traits::present ? 1 : 0);
+        }
+
+        template<typename Out>
+        static void encode(const T &value, Out &out)
+        {
+            out.clear();
+            out.reserve(pairsCount(value));
+
+            Traits::encodeCount(value, out);
+            Traits::encode(value, out);
+            Detail::encodeFields(value, out, OwnerFields());
+        }
+
+        template<typename Source>
+        static void decode(const Source &source, T &value)
+        {
+            reset(value, std::integral_constant<bool, Traits::present>());
+
+            Ctx ctx(value);
+            const Table &table = Detail::DecodeTable<Document>::value;
+            for (const Pair &pair: source)
+                table.fn[static_cast<uint8_t>(pair.key)](ctx, pair.value);
+
+            Detail::finishFields(value, ctx.ownerSlots, OwnerFields(),
+                                 std::make_index_sequence<Detail::fieldsCount(OwnerFields())>());
+        }
+
+        //! \brief Обработка структуры после декодирования (переопределяется в схеме при необходимости)
+        static void finish(T &){}
+
+        static constexpr Table makeTable()
+        {
+            Table result{};
+            for (int i = 0; i < 256; i++)
+            {
+                result.fn[i] = &skip;
+                result.used[i] = false;
+            }
+
+            if (Traits::present) result.set(DataKey::Separator, &separator);
+
+            Detail::installFields<Ctx, false>(result, OwnerFields(),
+                                              std::make_index_sequence<Detail::fieldsCount(OwnerFields())>());
+            Detail::installFields<Ctx, true>(result, ItemFields(),
+                                             std::make_index_sequence<Detail::fieldsCount(ItemFields())>());
+            return result;
+        }
+
+    private:
+        static void reset(T &value, std::false_type) { value = T(); }
+        static void reset(T &value, std::true_type) { Traits::reset(value); }
+
+        static void skip(Ctx &, uint16_t){}
+
+        //! Разделитель завершает текущую точку списка
+        static void separator(Ctx &ctx, uint16_t value)
+        {
+            if (value != 0xffff) return;
+
+            Detail::finishFields(ctx.item, ctx.itemSlots, ItemFields(),
+                                 std::make_index_sequence<Detail::fieldsCount(ItemFields())>());
+            Traits::push(ctx.owner, ctx.item);
+
+            ctx.item = typename Ctx::Item();
+            for (uint32_t &slot: ctx.itemSlots) slot = 0;
+        }
+
+    };
+
+    // === Схемы структур протокола ===
+
+    //! Команда 1. Полет по точкам, маршруту (и ответ на запрос точек маршрута)
+    //! (для массивов с любым распределителем памяти, в том числе ArenaAllocator)
+    template<typename Allocator> struct Layout<std::vector<FlightPoint, Allocator>> :
+        Document<std::vector<FlightPoint, Allocator>, Fields<>,
+        Items<Self<std::vector<FlightPoint, Allocator>>, FieldList<
+            Value<DataKey::PointNumber, Plain, GF_MEMBER_PATH(FlightPoint, point, num)>,
+            LatLon<GF_MEMBER_PATH(FlightPoint, point, lat), GF_MEMBER_PATH(FlightPoint, point, lon)>,
+            Value<DataKey::Altitude, Signed, GF_MEMBER_PATH(FlightPoint, point, alt)>,
+            Value<DataKey::HoldRadius, Plain, GF_MEMBER(FlightPoint, holdRadius)>,
+            Value<DataKey::HoldTime, Plain, GF_MEMBER(FlightPoint, holdTime)>>,
+        DataKey::PointsCount>> {};
+
+    //! Список точек
+    template<typename Allocator> struct Layout<std::vector<Coords, Allocator>> :
+        Document<std::vector<Coords, Allocator>, Fields<>,
+        Items<Self<std::vector<Coords, Allocator>>, FieldList<
+            Value<DataKey::PointNumber, Plain, GF_MEMBER(Coords, num)>,
+            LatLon<GF_MEMBER(Coords, lat), GF_MEMBER(Coords, lon)>,
+            Value<DataKey::Altitude, Signed, GF_MEMBER(Coords, alt)>>>> {};
+
+    //! Команда 3. Обследование области АФС
+    template<> struct Layout<AreaAfs> : Document<AreaAfs, FieldList<
+            Value<DataKey::Altitude, Signed, GF_MEMBER(AreaAfs, altitude)>,
+            Value<DataKey::CrossOverlap, Plain, GF_MEMBER(AreaAfs, crossOverlap)>,
+            Value<DataKey::AlongOverlap, Plain, GF_MEMBER(AreaAfs, alongOverlap)>,
+            Optional<DataKey::Resolution, Plain, GF_MEMBER(AreaAfs, resolution)>>,
+        Items<GF_MEMBER(AreaAfs, points), FieldList<
+            Value<DataKey::PointNumber, Plain, GF_MEMBER(Coords, num)>,
+            LatLon<GF_MEMBER(Coords, lat), GF_MEMBER(Coords, lon)>>>>
+    {
+        //! Высота точек области совпадает с высотой области
+        static void finish(AreaAfs &area) { for (Coords &point: area.points) point.alt = area.altitude; }
+    };
+
+    //! Команда 4. Обследование области РЛН
+    template<> struct Layout<AreaRln> : Document<AreaRln, FieldList<
+            Value<DataKey::Altitude, Signed, GF_MEMBER(AreaRln, altitude)>,
+            Value<DataKey::Overlap, Plain, GF_MEMBER(AreaRln, overlap)>,
+            Value<DataKey::FlightDistance, Plain, GF_MEMBER(AreaRln, distance)>,
+            Value<DataKey::DataFormat, Plain, GF_MEMBER(AreaRln, format)>>,
+        Items<GF_MEMBER(AreaRln, points), FieldList<
+            Value<DataKey::PointNumber, Plain, GF_MEMBER(Coords, num)>,
+            LatLon<GF_MEMBER(Coords, lat), GF_MEMBER(Coords, lon)>>>>
+    {
+        //! Высота точек области совпадает с высотой области
+        static void finish(AreaRln &area) { for (Coords &point: area.points) point.alt = area.altitude; }
+    };
+
+    //! Команда 5. Съемка ГОЭС. Управление камерой ГОЭС
+    template<> struct Layout<ShootPoint> : Document<ShootPoint, FieldList<
+            LatLon<GF_MEMBER_PATH(ShootPoint, point, lat), GF_MEMBER_PATH(ShootPoint, point, lon)>,
+            Value<DataKey::Altitude, Signed, GF_MEMBER_PATH(ShootPoint, point, alt)>,
+            Value<DataKey::FocalLength, Plain, GF_MEMBER(ShootPoint, focalLength)>,
+            Value<DataKey::FlyAroundFlag, Plain, GF_MEMBER(ShootPoint, flyAround)>>> {};
+
+    //! Команда 6. Запуск трекера ГОЭС
+    template<> struct Layout<TrackerEnable> : Document<TrackerEnable, FieldList<
+            Value<DataKey::ImageCoordinateX, Plain, GF_MEMBER(TrackerEnable, x)>,
+            Value<DataKey::ImageCoordinateY, Plain, GF_MEMBER(TrackerEnable, y)>,
+            Value<DataKey::TrackerEnableFlag, Plain, GF_MEMBER(TrackerEnable, enable)>>> {};
+
+    //! Команда 8. Команда группового полёта
+    template<> struct Layout<GroupMode> : Document<GroupMode, FieldList<
+            Value<DataKey::GroupFlightMode, Plain, GF_MEMBER(GroupMode, mode)>,
+            Value<DataKey::MasterFlag, Plain, GF_MEMBER(GroupMode, master)>,
+            Value<DataKey::DistancingX, Signed, GF_MEMBER(GroupMode, distancingX)>,
+            Value<DataKey::DistancingY, Signed, GF_MEMBER(GroupMode, distancingY)>,
+            Value<DataKey::DistancingZ, Signed, GF_MEMBER(GroupMode, distancingZ)>>> {};
+
+    //! Команда 0. Ответ на запрос самоидентификации
+    template<> struct Layout<SelfId> : Document<SelfId, FieldList<
+            Value<DataKey::NumberUAV, Plain, GF_MEMBER(SelfId, number)>,
+            Value<DataKey::TypeCO, Plain, GF_MEMBER(SelfId, type)>>> {};
+
+    //! Команда 9. Телеметрия
+    template<> struct Layout<Telemetry> : Document<Telemetry, FieldList<
+            LatLon<GF_MEMBER(Telemetry, lat), GF_MEMBER(Telemetry, lon)>,
+            Value<DataKey::AltitudeGPS, Signed, GF_MEMBER(Telemetry, alt)>,
+            Value<DataKey::Pitch, Tenths, GF_MEMBER(Telemetry, pitch)>,
+            Value<DataKey::Roll, Tenths, GF_MEMBER(Telemetry, roll)>,
+            Value<DataKey::Course, Tenths, GF_MEMBER(Telemetry, course)>,
+            Value<DataKey::Speed, Signed, GF_MEMBER(Telemetry, speed)>,
+            Value<DataKey::FlightTimeLeft, Plain, GF_MEMBER(Telemetry, flightTimeLeft)>,
+            Value<DataKey::GroupFlightStatus, Plain, GF_MEMBER(Telemetry, groupFlightStatus)>,
+            Split<DataKey::TimeDateLowByte, DataKey::TimeDateHighByte, Raw32, GF_MEMBER(Telemetry, dateTime)>,
+            Value<DataKey::BoartStatus, Plain, GF_MEMBER(Telemetry, boardStatus)>,
+            Value<DataKey::CurrentPoint, Plain, GF_MEMBER(Telemetry, currentPoint)>>> {};
+
+    //! Настройки сетевого подключения
+    template<> struct Layout<NetworkParams> : Document<NetworkParams, FieldList<
+            Value<DataKey::PortIn, Plain, GF_MEMBER(NetworkParams, portIn)>,
+            Value<DataKey::PortOut, Plain, GF_MEMBER(NetworkParams, portOut)>,
+            Split<DataKey::HostLowByte, DataKey::HostHighByte, Raw32, GF_MEMBER(NetworkParams, host)>>> {};
+
+    //! Ручное управление автопилотом
+    template<> struct Layout<ManualControl> : Document<ManualControl, FieldList<
+            Value<DataKey::MoveLeftFlag, Plain, GF_MEMBER(ManualControl, moveLeft)>,
+            Value<DataKey::MoveRightFlag, Plain, GF_MEMBER(ManualControl, moveRight)>,
+            Value<DataKey::MoveUpFlag, Plain, GF_MEMBER(ManualControl, moveUp)>,
+            Value<DataKey::HoldCourseFlag, Plain, GF_MEMBER(ManualControl, holdCourse)>,
+            Value<DataKey::Course, Plain, GF_MEMBER(ManualControl, course)>,
+            Value<DataKey::CurrentPoint, Plain, GF_MEMBER(ManualControl, currentPoint)>>> {};
+
+    // === Преобразование по схеме ===
+
+    //! \brief Преобразование структуры в последовательность пар "ключ-значение"
+    template<typename T, typename Out>
+    inline void encode(const T &value, Out &result)
+    {
+        Layout<T>::encode(value, result);
+    }
+
+    //! \brief Преобразование последовательности пар "ключ-значение" (std::vector<Pair>, PackageView) в структуру
+    template<typename Source, typename T>
+    inline void decode(const Source &source, T &value)
+    {
+        Layout<T>::decode(source, value);
+        Layout<T>::finish(value);
+    }
+
+} // namespace Schema
+
+#endif // GF_SCHEMA_H
+
+} // namespace GroupFlight
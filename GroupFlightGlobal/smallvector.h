@@ -0,0 +1,226 @@
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace GroupFlight
+{
+
+#ifndef GF_SMALLVECTOR_H
+#define GF_SMALLVECTOR_H
+
+    //! \brief Массив с встроенным буфером на N элементов
+    //! Пока элементов не больше N, они хранятся внутри объекта без обращения к куче;
+    //! при превышении данные переносятся в динамическую память, как у std::vector.
+    //! Элементы копируются побайтно, поэтому тип должен быть тривиально копируемым
+    template<typename T, size_t N>
+    class SmallVector
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SmallVector: тип должен быть тривиально копируемым");
+        static_assert(N > 0, "SmallVector: встроенный буфер не может быть пустым");
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = T &;
+        using const_reference = const T &;
+        using pointer = T *;
+        using const_pointer = const T *;
+        using iterator = T *;
+        using const_iterator = const T *;
+
+        SmallVector(): ptr(inlineData()), count(0), cap(N){}
+
+        SmallVector(std::initializer_list<T> values): SmallVector() { assign(values.begin(), values.end()); }
+
+        template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+        SmallVector(It first, It last): SmallVector() { assign(first, last); }
+
+        SmallVector(const SmallVector &other): SmallVector() { assign(other.begin(), other.end()); }
+
+        SmallVector(SmallVector &&other) noexcept: SmallVector() { take(other); }
+
+        ~SmallVector(){ release(); }
+
+        SmallVector &operator=(const SmallVector &other)
+        {
+            if (this != &other) assign(other.begin(), other.end());
+            return *this;
+        }
+
+        SmallVector &operator=(SmallVector &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                ptr = inlineData();
+                cap = N;
+                count = 0;
+                take(other);
+            }
+            return *this;
+        }
+
+        size_t size() const { return count; }
+        size_t capacity() const { return cap; }
+        bool empty() const { return count == 0; }
+
+        //! \brief Данные хранятся во встроенном буфере
+        bool isInline() const { return ptr == inlineData(); }
+
+        T *data() { return ptr; }
+        const T *data() const { return ptr; }
+
+        iterator begin() { return ptr; }
+        iterator end() { return ptr + count; }
+        const_iterator begin() const { return ptr; }
+        const_iterator end() const { return ptr + count; }
+
+        T &operator[](size_t index) { return ptr[index]; }
+        const T &operator[](size_t index) const { return ptr[index]; }
+
+        T &front() { return ptr[0]; }
+        const T &front() const { return ptr[0]; }
+        T &back() { return ptr[count - 1]; }
+        const T &back() const { return ptr[count - 1]; }
+
+        void clear(){ count = 0; }
+
+        void reserve(size_t size)
+        {
+            if (size > cap) reallocate(size);
+        }
+
+        void resize(size_t size, const T &value = T())
+        {
+            if (size > cap) reallocate(grownCapacity(size));
+            for (size_t i = count; i < size; i++) new (ptr + i) T(value);
+            count = size;
+        }
+
+        void push_back(const T &value)
+        {
+            if (count == cap)
+            {
+                // value может ссылаться на элемент самого массива
+                const T copy = value;
+                reallocate(grownCapacity(count + 1));
+                new (ptr + count++) T(copy);
+                return;
+            }
+
+            new (ptr + count++) T(value);
+        }
+
+        template<typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            push_back(T(std::forward<Args>(args)...));
+            return back();
+        }
+
+        void pop_back(){ count--; }
+
+        //! \brief Вставка диапазона перед pos; диапазон не должен указывать внутрь самого массива
+        template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+        iterator insert(const_iterator pos, It first, It last)
+        {
+            const size_t offset = static_cast<size_t>(pos - ptr);
+            const size_t added = static_cast<size_t>(std::distance(first, last));
+
+            if (count + added > cap) reallocate(grownCapacity(count + added));
+
+            T *place = ptr + offset;
+            memmove(static_cast<void *>(place + added), place, (count - offset) * sizeof(T));
+            for (T *it = place; first != last; ++first, ++it) new (it) T(*first);
+
+            count += added;
+            return place;
+        }
+
+        iterator insert(const_iterator pos, const T &value)
+        {
+            const T copy = value;
+            return insert(pos, &copy, &copy + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            T *place = ptr + (first - ptr);
+            const size_t removed = static_cast<size_t>(last - first);
+            memmove(static_cast<void *>(place), place + removed, (count - (place - ptr) - removed) * sizeof(T));
+            count -= removed;
+            return place;
+        }
+
+        iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+        template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+        void assign(It first, It last)
+        {
+            clear();
+            insert(end(), first, last);
+        }
+
+        bool operator==(const SmallVector &other) const
+        {
+            if (count != other.count) return false;
+            for (size_t i = 0; i < count; i++)
+                if (!(ptr[i] == other.ptr[i])) return false;
+            return true;
+        }
+
+        bool operator!=(const SmallVector &other) const { return !(*this == other); }
+
+    private:
+        T *inlineData() { return reinterpret_cast<T *>(&storage); }
+        const T *inlineData() const { return reinterpret_cast<const T *>(&storage); }
+
+        size_t grownCapacity(size_t size) const { return size > cap * 2 ? size : cap * 2; }
+
+        void reallocate(size_t size)
+        {
+            T *data = static_cast<T *>(::operator new(size * sizeof(T)));
+            memcpy(static_cast<void *>(data), ptr, count * sizeof(T));
+            release();
+            ptr = data;
+            cap = size;
+        }
+
+        void release()
+        {
+            if (!isInline()) ::operator delete(ptr);
+        }
+
+        //! Перенос данных из other; динамический буфер передается без копирования
+        void take(SmallVector &other)
+        {
+            if (other.isInline())
+            {
+                memcpy(static_cast<void *>(ptr), other.ptr, other.count * sizeof(T));
+                count = other.count;
+            }
+            else
+            {
+                ptr = other.ptr;
+                cap = other.cap;
+                count = other.count;
+                other.ptr = other.inlineData();
+                other.cap = N;
+            }
+
+            other.count = 0;
+        }
+
+        T *ptr;
+        size_t count;
+        size_t cap;
+        typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+    };
+
+#endif // GF_SMALLVECTOR_H
+
+} // namespace GroupFlight
@@ -0,0 +1,104 @@
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace GroupFlight
+{
+
+#ifndef GF_SPSCQUEUE_H
+#define GF_SPSCQUEUE_H
+
+    static const size_t k_cacheLineSize = 64;
+
+    //! \brief Очередь без блокировок для одного писателя и одного читателя
+    //! Писатель (например, поток ввода-вывода) вызывает только push(), читатель - только pop().
+    //! Ячейки создаются заранее, передача элемента не обращается к куче, если этого не делает
+    //! присваивание самого элемента
+    template<typename T>
+    class SpscQueue
+    {
+    public:
+        //! \param capacity - емкость, округляется вверх до степени двойки
+        explicit SpscQueue(size_t capacity = 1024):
+            slots(roundUp(capacity)), mask(slots.size() - 1){}
+
+        SpscQueue(const SpscQueue &) = delete;
+        SpscQueue &operator=(const SpscQueue &) = delete;
+
+        //! \return false, если очередь заполнена
+        bool push(const T &value)
+        {
+            const size_t position = tail.load(std::memory_order_relaxed);
+            if (!hasSpace(position)) return false;
+
+            slots[position & mask] = value;
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool push(T &&value)
+        {
+            const size_t position = tail.load(std::memory_order_relaxed);
+            if (!hasSpace(position)) return false;
+
+            slots[position & mask] = std::move(value);
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! \return false, если очередь пуста
+        bool pop(T &value)
+        {
+            const size_t position = head.load(std::memory_order_relaxed);
+            if (position == cachedTail)
+            {
+                cachedTail = tail.load(std::memory_order_acquire);
+                if (position == cachedTail) return false;
+            }
+
+            value = std::move(slots[position & mask]);
+            head.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! \brief Приблизительное количество элементов (точное - только для писателя или читателя)
+        size_t size() const
+        { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+
+        bool empty() const { return size() == 0; }
+        size_t capacity() const { return slots.size(); }
+
+    private:
+        static size_t roundUp(size_t value)
+        {
+            size_t result = 2;
+            while (result < value) result <<= 1;
+            return result;
+        }
+
+        bool hasSpace(size_t position)
+        {
+            if (position - cachedHead < slots.size()) return true;
+
+            cachedHead = head.load(std::memory_order_acquire);
+            return position - cachedHead < slots.size();
+        }
+
+        std::vector<T> slots;
+        const size_t mask;
+
+        // Индексы писателя и читателя - в разных строках кэша. Разнесены заполнением, а не alignas:
+        // до C++17 new не выравнивает объекты (и содержащие очередь структуры) больше чем на 16 байт
+        char writerPadding[k_cacheLineSize];
+        std::atomic<size_t> tail{0};
+        size_t cachedHead = 0;      // Последний прочитанный писателем head
+        char readerPadding[k_cacheLineSize - 2 * sizeof(size_t)];
+        std::atomic<size_t> head{0};
+        size_t cachedTail = 0;      // Последний прочитанный читателем tail
+        char tailPadding[k_cacheLineSize - 2 * sizeof(size_t)];
+    };
+
+#endif // GF_SPSCQUEUE_H
+
+} // namespace GroupFlight
@@ -0,0 +1,286 @@
+#include "batchio.h"
+
+#ifdef __linux__
+#define BATCHIO_MMSG
+#endif
+
+#ifdef BATCHIO_MMSG
+#include <cerrno>
+#include <cstring>
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace BatchIo
+{
+
+bool supported()
+{
+#ifdef BATCHIO_MMSG
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef BATCHIO_MMSG
+
+int open(uint16_t port, uint32_t group, bool reusePort)
+{
+    const int result = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (result < 0) return -1;
+
+    const int enable = 1;
+    setsockopt(result, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    if (reusePort && setsockopt(result, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0)
+    {
+        ::close(result);
+        return -1;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (::bind(result, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0)
+    {
+        ::close(result);
+        return -1;
+    }
+
+    if (group != 0)
+    {
+        ip_mreq request;
+        memset(&request, 0, sizeof(request));
+        request.imr_multiaddr.s_addr = htonl(group);
+        request.imr_interface.s_addr = htonl(INADDR_ANY);
+        setsockopt(result, IPPROTO_IP, IP_ADD_MEMBERSHIP, &request, sizeof(request));
+
+        const int ttl = 1;
+        setsockopt(result, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    }
+
+    return result;
+}
+
+void close(int socket)
+{
+    if (socket >= 0) ::close(socket);
+}
+
+bool attachSteering(int socket, Steering steering, size_t shards)
+{
+    if (socket < 0 || shards == 0) return false;
+
+    const uint32_t count = static_cast<uint32_t>(shards);
+
+    // Номер сокета, выходящий за пределы группы, ядро заменяет своим хешем
+    sock_filter sourceAddress[] = {
+        // A = IP-адрес отправителя; перемешивание байт адреса, A = A % count
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_NET_OFF + 12)),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 16),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+        BPF_STMT(BPF_MISC | BPF_TAX, 0),
+        BPF_STMT(BPF_ALU | BPF_RSH | BPF_K, 8),
+        BPF_STMT(BPF_ALU | BPF_XOR | BPF_X, 0),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, count),
+        BPF_STMT(BPF_RET | BPF_A, 0)
+    };
+
+    sock_filter cpu[] = {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, count),
+        BPF_STMT(BPF_RET | BPF_A, 0)
+    };
+
+    sock_fprog program;
+    switch (steering)
+    {
+    case Steering::SourceAddress:
+        program.len = sizeof(sourceAddress) / sizeof(sourceAddress[0]);
+        program.filter = sourceAddress;
+        break;
+
+    case Steering::Cpu:
+        program.len = sizeof(cpu) / sizeof(cpu[0]);
+        program.filter = cpu;
+        break;
+
+    default:
+    {
+        // Программа снимается; сокет без программы - не ошибка
+#ifdef SO_DETACH_REUSEPORT_BPF
+        const int dummy = 0;
+        setsockopt(socket, SOL_SOCKET, SO_DETACH_REUSEPORT_BPF, &dummy, sizeof(dummy));
+#endif
+        return true;
+    }
+    }
+
+    return setsockopt(socket, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == 0;
+}
+
+int receive(int socket, GroupFlight::PacketBufferPool::Buffer *buffers, size_t count)
+{
+    return receive(socket, buffers, nullptr, count);
+}
+
+bool enableTimestamps(int socket)
+{
+    const int enable = 1;
+    return setsockopt(socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0;
+}
+
+int receive(int socket, GroupFlight::PacketBufferPool::Buffer *buffers, Origin *origins, size_t count)
+{
+    if (count > k_maxBatch) count = k_maxBatch;
+
+    // Место под отметку времени; без origins адрес и служебные данные не запрашиваются
+    union Control
+    {
+        char data[CMSG_SPACE(sizeof(timespec))];
+        cmsghdr align;
+    };
+
+    mmsghdr messages[k_maxBatch];
+    iovec vectors[k_maxBatch];
+    sockaddr_in addresses[k_maxBatch];
+    Control controls[k_maxBatch];
+    memset(messages, 0, sizeof(mmsghdr) * count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        vectors[i].iov_base = buffers[i].data();
+        vectors[i].iov_len = buffers[i].capacity();
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+
+        if (origins)
+        {
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+            messages[i].msg_hdr.msg_control = controls[i].data;
+            messages[i].msg_hdr.msg_controllen = sizeof(controls[i].data);
+        }
+    }
+
+    int result;
+    do
+        result = recvmmsg(socket, messages, static_cast<unsigned int>(count), MSG_DONTWAIT, nullptr);
+    while (result < 0 && errno == EINTR);
+
+    if (result < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+    for (int i = 0; i < result; i++)
+    {
+        buffers[i].setSize(messages[i].msg_len);
+        if (!origins) continue;
+
+        Origin &origin = origins[i];
+        origin.host = ntohl(addresses[i].sin_addr.s_addr);
+        origin.port = ntohs(addresses[i].sin_port);
+        origin.timestamp = 0;
+
+        msghdr &header = messages[i].msg_hdr;
+        for (cmsghdr *control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(&header, control))
+        {
+            if (control->cmsg_level != SOL_SOCKET || control->cmsg_type != SCM_TIMESTAMPNS) continue;
+
+            timespec time;
+            memcpy(&time, CMSG_DATA(control), sizeof(time));
+            origin.timestamp = int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+        }
+    }
+
+    return result;
+}
+
+int send(int socket, uint32_t host, uint16_t port,
+         const char *data, const GroupFlight::PackSlice *slices, size_t count)
+{
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(host);
+    address.sin_port = htons(port);
+
+    mmsghdr messages[k_maxBatch];
+    iovec vectors[k_maxBatch];
+    size_t sent = 0;
+
+    while (sent < count)
+    {
+        const size_t chunk = count - sent < k_maxBatch ? count - sent : k_maxBatch;
+        memset(messages, 0, sizeof(mmsghdr) * chunk);
+
+        for (size_t i = 0; i < chunk; i++)
+        {
+            vectors[i].iov_base = const_cast<char *>(data + slices[sent + i].offset);
+            vectors[i].iov_len = slices[sent + i].size;
+            messages[i].msg_hdr.msg_name = &address;
+            messages[i].msg_hdr.msg_namelen = sizeof(address);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int result;
+        do
+            result = sendmmsg(socket, messages, static_cast<unsigned int>(chunk), 0);
+        while (result < 0 && errno == EINTR);
+
+        if (result < 0) return sent > 0 ? static_cast<int>(sent) : -1;
+
+        sent += static_cast<size_t>(result);
+        if (static_cast<size_t>(result) < chunk) break;
+    }
+
+    return static_cast<int>(sent);
+}
+
+#else
+
+int open(uint16_t, uint32_t, bool)
+{
+    return -1;
+}
+
+void close(int)
+{
+}
+
+bool attachSteering(int, Steering, size_t)
+{
+    return false;
+}
+
+int receive(int, GroupFlight::PacketBufferPool::Buffer *, size_t)
+{
+    return -1;
+}
+
+bool enableTimestamps(int)
+{
+    return false;
+}
+
+int receive(int, GroupFlight::PacketBufferPool::Buffer *, Origin *, size_t)
+{
+    return -1;
+}
+
+int send(int, uint32_t, uint16_t, const char *, const GroupFlight::PackSlice *, size_t)
+{
+    return -1;
+}
+
+#endif
+
+} // namespace BatchIo
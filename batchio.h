@@ -0,0 +1,66 @@
+#ifndef BATCHIO_H
+#define BATCHIO_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bufferpool.h"
+#include "parser.h"
+
+//! Пакетный ввод-вывод UDP: несколько датаграмм за один системный вызов (recvmmsg/sendmmsg, Linux).
+//! На других системах supported() возвращает false, и используется обычный ввод-вывод Qt
+namespace BatchIo
+{
+    static const size_t k_maxBatch = 64;    // Датаграмм за один системный вызов
+
+    //! Распределение датаграмм между сокетами одного порта (SO_REUSEPORT)
+    enum class Steering
+    {
+        Kernel,         //!< Хеш ядра по адресам и портам отправителя и получателя
+        SourceAddress,  //!< Хеш IP-адреса отправителя: все датаграммы борта попадают в один сокет
+        Cpu             //!< Сокет с номером процессора, принявшего датаграмму (по модулю числа сокетов)
+    };
+
+    //! \brief Доступен ли пакетный ввод-вывод
+    bool supported();
+
+    //! \brief Открытие неблокирующего UDP-сокета на порту port (SO_REUSEADDR)
+    //! \param group - адрес группы multicast для подключения (0 - без подключения)
+    //! \param reusePort - SO_REUSEPORT: несколько сокетов на одном порту, ядро распределяет между ними датаграммы
+    //! \return дескриптор сокета или -1
+    int open(uint16_t port, uint32_t group = 0, bool reusePort = false);
+    void close(int socket);
+
+    //! \brief Установка программы распределения (cBPF, SO_ATTACH_REUSEPORT_CBPF) для группы сокетов порта
+    //! Вызывается для любого сокета группы, открытого с reusePort. Номер сокета в группе -
+    //! порядок открытия; программа выбирает сокет из shards первых
+    //! \return false, если программа не установлена (Steering::Kernel - программа снимается)
+    bool attachSteering(int socket, Steering steering, size_t shards);
+
+    //! \brief Прием до count датаграмм без блокировки, каждая - в свой буфер
+    //! Размер принятых данных записывается в Buffer::setSize(); count не больше k_maxBatch
+    //! \return количество принятых датаграмм, 0 - если данных нет, -1 - ошибка сокета
+    int receive(int socket, GroupFlight::PacketBufferPool::Buffer *buffers, size_t count);
+
+    //! Отправитель и время приема датаграммы
+    struct Origin
+    {
+        uint32_t host = 0;          //!< Адрес отправителя (порядок байт узла)
+        uint16_t port = 0;
+        int64_t timestamp = 0;      //!< Время приема ядром, нс от начала эпохи (0 - отметки нет)
+    };
+
+    //! \brief Отметка времени приема ядром (SO_TIMESTAMPNS) каждой датаграммы сокета
+    bool enableTimestamps(int socket);
+
+    //! \brief Прием, как receive() выше, с отправителем и временем приема каждой датаграммы в origins
+    int receive(int socket, GroupFlight::PacketBufferPool::Buffer *buffers, Origin *origins, size_t count);
+
+    //! \brief Отправка группы датаграмм одному адресату; каждая датаграмма - срез общего буфера
+    //! \param host, port - адрес получателя (порядок байт узла)
+    //! \return количество отправленных датаграмм, -1 - ошибка сокета
+    int send(int socket, uint32_t host, uint16_t port,
+             const char *data, const GroupFlight::PackSlice *slices, size_t count);
+} // namespace BatchIo
+
+#endif // BATCHIO_H
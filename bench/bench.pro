@@ -0,0 +1,29 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++14 console
+CONFIG -= app_bundle
+
+TARGET = gfbench
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../msgpackstream.cpp \
+    corpus.cpp \
+    main.cpp
+
+HEADERS += \
+    ../msgpackstream.h \
+    corpus.h
+
+include(../GroupFlightGlobal/GroupFlightGlobal.pri)
+
+unix{
+include(/home/deneb/Qt Projects/GroupFlightProject/qmsgpack/qmsgpack.pri)
+}
+win32{
+include(../../qmsgpack/qmsgpack.pri)
+}
+
+LIBS *= -liphlpapi -lpsapi -lws2_32 -lole32 -lgdi32
@@ -0,0 +1,176 @@
+#include <random>
+
+#include "corpus.h"
+
+using namespace GroupFlight;
+
+namespace Corpus
+{
+    namespace
+    {
+        double uniform(std::mt19937 &random, double from, double to)
+        {
+            return std::uniform_real_distribution<double>(from, to)(random);
+        }
+
+        std::vector<Coords> contour(uint32_t count, uint32_t seed)
+        {
+            std::mt19937 random(seed);
+            std::vector<Coords> points;
+            points.reserve(count);
+
+            for (uint32_t i = 0; i < count; i++)
+                points.push_back(Coords(static_cast<uint16_t>(i), uniform(random, 55., 56.),
+                                        uniform(random, 37., 38.), 300.f));
+
+            return points;
+        }
+    } // namespace
+
+    Telemetry telemetry(uint32_t seed)
+    {
+        std::mt19937 random(seed);
+
+        Telemetry value;
+        value.lat = uniform(random, -90., 90.);
+        value.lon = uniform(random, -180., 180.);
+        value.alt = static_cast<float>(uniform(random, 0., 3000.));
+        value.pitch = static_cast<float>(uniform(random, -30., 30.));
+        value.roll = static_cast<float>(uniform(random, -45., 45.));
+        value.course = static_cast<float>(uniform(random, 0., 360.));
+        value.speed = static_cast<float>(uniform(random, 10., 40.));
+        value.flightTimeLeft = static_cast<uint16_t>(random() % 240);
+        value.groupFlightStatus = static_cast<uint8_t>(random() % 3);
+        value.dateTime = 1700000000u + seed;
+        value.boardStatus = static_cast<uint8_t>(random() % 8);
+        value.currentPoint = static_cast<uint16_t>(random() % 100);
+        return value;
+    }
+
+    Stream telemetryBurst(uint32_t boards, uint32_t perBoard, uint32_t seed)
+    {
+        Stream result;
+        result.packages.reserve(boards * perBoard);
+
+        std::vector<Pair> pairs;
+        for (uint32_t i = 0; i < perBoard; i++)
+        {
+            for (uint32_t board = 0; board < boards; board++)
+            {
+                toPairs(telemetry(seed + i * boards + board), pairs);
+                result.packages.push_back(Package(Header(DataSource::MGP, DataType::Telemetry, board + 1), pairs));
+            }
+        }
+
+        std::vector<PackSlice> slices;
+        packBatch(result.packages, result.bytes, slices);
+        return result;
+    }
+
+    std::vector<FlightPoint> route(uint32_t count, uint32_t seed)
+    {
+        std::vector<FlightPoint> points;
+        points.reserve(count);
+
+        for (const Coords &point: contour(count, seed))
+            points.push_back(FlightPoint(point, 50, 10));
+
+        return points;
+    }
+
+    Stream routeStream(uint32_t count, uint32_t seed)
+    {
+        std::vector<Pair> pairs;
+        toPairs(route(count, seed), pairs);
+
+        Stream result;
+        fragment(Package(Header(DataSource::Computer, DataType::FlightByPoints, 1), pairs), 1, result.packages);
+
+        std::vector<PackSlice> slices;
+        packBatch(result.packages, result.bytes, slices);
+        return result;
+    }
+
+    std::vector<char> corrupt(const Stream &source, uint32_t rate, size_t &valid, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<char> result;
+        result.reserve(source.bytes.size());
+        valid = 0;
+
+        std::vector<char> packed;
+        for (size_t i = 0; i < source.packages.size(); i++)
+        {
+            pack(source.packages[i], packed);
+
+            if (rate == 0 || i % rate != 0)
+            {
+                result.insert(result.end(), packed.begin(), packed.end());
+                valid++;
+                continue;
+            }
+
+            // Чередуются искаженный байт данных, искаженное поле размера и обрезанный пакет
+            switch ((i / rate) % 3)
+            {
+            case 0:
+                packed[k_headerSize + random() % (packed.size() - k_headerSize)] ^= 0x5a;
+                break;
+            case 1:
+                packed[4] = static_cast<char>(0xff);
+                break;
+            default:
+                packed.resize(packed.size() / 2);
+                break;
+            }
+
+            result.insert(result.end(), packed.begin(), packed.end());
+        }
+
+        return result;
+    }
+
+    AreaAfs areaAfs(uint32_t points, uint32_t seed)
+    {
+        return AreaAfs(contour(points, seed), 300.f, 60, 80, 5);
+    }
+
+    AreaRln areaRln(uint32_t points, uint32_t seed)
+    {
+        return AreaRln(contour(points, seed), 500.f, 30, 1000, 1);
+    }
+
+    ShootPoint shootPoint()
+    {
+        return ShootPoint(Coords(55.75, 37.61, 150.f), 35, 200);
+    }
+
+    TrackerEnable trackerEnable()
+    {
+        return TrackerEnable(640, 360, true);
+    }
+
+    GroupMode groupMode()
+    {
+        return GroupMode(GroupModeKey::Enabled, true, -50, 10, 30);
+    }
+
+    SelfId selfId()
+    {
+        return SelfId(12, 3);
+    }
+
+    NetworkParams networkParams()
+    {
+        return NetworkParams{5000, 5001, 0xc0a80001};
+    }
+
+    ManualControl manualControl()
+    {
+        ManualControl value;
+        value.moveLeft = true;
+        value.course = 270;
+        value.currentPoint = 4;
+        return value;
+    }
+} // namespace Corpus
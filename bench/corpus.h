@@ -0,0 +1,42 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "global.h"
+
+//! \brief Синтетические наборы данных для измерений
+namespace Corpus
+{
+    //! Поток пакетов: исходные пакеты и они же, упакованные друг за другом
+    struct Stream
+    {
+        std::vector<GroupFlight::Package> packages;
+        std::vector<char> bytes;
+    };
+
+    //! Телеметрия группы бортов: perBoard пакетов от каждого из boards бортов вперемешку
+    Stream telemetryBurst(uint32_t boards, uint32_t perBoard, uint32_t seed = 1);
+
+    //! Маршрут из count точек (фрагментируется при упаковке, если не помещается в пакет)
+    std::vector<GroupFlight::FlightPoint> route(uint32_t count, uint32_t seed = 2);
+    Stream routeStream(uint32_t count, uint32_t seed = 2);
+
+    //! Поток с повреждениями: в каждом rate-м пакете искажается байт, часть пакетов обрезается
+    //! \param valid - количество неповрежденных пакетов в результате
+    std::vector<char> corrupt(const Stream &source, uint32_t rate, size_t &valid, uint32_t seed = 3);
+
+    //! Примеры структур для каждого типа данных
+    GroupFlight::Telemetry telemetry(uint32_t seed);
+    GroupFlight::AreaAfs areaAfs(uint32_t points, uint32_t seed = 4);
+    GroupFlight::AreaRln areaRln(uint32_t points, uint32_t seed = 5);
+    GroupFlight::ShootPoint shootPoint();
+    GroupFlight::TrackerEnable trackerEnable();
+    GroupFlight::GroupMode groupMode();
+    GroupFlight::SelfId selfId();
+    GroupFlight::NetworkParams networkParams();
+    GroupFlight::ManualControl manualControl();
+} // namespace Corpus
+
+#endif // CORPUS_H
@@ -0,0 +1,498 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef QT_CORE_LIB
+#include <QByteArray>
+#include <QDateTime>
+#include <QVariantMap>
+#include "msgpack.h"
+#include "msgpackstream.h"
+#endif
+
+#include "corpus.h"
+
+using namespace GroupFlight;
+
+// Подсчет выделений памяти: замеры ведутся в одном потоке
+static uint64_t g_allocations = 0;
+
+void *operator new(size_t size)
+{
+    g_allocations++;
+    if (void *ptr = malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+namespace
+{
+    //! Результат, который не дает компилятору выбросить измеряемый код
+    volatile uint64_t g_sink = 0;
+
+    struct Options
+    {
+        double minTime = 0.2;
+        std::string filter;
+        const char *json = nullptr;
+    };
+
+    struct Result
+    {
+        std::string name;
+        uint64_t packets;
+        uint64_t bytes;
+        double seconds;
+        uint64_t allocations;
+    };
+
+    Options g_options;
+    std::vector<Result> g_results;
+
+    //! \brief Замер функции f, обрабатывающей за вызов packets пакетов общим размером bytes
+    //! Вызовы повторяются, пока суммарное время не превысит minTime
+    template<typename F>
+    void run(const std::string &name, uint64_t packets, uint64_t bytes, F f)
+    {
+        if (!g_options.filter.empty() && name.find(g_options.filter) == std::string::npos) return;
+
+        using Clock = std::chrono::steady_clock;
+
+        f();    // Прогрев: кэши, ленивые таблицы, емкость повторно используемых буферов
+
+        uint64_t iterations = 0;
+        const uint64_t allocations = g_allocations;
+        const Clock::time_point start = Clock::now();
+        double seconds = 0.;
+
+        do
+        {
+            f();
+            iterations++;
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        while (seconds < g_options.minTime);
+
+        const uint64_t allocated = g_allocations - allocations;
+        g_results.push_back(Result{name, packets * iterations, bytes * iterations, seconds, allocated});
+
+        const Result &result = g_results.back();
+        fprintf(stderr, "%-40s %12.1f ns/packet %10.1f MB/s %8.2f allocs/packet\n", name.c_str(),
+                result.seconds * 1e9 / result.packets,
+                result.bytes / result.seconds / 1e6,
+                static_cast<double>(result.allocations) / result.packets);
+    }
+
+    void writeJson(FILE *file)
+    {
+        fprintf(file, "{\n  \"benchmarks\": [\n");
+
+        for (size_t i = 0; i < g_results.size(); i++)
+        {
+            const Result &result = g_results[i];
+            fprintf(file, "    {\"name\": \"%s\", \"packets\": %llu, \"bytes\": %llu, \"seconds\": %.6f, "
+                          "\"ns_per_packet\": %.3f, \"bytes_per_second\": %.1f, \"allocs_per_packet\": %.4f}%s\n",
+                    result.name.c_str(),
+                    static_cast<unsigned long long>(result.packets),
+                    static_cast<unsigned long long>(result.bytes),
+                    result.seconds,
+                    result.seconds * 1e9 / result.packets,
+                    result.bytes / result.seconds,
+                    static_cast<double>(result.allocations) / result.packets,
+                    i + 1 < g_results.size() ? "," : "");
+        }
+
+        fprintf(file, "  ]\n}\n");
+    }
+
+    //! Размер пар структуры на линии (для пересчета в байты/с)
+    template<typename Pairs>
+    size_t wireSize(const Pairs &pairs)
+    {
+        return k_headerSize + pairs.size() * k_valueSize + k_crcSize;
+    }
+
+    //! toPairs/fromPairs одного типа: преобразование в пары и обратно с повторным использованием буферов
+    template<typename T>
+    void benchCodec(const std::string &name, const T &value)
+    {
+        std::vector<Pair> pairs;
+        toPairs(value, pairs);
+        const size_t bytes = wireSize(pairs);
+
+        run("toPairs/" + name, 1, bytes, [&]()
+        {
+            toPairs(value, pairs);
+            g_sink += pairs.size();
+        });
+
+        T decoded;
+        run("fromPairs/" + name, 1, bytes, [&]()
+        {
+            fromPairs(pairs, decoded);
+            g_sink += sizeof(decoded);
+        });
+
+        // Пары пакета (Package::pairs) со встроенным буфером
+        PairList list;
+        run("toPairs/" + name + "/pairList", 1, bytes, [&]()
+        {
+            toPairs(value, list);
+            g_sink += list.size();
+        });
+
+        run("fromPairs/" + name + "/pairList", 1, bytes, [&]()
+        {
+            fromPairs(list, decoded);
+            g_sink += sizeof(decoded);
+        });
+    }
+
+    void benchCrc(const Corpus::Stream &stream)
+    {
+        const Crc32Engine current = Crc32::engine();
+        const struct { Crc32Engine engine; const char *name; } engines[] = {
+            {Crc32Engine::Table, "table"}, {Crc32Engine::Slice8, "slice8"},
+            {Crc32Engine::Slice16, "slice16"}, {Crc32Engine::Pclmul, "pclmul"}};
+
+        for (const auto &item: engines)
+        {
+            Crc32::setEngine(item.engine);
+            if (Crc32::engine() != item.engine) continue;
+
+            run(std::string("crc32/") + item.name + "/telemetry", stream.packages.size(), stream.bytes.size(), [&]()
+            {
+                size_t shift = 0;
+                while (shift < stream.bytes.size())
+                {
+                    const size_t size = wireSize(stream.packages.front().pairs);
+                    g_sink += crc32(stream.bytes.data() + shift, static_cast<unsigned long>(size - k_crcSize));
+                    shift += size;
+                }
+            });
+
+            run(std::string("crc32/") + item.name + "/64KiB", 1, 65536, [&]()
+            {
+                g_sink += crc32(stream.bytes.data(), 65536);
+            });
+        }
+
+        Crc32::setEngine(current);
+    }
+
+    void benchPack(const Corpus::Stream &telemetry, const Corpus::Stream &route)
+    {
+        std::vector<char> out;
+
+        run("pack/telemetry", telemetry.packages.size(), telemetry.bytes.size(), [&]()
+        {
+            for (const Package &package: telemetry.packages)
+            {
+                pack(package, out);
+                g_sink += out.size();
+            }
+        });
+
+        std::vector<PackSlice> slices;
+        run("packBatch/telemetry", telemetry.packages.size(), telemetry.bytes.size(), [&]()
+        {
+            out.clear();
+            slices.clear();
+            packBatch(telemetry.packages, out, slices);
+            g_sink += out.size();
+        });
+
+        run("pack/route10k", route.packages.size(), route.bytes.size(), [&]()
+        {
+            for (const Package &package: route.packages)
+            {
+                pack(package, out);
+                g_sink += out.size();
+            }
+        });
+    }
+
+    void benchUnpack(const Corpus::Stream &telemetry, const Corpus::Stream &route)
+    {
+        Package package;
+
+        run("unpack/telemetry", telemetry.packages.size(), telemetry.bytes.size(), [&]()
+        {
+            size_t shift = 0;
+            while (shift < telemetry.bytes.size())
+                if (unpack(telemetry.bytes.data(), telemetry.bytes.size(), shift, package) == UnpackStatus::Success)
+                    g_sink += package.pairs.size();
+        });
+
+        run("unpack/route10k", route.packages.size(), route.bytes.size(), [&]()
+        {
+            size_t shift = 0;
+            while (shift < route.bytes.size())
+                if (unpack(route.bytes.data(), route.bytes.size(), shift, package) == UnpackStatus::Success)
+                    g_sink += package.pairs.size();
+        });
+
+        PackageView view;
+        Telemetry value;
+        run("view+fromPairs/telemetry", telemetry.packages.size(), telemetry.bytes.size(), [&]()
+        {
+            size_t shift = 0;
+            while (shift < telemetry.bytes.size())
+            {
+                if (view.parse(telemetry.bytes.data(), telemetry.bytes.size(), shift) != UnpackStatus::Success)
+                    continue;
+
+                fromPairs(view, value);
+                g_sink += value.currentPoint;
+            }
+        });
+
+        run("unpack+fromPairs/telemetry", telemetry.packages.size(), telemetry.bytes.size(), [&]()
+        {
+            size_t shift = 0;
+            while (shift < telemetry.bytes.size())
+            {
+                if (unpack(telemetry.bytes.data(), telemetry.bytes.size(), shift, package) != UnpackStatus::Success)
+                    continue;
+
+                fromPairs(package.pairs, value);
+                g_sink += value.currentPoint;
+            }
+        });
+
+        const size_t packSize = wireSize(telemetry.packages.front().pairs);
+        run("decodeTelemetry/telemetry", telemetry.packages.size(), telemetry.bytes.size(), [&]()
+        {
+            for (size_t shift = 0; shift < telemetry.bytes.size(); shift += packSize)
+            {
+                decodeTelemetry(telemetry.bytes.data() + shift, packSize, value);
+                g_sink += value.currentPoint;
+            }
+        });
+    }
+
+    void benchCorrupted(const Corpus::Stream &telemetry)
+    {
+        size_t valid = 0;
+        const std::vector<char> stream = Corpus::corrupt(telemetry, 10, valid);
+        Package package;
+
+        // Пакетами считаются только неповрежденные: столько получает приложение
+        run("unpack/corrupted", valid, stream.size(), [&]()
+        {
+            size_t shift = 0;
+            while (shift < stream.size())
+                if (unpack(stream.data(), stream.size(), shift, package) == UnpackStatus::Success)
+                    g_sink += package.pairs.size();
+        });
+
+        FrameAssembler assembler;
+        run("frameAssembler/corrupted", valid, stream.size(), [&]()
+        {
+            assembler.clear();
+
+            // Порции размером с сегмент TCP
+            const size_t chunk = 1448;
+            for (size_t shift = 0; shift < stream.size(); shift += chunk)
+            {
+                const size_t size = stream.size() - shift < chunk ? stream.size() - shift : chunk;
+                g_sink += assembler.feed(stream.data() + shift, size, [](const PackageView &view)
+                {
+                    g_sink += view.size();
+                });
+            }
+        });
+    }
+
+    void benchCodecs()
+    {
+        benchCodec("telemetry", Corpus::telemetry(1));
+        benchCodec("route100", Corpus::route(100));
+        benchCodec("route10k", Corpus::route(10000));
+        benchCodec("coords100", Corpus::areaAfs(100).points);
+        benchCodec("areaAfs100", Corpus::areaAfs(100));
+        benchCodec("areaRln100", Corpus::areaRln(100));
+        benchCodec("shootPoint", Corpus::shootPoint());
+        benchCodec("trackerEnable", Corpus::trackerEnable());
+        benchCodec("groupMode", Corpus::groupMode());
+        benchCodec("selfId", Corpus::selfId());
+        benchCodec("networkParams", Corpus::networkParams());
+        benchCodec("manualControl", Corpus::manualControl());
+    }
+
+    void benchFragments(const Corpus::Stream &route)
+    {
+        std::vector<Pair> pairs;
+        toPairs(Corpus::route(10000), pairs);
+        const Package source(Header(DataSource::Computer, DataType::FlightByPoints, 1), pairs);
+
+        std::vector<Package> fragments;
+        run("fragment/route10k", route.packages.size(), route.bytes.size(), [&]()
+        {
+            fragments.clear();
+            g_sink += fragment(source, 1, fragments);
+        });
+
+        Reassembler reassembler;
+        Package result;
+        run("reassemble/route10k", route.packages.size(), route.bytes.size(), [&]()
+        {
+            size_t shift = 0;
+            PackageView view;
+            while (shift < route.bytes.size())
+                if (view.parse(route.bytes.data(), route.bytes.size(), shift) == UnpackStatus::Success &&
+                    reassembler.add(view, result))
+                    g_sink += result.pairs.size();
+        });
+    }
+
+#ifdef QT_CORE_LIB
+    //! Телеметрия автопилота в формате MessagePack (как ее присылает автопилот по TCP)
+    QByteArray msgPackTelemetry(const Telemetry &value)
+    {
+        QVariantMap map;
+        map.insert("latitude", value.lat);
+        map.insert("longitude", value.lon);
+        map.insert("altitude", value.alt);
+        map.insert("pitch", degToRad(value.pitch));
+        map.insert("roll", degToRad(value.roll));
+        map.insert("azimuth", degToRad(value.course));
+        map.insert("speed", value.speed);
+        return MsgPack::pack(map);
+    }
+
+    QByteArray msgPackRoute(const std::vector<FlightPoint> &route)
+    {
+        QVariantList points;
+        for (const FlightPoint &point: route)
+        {
+            QVariantMap item;
+            item.insert("lat", point.point.lat);
+            item.insert("lon", point.point.lon);
+            item.insert("alt", point.point.alt);
+            points.append(item);
+        }
+
+        QVariantMap map;
+        map.insert("count", static_cast<uint>(route.size() - 1));
+        map.insert("current", 0u);
+        map.insert("points", points);
+        return MsgPack::pack(map);
+    }
+
+    //! Разбор тех же полей, что и в TcpUdpTranslator::dataRead
+    void benchMsgPack()
+    {
+        const QByteArray telemetry = msgPackTelemetry(Corpus::telemetry(1));
+        Telemetry value;
+
+        run("msgpack/telemetry", 1, static_cast<uint64_t>(telemetry.size()), [&]()
+        {
+            const QVariantMap map = MsgPack::unpack(telemetry).toMap();
+            if (!map.contains(QLatin1String("latitude"))) return;
+
+            value.lat = map.value("latitude").toDouble();
+            value.lon = map.value("longitude").toDouble();
+            value.alt = map.value("altitude").toFloat();
+            value.pitch = radToDeg(map.value("pitch").toFloat());
+            value.roll = radToDeg(map.value("roll").toFloat());
+            value.course = radToDeg(map.value("azimuth").toFloat());
+            value.speed = map.value("speed").toFloat();
+            value.dateTime = uint32_t(QDateTime::currentDateTime().toSecsSinceEpoch());
+            g_sink += value.dateTime;
+        });
+
+        const QByteArray route = msgPackRoute(Corpus::route(10000));
+        std::vector<FlightPoint> points;
+
+        run("msgpack/route10k", 1, static_cast<uint64_t>(route.size()), [&]()
+        {
+            const QVariantMap map = MsgPack::unpack(route).toMap();
+            const QVariantList list = map.value("points").toList();
+
+            points.clear();
+            for (int i = 0; i < list.size(); i++)
+            {
+                const QVariantMap item = list.at(i).toMap();
+                points.push_back(FlightPoint(Coords(static_cast<uint16_t>(i),
+                                                    item.value("lat").toDouble() * kPi / 180,
+                                                    item.value("lon").toDouble() * kPi / 180,
+                                                    item.value("alt").toFloat())));
+            }
+            g_sink += points.size();
+        });
+
+        // Разбор без QVariant, как в TcpUdpTranslator::dataRead
+        AutopilotMsgPack::Stream stream;
+        run("msgpack/telemetry-direct", 1, static_cast<uint64_t>(telemetry.size()), [&]()
+        {
+            stream.append(telemetry.constData(), static_cast<size_t>(telemetry.size()));
+
+            const char *message = nullptr;
+            size_t size = 0;
+            while (stream.next(message, size))
+                if (AutopilotMsgPack::decodeTelemetry(message, size, value)) g_sink += static_cast<uint64_t>(value.alt);
+        });
+
+        uint32_t current = 0;
+        run("msgpack/route10k-direct", 1, static_cast<uint64_t>(route.size()), [&]()
+        {
+            if (AutopilotMsgPack::decodeRoute(route.constData(), static_cast<size_t>(route.size()), points, current))
+                g_sink += points.size();
+        });
+    }
+#endif
+
+    void usage(const char *name)
+    {
+        fprintf(stderr, "usage: %s [--filter substring] [--min-time seconds] [--json file]\n"
+                        "JSON is written to stdout unless --json is given\n", name);
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasValue = i + 1 < argc;
+
+        if (!strcmp(argv[i], "--filter") && hasValue) g_options.filter = argv[++i];
+        else if (!strcmp(argv[i], "--min-time") && hasValue) g_options.minTime = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && hasValue) g_options.json = argv[++i];
+        else { usage(argv[0]); return 1; }
+    }
+
+    const Corpus::Stream telemetry = Corpus::telemetryBurst(50, 200);
+    const Corpus::Stream route = Corpus::routeStream(10000);
+
+    benchCrc(telemetry);
+    benchPack(telemetry, route);
+    benchUnpack(telemetry, route);
+    benchCorrupted(telemetry);
+    benchCodecs();
+    benchFragments(route);
+#ifdef QT_CORE_LIB
+    benchMsgPack();
+#endif
+
+    FILE *file = g_options.json ? fopen(g_options.json, "w") : stdout;
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s\n", g_options.json);
+        return 1;
+    }
+
+    writeJson(file);
+    if (file != stdout) fclose(file);
+
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include "connectionmanager.h"
+
+#include <algorithm>
+#include <cmath>
+
+AutopilotSession::AutopilotSession(const AutopilotConfig &config, const ReconnectPolicy &policy,
+                                   std::mt19937 &random, QObject *parent)
+    : QObject{parent}, m_config(config), m_policy(policy), m_random(random),
+      m_state(SessionState::Idle), m_failures(0)
+{
+    // Транслятор и таймер - дочерние объекты и переходят в поток менеджера вместе с сеансом.
+    // Сеанс использует только TCP: сокет UDP транслятора не создается
+    m_translator = new TcpUdpTranslator(this);
+    m_translator->setIPAddress(ProtocolType::TCP, DirectionType::Blank, config.host);
+    m_translator->setPort(ProtocolType::TCP, DirectionType::Blank, config.port);
+    m_translator->setAPType(config.protocol);
+    m_translator->setSocketTuning(config.tuning);
+
+    if (config.telemetryPeriod > 0) m_translator->setPollPeriod(AutopilotProtocol::BoardTelemetry, config.telemetryPeriod);
+    if (config.routePeriod > 0) m_translator->setPollPeriod(AutopilotProtocol::RoutePoints, config.routePeriod);
+    if (config.supervisorPeriod > 0) m_translator->setPollPeriod(AutopilotProtocol::Supervisor, config.supervisorPeriod);
+
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+
+    QObject::connect(m_timer, &QTimer::timeout, this, [=]
+    {
+        if (m_state == SessionState::Connecting)
+        {
+            qDebug() << m_config.name << "connect timeout";
+            connectionLost();
+        }
+        else if (m_state == SessionState::Backoff)
+        {
+            connectNow();
+        }
+        else if (m_state == SessionState::Connected)
+        {
+            connectionAlive();
+        }
+    });
+
+    QObject::connect(m_translator, &TcpUdpTranslator::tcpConnected, this, [=]
+    {
+        if (m_state != SessionState::Connecting) return;
+
+        // Неудачи сбрасываются, когда соединение доказало, что работает
+        m_timer->start(m_policy.stableTime);
+        setState(SessionState::Connected);
+    });
+
+    QObject::connect(m_translator, &TcpUdpTranslator::tcpReceived, this, [=]{ connectionAlive(); });
+    QObject::connect(m_translator, &TcpUdpTranslator::telemetryReceived, this, [=]{ connectionAlive(); });
+    QObject::connect(m_translator, &TcpUdpTranslator::routeReceived, this, [=]{ connectionAlive(); });
+
+    QObject::connect(m_translator, &TcpUdpTranslator::tcpDisconnected, this, [=]
+    {
+        if (m_state == SessionState::Connecting || m_state == SessionState::Connected) connectionLost();
+    });
+}
+
+void AutopilotSession::start()
+{
+    if (m_state == SessionState::Connecting || m_state == SessionState::Connected) return;
+
+    m_failures = 0;
+    connectNow();
+}
+
+void AutopilotSession::stop()
+{
+    // Состояние меняется до разрыва: сигнал разрыва уже не вызывает переподключение
+    m_timer->stop();
+    setState(SessionState::Stopped);
+    m_translator->disconnectFromServer();
+}
+
+void AutopilotSession::setState(SessionState state)
+{
+    if (m_state == state) return;
+
+    m_state = state;
+    emit stateChanged(state);
+}
+
+void AutopilotSession::connectNow()
+{
+    // Подключение раньше смены состояния: разрыв прежнего сокета не считается неудачей новой попытки
+    m_translator->connectToServer(ProtocolType::TCP);
+    setState(SessionState::Connecting);
+    m_timer->start(m_policy.connectTimeout);
+}
+
+void AutopilotSession::connectionLost()
+{
+    setState(SessionState::Backoff);
+    m_translator->disconnectFromServer();
+
+    const int delay = backoffDelay();
+    m_failures++;
+    m_timer->start(delay);
+}
+
+void AutopilotSession::connectionAlive()
+{
+    if (m_state != SessionState::Connected || m_failures == 0) return;
+
+    m_timer->stop();
+    m_failures = 0;
+}
+
+int AutopilotSession::backoffDelay()
+{
+    // Пауза растет в multiplier раз после каждой неудачи; случайная - от половины до полной
+    const double grown = m_policy.initialDelay * std::pow(m_policy.multiplier, std::min(m_failures, 30));
+    const int delay = std::max(0, static_cast<int>(std::min<double>(grown, m_policy.maxDelay)));
+
+    std::uniform_int_distribution<int> jitter(delay / 2, delay);
+    return jitter(m_random);
+}
+
+ConnectionManager::ConnectionManager(QObject *parent)
+    : QObject{parent}, m_random(std::random_device()())
+{
+    qRegisterMetaType<SessionState>();
+}
+
+void ConnectionManager::setSessions(const QList<AutopilotConfig> &configs, const ReconnectPolicy &policy)
+{
+    stop();
+    qDeleteAll(m_sessions);
+    m_sessions.clear();
+
+    for (const AutopilotConfig &config: configs)
+    {
+        const int index = m_sessions.size();
+        AutopilotSession *session = new AutopilotSession(config, policy, m_random, this);
+        TcpUdpTranslator *translator = session->translator();
+
+        QObject::connect(session, &AutopilotSession::stateChanged, this,
+                         [=](SessionState state){ emit stateChanged(index, state); });
+        QObject::connect(translator, &TcpUdpTranslator::tcpReceived, this,
+                         [=](const QByteArray &data){ emit tcpReceived(index, data); });
+        QObject::connect(translator, &TcpUdpTranslator::telemetryReceived, this,
+                         [=](const GroupFlight::Telemetry &telemetry){ emit telemetryReceived(index, telemetry); });
+        QObject::connect(translator, &TcpUdpTranslator::routeReceived, this,
+                         [=](const std::vector<GroupFlight::FlightPoint> &route){ emit routeReceived(index, route); });
+
+        m_sessions.append(session);
+    }
+}
+
+AutopilotSession *ConnectionManager::session(int index) const
+{
+    return (index >= 0 && index < m_sessions.size()) ? m_sessions.at(index) : nullptr;
+}
+
+void ConnectionManager::start()
+{
+    for (AutopilotSession *session: m_sessions)
+        session->start();
+}
+
+void ConnectionManager::stop()
+{
+    for (AutopilotSession *session: m_sessions)
+        if (session->state() != SessionState::Idle) session->stop();
+}
+
+void ConnectionManager::write(int index, const QByteArray &data)
+{
+    AutopilotSession *current = session(index);
+    if (current && current->translator()->isConnected()) current->translator()->write(ProtocolType::TCP, data);
+}
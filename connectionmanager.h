@@ -0,0 +1,122 @@
+#ifndef CONNECTIONMANAGER_H
+#define CONNECTIONMANAGER_H
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <random>
+#include <vector>
+#include "tcpudptranslator.h"
+
+//! Подключение к автопилоту борта
+struct AutopilotConfig
+{
+    QString name;                                               //!< Имя для журнала и интерфейса
+    QString host;                                               //!< Адрес автопилота
+    quint16 port = 0;                                           //!< Порт TCP автопилота
+    AutopilotProtocol protocol = AutopilotProtocol::BoardTelemetry; //!< Запрос после подключения, если опрос не задан
+    int telemetryPeriod = 0;                                    //!< Период опроса телеметрии, мс (0 - без опроса)
+    int routePeriod = 0;                                        //!< Период опроса маршрута, мс
+    int supervisorPeriod = 0;                                   //!< Период опроса супервизора, мс
+    SocketTuning::Profile tuning = SocketTuning::Profile::lowLatency(); //!< Параметры сокета TCP
+};
+
+//! Переподключение после обрыва или неудачной попытки
+struct ReconnectPolicy
+{
+    int connectTimeout = 3000;      //!< Ожидание подключения, мс
+    int initialDelay = 500;         //!< Пауза перед первой повторной попыткой, мс
+    int maxDelay = 30000;           //!< Наибольшая пауза, мс
+    double multiplier = 2.;         //!< Рост паузы после каждой неудачи
+    int stableTime = 10000;         //!< Соединение без ответов автопилота считается рабочим через столько мс
+};
+
+//! Состояние сеанса связи с автопилотом
+enum class SessionState : uint8_t
+{
+    Idle,           //!< Не запускался
+    Connecting,     //!< Идет подключение
+    Connected,      //!< Соединение установлено
+    Backoff,        //!< Пауза перед повторной попыткой
+    Stopped         //!< Остановлен
+};
+
+Q_DECLARE_METATYPE(SessionState)
+
+//! \brief Сеанс связи с одним автопилотом: подключение с ограничением времени и переподключение
+//! с экспоненциально растущей паузой со случайным разбросом (чтобы десятки бортов после общего
+//! сбоя не подключались одновременно). Работает в потоке своего ConnectionManager
+class AutopilotSession : public QObject
+{
+    Q_OBJECT
+public:
+    AutopilotSession(const AutopilotConfig &config, const ReconnectPolicy &policy,
+                     std::mt19937 &random, QObject *parent = nullptr);
+
+    void start();
+    void stop();
+
+    SessionState state() const { return m_state; }
+    const AutopilotConfig &config() const { return m_config; }
+    TcpUdpTranslator *translator() const { return m_translator; }
+
+    //! \brief Неудачных попыток подряд
+    //! Сбрасывается не при подключении, а после первого ответа автопилота или stableTime без разрыва:
+    //! автопилот, принимающий соединения и сразу их закрывающий, не переподключается без паузы
+    int failures() const { return m_failures; }
+
+signals:
+    void stateChanged(SessionState state);
+
+private:
+    void setState(SessionState state);
+    void connectNow();
+    void connectionLost();
+    void connectionAlive();
+    int backoffDelay();
+
+    AutopilotConfig     m_config;
+    ReconnectPolicy     m_policy;
+    std::mt19937        &m_random;
+    TcpUdpTranslator    *m_translator;
+    QTimer              *m_timer;           // Ожидание подключения, пауза перед повторной попыткой или stableTime
+    SessionState        m_state;
+    int                 m_failures;
+};
+
+//! \brief Связь с автопилотами всех бортов по списку подключений
+//! Все сеансы работают в одном потоке (потоке менеджера) и обслуживаются одним циклом событий:
+//! на борт приходится один сокет TCP, без отдельного транслятора в интерфейсе.
+//! Сигналы несут номер сеанса в списке
+class ConnectionManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConnectionManager(QObject *parent = nullptr);
+
+    //! \brief Список подключений; задается до start()
+    void setSessions(const QList<AutopilotConfig> &configs, const ReconnectPolicy &policy = ReconnectPolicy());
+
+    int count() const { return m_sessions.size(); }
+    AutopilotSession *session(int index) const;
+
+    //! \brief Запуск и остановка всех сеансов; вызываются в потоке менеджера
+    void start();
+    void stop();
+
+    //! \brief Отправка данных автопилоту сеанса index (если соединение установлено)
+    void write(int index, const QByteArray &data);
+
+signals:
+    void stateChanged(int session, SessionState state);
+    void tcpReceived(int session, const QByteArray &data);
+    void telemetryReceived(int session, const GroupFlight::Telemetry &telemetry);
+    void routeReceived(int session, const std::vector<GroupFlight::FlightPoint> &route);
+
+private:
+    QList<AutopilotSession *>   m_sessions;
+    std::mt19937                m_random;
+};
+
+#endif // CONNECTIONMANAGER_H
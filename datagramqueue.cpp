@@ -0,0 +1,122 @@
+#include "datagramqueue.h"
+
+#include <algorithm>
+
+DatagramQueue::DatagramQueue(size_t perSender, size_t senders)
+    : perSenderLimit(std::max<size_t>(perSender, 1)), sendersLimit(std::max<size_t>(senders, 1))
+{
+}
+
+void DatagramQueue::setLimits(size_t perSender, size_t senders)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    perSenderLimit = std::max<size_t>(perSender, 1);
+    sendersLimit = std::max<size_t>(senders, 1);
+
+    // Уже принятые сверх нового предела вытесняются, как при переполнении
+    for (Sender &sender: this->senders)
+    {
+        while (sender.queue.size() > perSenderLimit)
+        {
+            sender.queue.pop_front();
+            count--;
+            counters.dropped++;
+        }
+    }
+}
+
+bool DatagramQueue::push(Datagram &&datagram)
+{
+    const uint64_t sender = key(datagram.host, datagram.port);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto position = index.find(sender);
+    if (position == index.end())
+    {
+        if (senders.size() >= sendersLimit)
+        {
+            counters.dropped++;
+            return false;
+        }
+
+        position = index.emplace(sender, senders.size()).first;
+        senders.push_back(Sender{sender, std::deque<Datagram>()});
+    }
+
+    std::deque<Datagram> &queue = senders[position->second].queue;
+
+    bool kept = true;
+    if (queue.size() >= perSenderLimit)
+    {
+        queue.pop_front();
+        count--;
+        counters.dropped++;
+        kept = false;
+    }
+
+    queue.push_back(std::move(datagram));
+    count++;
+    counters.received++;
+    return kept;
+}
+
+size_t DatagramQueue::take(std::vector<Datagram> &out, size_t max)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t taken = 0;
+    while (taken < max && count > 0)
+    {
+        if (cursor >= senders.size()) cursor = 0;
+
+        Sender &sender = senders[cursor];
+        out.push_back(std::move(sender.queue.front()));
+        sender.queue.pop_front();
+        count--;
+        taken++;
+
+        if (!sender.queue.empty())
+        {
+            cursor++;
+            continue;
+        }
+
+        // Отправитель без датаграмм освобождает место: на него встает последний, cursor не сдвигается
+        index.erase(sender.key);
+        if (cursor + 1 < senders.size())
+        {
+            sender = std::move(senders.back());
+            index[sender.key] = cursor;
+        }
+        senders.pop_back();
+    }
+
+    return taken;
+}
+
+size_t DatagramQueue::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+void DatagramQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    senders.clear();
+    index.clear();
+    cursor = 0;
+    count = 0;
+}
+
+DatagramQueue::Stats DatagramQueue::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    Stats result = counters;
+    result.senders = senders.size();
+    return result;
+}
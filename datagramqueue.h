@@ -0,0 +1,74 @@
+#ifndef DATAGRAMQUEUE_H
+#define DATAGRAMQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//! Принятая датаграмма с отправителем и временем приема
+struct Datagram
+{
+    std::vector<char> data;
+    uint32_t host = 0;          //!< Адрес отправителя (порядок байт узла)
+    uint16_t port = 0;
+    int64_t timestamp = 0;      //!< Время приема, нс от начала эпохи: ядром, если доступно, иначе при чтении
+};
+
+//! \brief Ограниченная очередь принятых датаграмм с отдельной очередью на каждого отправителя
+//! Переполнение очереди отправителя вытесняет его самые старые датаграммы, поэтому частый
+//! отправитель не вытесняет остальных. Датаграммы забираются пачкой: по одной от каждого
+//! отправителя по кругу, в порядке приема внутри отправителя. Потокобезопасна
+class DatagramQueue
+{
+public:
+    //! \param perSender - датаграмм в очереди одного отправителя
+    //! \param senders - отправителей с непустой очередью; датаграммы новых сверх этого отбрасываются
+    explicit DatagramQueue(size_t perSender = 1024, size_t senders = 64);
+
+    void setLimits(size_t perSender, size_t senders);
+
+    //! \return false, если датаграмма отброшена или вытеснила более старую
+    bool push(Datagram &&datagram);
+
+    //! \brief Перенос до max датаграмм в конец out
+    //! \return количество перенесенных датаграмм
+    size_t take(std::vector<Datagram> &out, size_t max = std::numeric_limits<size_t>::max());
+
+    //! \brief Датаграмм в очереди
+    size_t size() const;
+
+    void clear();
+
+    struct Stats
+    {
+        uint64_t received = 0;      //!< Поставлено в очередь
+        uint64_t dropped = 0;       //!< Вытеснено или отброшено
+        size_t senders = 0;         //!< Отправителей с непустой очередью
+    };
+
+    Stats stats() const;
+
+private:
+    struct Sender
+    {
+        uint64_t key;
+        std::deque<Datagram> queue;
+    };
+
+    static uint64_t key(uint32_t host, uint16_t port) { return (uint64_t(host) << 16) | port; }
+
+    mutable std::mutex mutex;
+    std::vector<Sender> senders;                    // Отправители с непустой очередью
+    std::unordered_map<uint64_t, size_t> index;     // Номер отправителя в senders
+    size_t cursor = 0;                              // С кого начинается следующий круг take()
+    size_t count = 0;
+    size_t perSenderLimit;
+    size_t sendersLimit;
+    Stats counters;
+};
+
+#endif // DATAGRAMQUEUE_H
@@ -1,7 +1,139 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
 #include <QUdpSocket>
+#include <QSocketNotifier>
 #include <QDebug>
 
+#include "batchio.h"
+#include "bufferpool.h"
 #include "datatransmitter.h"
+#include "fragmenter.h"
+#include "ioengine.h"
+#include "policyqueue.h"
+#include "uringengine.h"
+
+namespace
+{
+    // Отметка времени разбора для всех пакетов порции
+    void stampDecoded(std::vector<GroupFlight::PackageView> &views)
+    {
+        const int64_t now = GroupFlight::wallClock();
+        for (size_t i = 0; i < views.size(); i++)
+        {
+            GroupFlight::Timestamps stamps = views[i].timestamps();
+            stamps.decoded = now;
+            views[i].setTimestamps(stamps);
+        }
+    }
+
+    // Фрагменты порции передаются в reassembler и убираются из views; пакеты, собранные из них, - в assembled
+    void collectFragments(std::vector<GroupFlight::PackageView> &views, GroupFlight::Reassembler &reassembler,
+                          std::vector<GroupFlight::Package> &assembled)
+    {
+        assembled.clear();
+
+        GroupFlight::Package package;
+        size_t kept = 0;
+        for (size_t i = 0; i < views.size(); i++)
+        {
+            if (!GroupFlight::isFragment(views[i]))
+            {
+                if (kept != i) views[kept] = views[i];
+                kept++;
+                continue;
+            }
+
+            if (reassembler.add(views[i], package)) assembled.push_back(std::move(package));
+        }
+
+        views.resize(kept);
+    }
+
+    // Прием порций датаграмм из сокета, пока его очередь не опустеет. Пакеты каждой порции
+    // разбираются в views с временем приема ядром (SO_TIMESTAMPNS), после чего вызывается batch(received, bytes)
+    template<typename Callback>
+    void drainSocket(int socket, GroupFlight::PacketBufferPool &pool,
+                     std::vector<GroupFlight::PackageView> &views, Callback batch)
+    {
+        while (true)
+        {
+            GroupFlight::PacketBufferPool::Buffer buffers[BatchIo::k_maxBatch];
+            BatchIo::Origin origins[BatchIo::k_maxBatch];
+
+            size_t count = 0;
+            while (count < BatchIo::k_maxBatch && (buffers[count] = pool.acquire()))
+                count++;
+
+            const int received = BatchIo::receive(socket, buffers, origins, count);
+            if (received <= 0) return;
+
+            // Без отметки ядра - время чтения
+            const int64_t readTime = GroupFlight::wallClock();
+
+            views.clear();
+            uint64_t bytes = 0;
+            for (int i = 0; i < received; i++)
+            {
+                bytes += buffers[i].size();
+
+                GroupFlight::Timestamps stamps;
+                stamps.wire = origins[i].timestamp != 0 ? origins[i].timestamp : readTime;
+
+                GroupFlight::PackageView view;
+                size_t shift = 0;
+                while (shift < buffers[i].size())
+                {
+                    if (view.parse(buffers[i].data(), buffers[i].size(), shift) != GroupFlight::UnpackStatus::Success) continue;
+
+                    view.setTimestamps(stamps);
+                    views.push_back(view);
+                }
+            }
+
+            stampDecoded(views);
+            batch(received, bytes);
+
+            // Очередь сокета опустела
+            if (static_cast<size_t>(received) < count) return;
+        }
+    }
+
+    // Шард приема: сокет группы SO_REUSEPORT со своим потоком и цепочкой обработчиков
+    struct Shard
+    {
+        int socket = -1;
+        IoEngine engine;
+        GroupFlight::PacketBufferPool pool{BatchIo::k_maxBatch};
+        GroupFlight::Arena arena;
+        std::vector<GroupFlight::PackageView> views;
+        GroupFlight::Reassembler reassembler;
+        std::vector<GroupFlight::Package> assembled;
+        GroupFlight::Interface handlers;
+
+        std::atomic<uint64_t> datagramsCount{0};
+        std::atomic<uint64_t> packagesCount{0};
+        std::atomic<uint64_t> bytesCount{0};
+
+        void received()
+        {
+            drainSocket(socket, pool, views, [this](int datagrams, uint64_t bytes)
+            {
+                arena.reset();
+                collectFragments(views, reassembler, assembled);
+                if (!views.empty()) handlers.setPackageBatchToHandlers(views.data(), views.size(), arena);
+                for (const GroupFlight::Package &package: assembled)
+                    handlers.setPackageToHandlers(package);
+
+                datagramsCount.fetch_add(static_cast<uint64_t>(datagrams), std::memory_order_relaxed);
+                packagesCount.fetch_add(views.size() + assembled.size(), std::memory_order_relaxed);
+                bytesCount.fetch_add(bytes, std::memory_order_relaxed);
+            });
+        }
+    };
+} // namespace
 
 struct DataTransmitter::DataTransmitterPrivate
 {
@@ -11,7 +143,132 @@ struct DataTransmitter::DataTransmitterPrivate
     quint16 portSrc = 1234;
     quint16 portDst = 4321;
 
-    //QVector<GroupFlight::Handler*> listeners;
+    QVector<GroupFlight::Handler*> listeners;
+
+    // Датаграммы читаются сразу в буферы пула, временные данные разбора - в арену,
+    // которая сбрасывается перед каждой порцией датаграмм
+    GroupFlight::PacketBufferPool pool{BatchIo::k_maxBatch};
+    GroupFlight::Arena arena;
+
+    // Пакетный режим: собственный сокет вместо QUdpSocket
+    bool batched = false;
+    int batchSocket = -1;
+    QSocketNotifier *notifier = nullptr;
+    std::vector<GroupFlight::PackageView> views;
+
+    // Прием в потоке ввода-вывода: пакеты передаются потребителю через очередь
+    IoEngine *engine = nullptr;
+    IoEngine *readerEngine = nullptr;   // Поток, обслуживающий сокет после start(): engine или fallback
+    bool threaded = false;
+    // Поток ввода-вывода не ждет потребителя: при переполнении отбрасываются и невытесняемые пакеты
+    GroupFlight::PolicyQueue<GroupFlight::Package> packages{4096, GroupFlight::QueuePolicy::DropOldest, 4096, false};
+    std::atomic<uint64_t> datagramsCount{0};
+    std::atomic<uint64_t> packagesCount{0};
+    std::atomic<uint64_t> bytesCount{0};
+
+    // Прием через io_uring; если ядро его не поддерживает - через epoll (IoEngine)
+    bool uringMode = false;
+    bool uringActive = false;
+    std::unique_ptr<UringEngine> uring;
+    std::unique_ptr<IoEngine> fallback;
+
+    // Шардированный прием
+    size_t shardsCount = 0;
+    BatchIo::Steering steering = BatchIo::Steering::SourceAddress;
+    ShardSetup shardSetup;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // Очередь отправки: пакеты друг за другом и их положение в буфере
+    std::vector<char> outData;
+    std::vector<GroupFlight::PackSlice> outSlices;
+
+    // Пакеты больше датаграммы отправляются фрагментами, фрагменты принятых собираются в пакеты
+    size_t maxDatagram = DataTransmitter::k_maxDatagram;
+    uint16_t messageId = 0;
+    std::vector<GroupFlight::Package> fragments;
+    GroupFlight::Reassembler reassembler;
+    std::vector<GroupFlight::Package> assembled;
+
+    // Задержки от приема до разбора, до вызова каждого получателя и до выдачи takePackage()
+    GroupFlight::LatencyTracker latency;
+
+    // Передача разобранной порции пакетов (views) получателям и, при приеме в потоке ввода-вывода, в очередь
+    void deliver(size_t received, uint64_t bytes)
+    {
+        arena.reset();
+        collectFragments(views, reassembler, assembled);
+        if (!views.empty())
+        {
+            for (const GroupFlight::PackageView &view: views)
+                latency.decoded(view.timestamps());
+
+            for (GroupFlight::Handler *listener: qAsConst(listeners))
+            {
+                const int64_t now = GroupFlight::wallClock();
+                for (const GroupFlight::PackageView &view: views)
+                    latency.delivered(view.timestamps(), now);
+
+                listener->setPackageBatch(views.data(), views.size(), arena);
+            }
+        }
+
+        for (const GroupFlight::Package &package: assembled)
+        {
+            for (GroupFlight::Handler *listener: qAsConst(listeners))
+            {
+                latency.delivered(package.stamps, GroupFlight::wallClock());
+                listener->setPackage(package);
+            }
+        }
+
+        datagramsCount.fetch_add(received, std::memory_order_relaxed);
+        packagesCount.fetch_add(views.size() + assembled.size(), std::memory_order_relaxed);
+        bytesCount.fetch_add(bytes, std::memory_order_relaxed);
+
+        if (!threaded) return;
+
+        GroupFlight::Package package;
+        for (const GroupFlight::PackageView &view: views)
+        {
+            view.toPackage(package);
+            const GroupFlight::Header header = package.header;
+            packages.push(std::move(package), header.type == GroupFlight::DataType::Telemetry, header.boardNumber);
+        }
+
+        for (GroupFlight::Package &value: assembled)
+        {
+            const GroupFlight::Header header = value.header;
+            packages.push(std::move(value), header.type == GroupFlight::DataType::Telemetry, header.boardNumber);
+        }
+    }
+
+    // Датаграммы уже приняты io_uring в буферы кольца
+    void uringReceived(const UringEngine::Chunk *chunks, size_t count)
+    {
+        // Многократный recv не передает служебных данных: время приема - время завершения
+        GroupFlight::Timestamps stamps;
+        stamps.wire = GroupFlight::wallClock();
+
+        views.clear();
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            bytes += chunks[i].size;
+
+            GroupFlight::PackageView view;
+            size_t shift = 0;
+            while (shift < chunks[i].size)
+            {
+                if (view.parse(chunks[i].data, chunks[i].size, shift) != GroupFlight::UnpackStatus::Success) continue;
+
+                view.setTimestamps(stamps);
+                views.push_back(view);
+            }
+        }
+
+        stampDecoded(views);
+        deliver(count, bytes);
+    }
 };
 
 DataTransmitter::DataTransmitter():
@@ -79,6 +336,64 @@ bool DataTransmitter::start(uint32_t host, uint16_t portIn, uint16_t portOut)
 
 bool DataTransmitter::start()
 {
+    if (d->shardsCount > 0) return startShards();
+
+    if (d->batched)
+    {
+        if (d->batchSocket >= 0) return true;
+
+        const QHostAddress host(d->host);
+        d->batchSocket = BatchIo::open(d->portSrc, host.isMulticast() ? host.toIPv4Address() : 0);
+        if (d->batchSocket < 0) return false;
+
+        if (!BatchIo::enableTimestamps(d->batchSocket))
+            qWarning() << "DataTransmitter: kernel receive timestamps are not available, read time is used";
+
+        d->readerEngine = d->engine;
+
+        if (d->uringMode)
+        {
+            if (!d->uring) d->uring.reset(new UringEngine(BatchIo::k_maxBatch));
+
+            DataTransmitterPrivate *data = d;
+            if (d->uring->addReceiver(d->batchSocket, [data](const UringEngine::Chunk *chunks, size_t count)
+                                      { data->uringReceived(chunks, count); }))
+            {
+                d->threaded = true;
+                if (d->uring->start())
+                {
+                    d->uringActive = true;
+                    return true;
+                }
+
+                d->uring->removeReceiver(d->batchSocket);
+            }
+
+            // Старое ядро: тот же прием порциями recvmmsg, но в потоке epoll
+            qWarning() << "DataTransmitter: io_uring is not available, falling back to epoll";
+            if (!d->readerEngine)
+            {
+                if (!d->fallback) d->fallback.reset(new IoEngine);
+                if (d->fallback->start()) d->readerEngine = d->fallback.get();
+            }
+        }
+
+        if (d->readerEngine)
+        {
+            d->threaded = true;
+            if (d->readerEngine->addReader(d->batchSocket, [=]{this->batchReceived();})) return true;
+
+            stop();
+            return false;
+        }
+
+        d->threaded = false;
+
+        d->notifier = new QSocketNotifier(d->batchSocket, QSocketNotifier::Read);
+        QObject::connect(d->notifier, &QSocketNotifier::activated, [=]{this->batchReceived();});
+        return true;
+    }
+
     if (!d->socket) return false;
 
     bool result = d->socket->bind(QHostAddress::AnyIPv4, d->portSrc,
@@ -95,26 +410,323 @@ bool DataTransmitter::start()
     return result;
 }
 
+bool DataTransmitter::startShards()
+{
+    if (!d->shards.empty()) return true;
+
+    if (QHostAddress(d->host).isMulticast()) return false;
+
+    const size_t cpus = std::thread::hardware_concurrency();
+
+    // Номер сокета в группе порта - порядок открытия, он же номер шарда
+    for (size_t i = 0; i < d->shardsCount; i++)
+    {
+        std::unique_ptr<Shard> shard(new Shard);
+        shard->socket = BatchIo::open(d->portSrc, 0, true);
+        if (shard->socket < 0)
+        {
+            stop();
+            return false;
+        }
+
+        BatchIo::enableTimestamps(shard->socket);
+        shard->views.reserve(BatchIo::k_maxBatch);
+        if (d->shardSetup) d->shardSetup(i, shard->handlers);
+
+        if (d->steering == BatchIo::Steering::Cpu)
+        {
+            std::vector<int> affinity;
+            for (size_t cpu = i; cpu < cpus; cpu += d->shardsCount)
+                affinity.push_back(static_cast<int>(cpu));
+            shard->engine.setAffinity(affinity);
+        }
+
+        d->shards.push_back(std::move(shard));
+    }
+
+    // Программа распределения устанавливается на всю группу, когда все сокеты уже открыты
+    if (!BatchIo::attachSteering(d->shards.front()->socket, d->steering, d->shardsCount))
+        qWarning() << "DataTransmitter: reuseport steering program was not attached, kernel hash is used";
+
+    for (const std::unique_ptr<Shard> &shard: d->shards)
+    {
+        Shard *current = shard.get();
+        if (!current->engine.addReader(current->socket, [current]{current->received();}) ||
+                !current->engine.start())
+        {
+            stop();
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void DataTransmitter::stop()
 {
+    for (const std::unique_ptr<Shard> &shard: d->shards)
+    {
+        shard->engine.removeReader(shard->socket);
+        shard->engine.stop();
+        BatchIo::close(shard->socket);
+    }
+    d->shards.clear();
+
+    if (d->batchSocket >= 0)
+    {
+        if (d->uringActive)
+        {
+            d->uring->removeReceiver(d->batchSocket);
+            d->uring->stop();
+            d->uringActive = false;
+        }
+
+        if (d->readerEngine) d->readerEngine->removeReader(d->batchSocket);
+        if (d->fallback) d->fallback->stop();
+        d->readerEngine = nullptr;
+
+        delete d->notifier;
+        d->notifier = nullptr;
+        BatchIo::close(d->batchSocket);
+        d->batchSocket = -1;
+    }
+
     if (d->socket->state() == QAbstractSocket::BoundState)
         d->socket->close();
 }
 
 bool DataTransmitter::isStarted()
 {
+    if (!d->shards.empty()) return true;
+    if (d->batched) return d->batchSocket >= 0;
     return (d->socket->state() == QAbstractSocket::BoundState);
 }
 
+bool DataTransmitter::setBatchMode(bool state)
+{
+    if (isStarted()) return false;
+    if (state && !BatchIo::supported()) return false;
+
+    d->batched = state;
+    if (state) d->views.reserve(BatchIo::k_maxBatch);
+    return true;
+}
+
+bool DataTransmitter::batchMode()
+{
+    return d->batched;
+}
+
+bool DataTransmitter::setIoEngine(IoEngine *engine)
+{
+    if (isStarted()) return false;
+    if (engine && !setBatchMode(true)) return false;
+
+    d->engine = engine;
+    return true;
+}
+
+bool DataTransmitter::setUringMode(bool state)
+{
+    if (isStarted()) return false;
+    if (state && !setBatchMode(true)) return false;
+
+    d->uringMode = state;
+    return true;
+}
+
+bool DataTransmitter::uringMode()
+{
+    return d->uringMode;
+}
+
+bool DataTransmitter::setQueuePolicy(GroupFlight::QueuePolicy policy)
+{
+    if (isStarted() || policy == GroupFlight::QueuePolicy::Block) return false;
+
+    d->packages.setPolicy(policy);
+    return true;
+}
+
+GroupFlight::QueuePolicy DataTransmitter::queuePolicy()
+{
+    return d->packages.policy();
+}
+
+bool DataTransmitter::uringActive()
+{
+    return d->uringActive;
+}
+
+bool DataTransmitter::setShards(size_t shards, BatchIo::Steering steering, ShardSetup setup)
+{
+    if (isStarted()) return false;
+    if (shards > 0 && !setBatchMode(true)) return false;
+
+    d->shardsCount = shards;
+    d->steering = steering;
+    d->shardSetup = std::move(setup);
+    return true;
+}
+
+size_t DataTransmitter::shardsCount()
+{
+    return d->shardsCount;
+}
+
+bool DataTransmitter::takePackage(GroupFlight::Package &package)
+{
+    if (!d->packages.pop(package)) return false;
+
+    if (!package.stamps.empty()) d->latency.dequeued(package.stamps, GroupFlight::wallClock());
+    return true;
+}
+
+GroupFlight::LatencyTracker::Snapshot DataTransmitter::latency()
+{
+    GroupFlight::LatencyTracker::Snapshot result = d->latency.snapshot();
+    for (const std::unique_ptr<Shard> &shard: d->shards)
+        result.add(shard->handlers.latency());
+    return result;
+}
+
+void DataTransmitter::resetLatency()
+{
+    d->latency.reset();
+    for (const std::unique_ptr<Shard> &shard: d->shards)
+        shard->handlers.resetLatency();
+}
+
+DataTransmitter::Summary DataTransmitter::summary()
+{
+    Summary result;
+    result.datagrams = d->datagramsCount.load(std::memory_order_relaxed);
+    result.packages = d->packagesCount.load(std::memory_order_relaxed);
+    result.bytes = d->bytesCount.load(std::memory_order_relaxed);
+
+    const GroupFlight::PolicyQueue<GroupFlight::Package>::Stats queue = d->packages.stats();
+    result.dropped = queue.dropped;
+    result.coalesced = queue.coalesced;
+
+    for (size_t i = 0; i < d->shards.size(); i++)
+    {
+        const Summary shard = summary(i);
+        result.datagrams += shard.datagrams;
+        result.packages += shard.packages;
+        result.bytes += shard.bytes;
+    }
+
+    return result;
+}
+
+DataTransmitter::Summary DataTransmitter::summary(size_t shard)
+{
+    Summary result;
+    if (shard >= d->shards.size()) return result;
+
+    const Shard &current = *d->shards[shard];
+    result.datagrams = current.datagramsCount.load(std::memory_order_relaxed);
+    result.packages = current.packagesCount.load(std::memory_order_relaxed);
+    result.bytes = current.bytesCount.load(std::memory_order_relaxed);
+    return result;
+}
+
 void DataTransmitter::sendData(const std::vector<char> &data)
 {
+    if (d->batched)
+    {
+        queueData(data);
+        flush();
+        return;
+    }
+
     if (!d->socket) return;
 
     QByteArray msg(QByteArray::fromRawData(data.data(), data.size()));
     d->socket->writeDatagram(msg, QHostAddress(d->host), d->portDst);
 }
 
-/*void DataTransmitter::addListener(GroupFlight::Handler *listener)
+bool DataTransmitter::queuePackage(const GroupFlight::Package &package)
+{
+    const size_t size = GroupFlight::k_headerSize + package.pairs.size() * GroupFlight::k_valueSize + GroupFlight::k_crcSize;
+    if (size <= d->maxDatagram)
+    {
+        const size_t offset = d->outData.size();
+        if (GroupFlight::packAppend(package, d->outData) != GroupFlight::PackStatus::Success) return false;
+
+        d->outSlices.push_back(GroupFlight::PackSlice(offset, d->outData.size() - offset));
+        return true;
+    }
+
+    // Не помещается в датаграмму: фрагменты отправляются отдельными датаграммами
+    d->fragments.clear();
+    if (GroupFlight::fragment(package, d->messageId++, d->fragments, d->maxDatagram) == 0) return false;
+
+    for (const GroupFlight::Package &fragment: d->fragments)
+    {
+        const size_t offset = d->outData.size();
+        if (GroupFlight::packAppend(fragment, d->outData) != GroupFlight::PackStatus::Success) return false;
+
+        d->outSlices.push_back(GroupFlight::PackSlice(offset, d->outData.size() - offset));
+    }
+
+    return true;
+}
+
+void DataTransmitter::setMaxDatagramSize(size_t size)
+{
+    const size_t limit = k_maxDatagram;
+    d->maxDatagram = std::max(GroupFlight::k_minFragmentSize, std::min(size, limit));
+}
+
+size_t DataTransmitter::maxDatagramSize()
+{
+    return d->maxDatagram;
+}
+
+void DataTransmitter::queueData(const std::vector<char> &data)
+{
+    d->outSlices.push_back(GroupFlight::PackSlice(d->outData.size(), data.size()));
+    d->outData.insert(d->outData.end(), data.begin(), data.end());
+}
+
+size_t DataTransmitter::flush()
+{
+    size_t sent = 0;
+
+    // При шардированном приеме отправка идет через сокет первого шарда
+    const int socket = d->shards.empty() ? d->batchSocket : d->shards.front()->socket;
+
+    if (d->uringActive)
+    {
+        const int result = d->uring->send(socket, ipFromString(d->host.toLatin1().constData()), d->portDst,
+                                          d->outData.data(), d->outSlices.data(), d->outSlices.size());
+        if (result > 0) sent = static_cast<size_t>(result);
+    }
+    else if (d->batched && socket >= 0)
+    {
+        const int result = BatchIo::send(socket, ipFromString(d->host.toLatin1().constData()), d->portDst,
+                                         d->outData.data(), d->outSlices.data(), d->outSlices.size());
+        if (result > 0) sent = static_cast<size_t>(result);
+    }
+    else if (d->socket)
+    {
+        const QHostAddress host(d->host);
+        for (const GroupFlight::PackSlice &slice: d->outSlices)
+        {
+            if (d->socket->writeDatagram(d->outData.data() + slice.offset, static_cast<qint64>(slice.size),
+                                         host, d->portDst) >= 0)
+                sent++;
+        }
+    }
+
+    // Буферы очереди сохраняют емкость для следующего такта
+    d->outData.clear();
+    d->outSlices.clear();
+    return sent;
+}
+
+void DataTransmitter::addListener(GroupFlight::Handler *listener)
 {
     if (!listener) return;
     d->listeners.push_back(listener);
@@ -124,7 +736,7 @@ void DataTransmitter::removeListener(GroupFlight::Handler *listener)
 {
     if (!d->listeners.contains(listener)) return;
     d->listeners.removeOne(listener);
-}*/
+}
 
 uint32_t DataTransmitter::ipFromString(const char *strAddr)
 {
@@ -161,14 +773,73 @@ void DataTransmitter::dataReceived()
 {
     if (!d->socket) return;
 
+    d->arena.reset();
+
+    GroupFlight::Timestamps stamps;
+
     while (d->socket->hasPendingDatagrams())
     {
-        QByteArray data;
-        data.resize(d->socket->pendingDatagramSize());
-        d->socket->readDatagram(data.data(), data.size());
-        qDebug() << d->socket->localAddress();
-        std::vector<char> msg(data.begin(), data.end());
-        /*for (GroupFlight::Handler *listener: qAsConst(d->listeners))
-            listener->setData(msg);*/
+        GroupFlight::PacketBufferPool::Buffer buffer = d->pool.acquire();
+        if (!buffer)
+        {
+            // Все буферы заняты - датаграмма отбрасывается
+            d->socket->readDatagram(nullptr, 0);
+            continue;
+        }
+
+        const qint64 size = d->socket->readDatagram(buffer.data(), static_cast<qint64>(buffer.capacity()));
+        if (size <= 0) continue;
+        buffer.setSize(static_cast<size_t>(size));
+
+        d->datagramsCount.fetch_add(1, std::memory_order_relaxed);
+        d->bytesCount.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+
+        // QUdpSocket не передает отметку ядра: время приема - время чтения
+        stamps.wire = GroupFlight::wallClock();
+
+        // В датаграмме может быть несколько пакетов
+        GroupFlight::PackageView view;
+        size_t shift = 0;
+        while (shift < buffer.size())
+        {
+            if (view.parse(buffer.data(), buffer.size(), shift) != GroupFlight::UnpackStatus::Success) continue;
+
+            stamps.decoded = GroupFlight::wallClock();
+            view.setTimestamps(stamps);
+
+            if (GroupFlight::isFragment(view))
+            {
+                GroupFlight::Package package;
+                if (!d->reassembler.add(view, package)) continue;
+
+                d->packagesCount.fetch_add(1, std::memory_order_relaxed);
+                for (GroupFlight::Handler *listener: qAsConst(d->listeners))
+                {
+                    d->latency.delivered(package.stamps, GroupFlight::wallClock());
+                    listener->setPackage(package);
+                }
+                continue;
+            }
+
+            d->packagesCount.fetch_add(1, std::memory_order_relaxed);
+            d->latency.decoded(stamps);
+
+            for (GroupFlight::Handler *listener: qAsConst(d->listeners))
+            {
+                d->latency.delivered(stamps, GroupFlight::wallClock());
+                listener->setPackageView(view, d->arena);
+            }
+        }
     }
 }
+
+void DataTransmitter::batchReceived()
+{
+    if (d->batchSocket < 0) return;
+
+    DataTransmitterPrivate *data = d;
+    drainSocket(d->batchSocket, d->pool, d->views, [data](int received, uint64_t bytes)
+    {
+        data->deliver(static_cast<size_t>(received), bytes);
+    });
+}
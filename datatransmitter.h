@@ -1,14 +1,20 @@
 #ifndef DATATRANSMITTER_H
 #define DATATRANSMITTER_H
 
+#include <functional>
 #include <vector>
 #include <string>
-//#include "interface.h"
+#include "batchio.h"
+#include "interface.h"
 #include <QVariant>
 
+class IoEngine;
+
 class DataTransmitter
 {
 public:
+    static const size_t k_maxDatagram = 65507;     // Наибольшие данные датаграммы UDP по IPv4
+
     DataTransmitter();
     virtual ~DataTransmitter();
 
@@ -35,14 +41,106 @@ public:
 
     void sendData(const std::vector<char> &data);
 
-    //void addListener(GroupFlight::Handler *listener);
-    //void removeListener(GroupFlight::Handler *listener);
+    //! \brief Пакетный режим (Linux): прием до BatchIo::k_maxBatch датаграмм за системный вызов (recvmmsg)
+    //! и отправка накопленной очереди одним вызовом (sendmmsg). Получатели получают пакеты
+    //! группой через GroupFlight::Handler::setPackageBatch. Переключается до start()
+    //! \return false, если передача запущена или пакетный режим не поддерживается
+    bool setBatchMode(bool state);
+    bool batchMode();
+
+    //! \brief Прием в потоке ввода-вывода engine (epoll) вместо цикла событий Qt; включает пакетный режим
+    //! Получатели (addListener) вызываются в потоке engine, поэтому задаются до start().
+    //! Кроме того, принятые пакеты помещаются в очередь без блокировок, откуда их забирает
+    //! один поток-потребитель через takePackage(). nullptr - прием в цикле событий Qt
+    //! \return false, если передача запущена или поток ввода-вывода не поддерживается
+    bool setIoEngine(IoEngine *engine);
+
+    //! \brief Прием и отправка через io_uring (Linux 6.0+): многократный recv в зарегистрированное
+    //! кольцо буферов, без системного вызова на каждую порцию датаграмм. Включает пакетный режим;
+    //! получатели вызываются в потоке io_uring, принятые пакеты доступны и через takePackage().
+    //! Если ядро не поддерживает io_uring, start() переходит на прием recvmmsg в потоке epoll
+    //! (setIoEngine() или собственный IoEngine). Задается до start()
+    //! \return false, если передача запущена или пакетный режим не поддерживается
+    bool setUringMode(bool state);
+    bool uringMode();
+
+    //! \brief Прием после start() идет через io_uring
+    bool uringActive();
+
+    //! \brief Настройка цепочки обработчиков шарда: вызывается при start() для каждого шарда,
+    //! обработчики затем вызываются в потоке этого шарда
+    using ShardSetup = std::function<void(size_t shard, GroupFlight::Interface &handlers)>;
+
+    //! \brief Шардированный прием (Linux): shards сокетов на одном порту (SO_REUSEPORT), у каждого -
+    //! свой поток ввода-вывода, буферы, арена и цепочка обработчиков, заполняемая setup.
+    //! Датаграммы распределяет между сокетами ядро согласно steering; при SourceAddress все пакеты
+    //! одного борта обрабатываются одним шардом по порядку, при Cpu поток шарда i привязывается
+    //! к процессорам с номером i по модулю shards. Включает пакетный режим; получатели addListener()
+    //! и очередь takePackage() в этом режиме не используются. Только для приема unicast:
+    //! датаграммы multicast ядро копирует во все сокеты порта. Задается до start(); shards = 0 - отключение
+    //! \return false, если передача запущена или пакетный режим не поддерживается
+    bool setShards(size_t shards, BatchIo::Steering steering, ShardSetup setup);
+    size_t shardsCount();
+
+    //! \brief Политика очереди takePackage() для телеметрии, если потребитель не успевает
+    //! (по умолчанию - вытеснение самой старой). Остальные пакеты не вытесняются, но поток ввода-вывода
+    //! не ждет потребителя, поэтому QueuePolicy::Block не поддерживается. Задается до start()
+    //! \return false, если передача запущена или политика не поддерживается
+    bool setQueuePolicy(GroupFlight::QueuePolicy policy);
+    GroupFlight::QueuePolicy queuePolicy();
+
+    //! \brief Очередной принятый пакет (для одного потока-потребителя)
+    //! \return false, если очередь пуста
+    bool takePackage(GroupFlight::Package &package);
+
+    //! \brief Сводка приема для отображения (безопасно читать из любого потока)
+    struct Summary
+    {
+        uint64_t datagrams = 0;     //!< Принято датаграмм
+        uint64_t packages = 0;      //!< Принято пакетов
+        uint64_t bytes = 0;         //!< Принято байт
+        uint64_t dropped = 0;       //!< Пакетов не поместилось в очередь takePackage() или вытеснено из нее
+        uint64_t coalesced = 0;     //!< Пакетов телеметрии заменено в очереди более новыми того же борта
+    };
+
+    //! \brief Сводка по всем шардам или по шарду shard (при шардированном приеме)
+    Summary summary();
+    Summary summary(size_t shard);
+
+    //! \brief Задержки принятых пакетов: от приема ядром (SO_TIMESTAMPNS в пакетном режиме; при приеме
+    //! через QUdpSocket и io_uring - от чтения) до разбора, до вызова каждого получателя (addListener,
+    //! обработчики шардов) и, отдельно, до выдачи takePackage() или асинхронному обработчику.
+    //! Отметки времени передаются вместе с пакетами (GroupFlight::PackageView::timestamps(), GroupFlight::Package::stamps)
+    GroupFlight::LatencyTracker::Snapshot latency();
+    void resetLatency();
+
+    //! \brief Постановка в очередь отправки; очередь отправляется вызовом flush()
+    //! Пакет больше maxDatagramSize() разбивается на фрагменты (GroupFlight::fragment), каждый -
+    //! в своей датаграмме; принятые фрагменты собираются обратно и передаются получателям целым пакетом
+    bool queuePackage(const GroupFlight::Package &package);
+    void queueData(const std::vector<char> &data);
+
+    //! \brief Наибольший размер отправляемой датаграммы (от GroupFlight::k_minFragmentSize до k_maxDatagram);
+    //! меньший размер позволяет обойтись без фрагментации IP на каналах с малым MTU
+    void setMaxDatagramSize(size_t size);
+    size_t maxDatagramSize();
+
+    //! \brief Отправка очереди (в пакетном режиме - одним системным вызовом на BatchIo::k_maxBatch датаграмм)
+    //! \return количество отправленных датаграмм
+    size_t flush();
+
+    //! \brief Получатели принятых пакетов (GroupFlight::Handler::setPackageView)
+    //! Пакеты передаются без копирования, из буфера приема
+    void addListener(GroupFlight::Handler *listener);
+    void removeListener(GroupFlight::Handler *listener);
 
     static uint32_t ipFromString(const char* strAddr);
     static std::string ipFromUint32(uint32_t addr);
 
 private:
     void dataReceived();
+    void batchReceived();
+    bool startShards();
 
     struct DataTransmitterPrivate;
     DataTransmitterPrivate * const d;
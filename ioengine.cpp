@@ -0,0 +1,195 @@
+#include "ioengine.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#endif
+
+IoEngine::IoEngine()
+{
+#ifdef __linux__
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (epollFd >= 0 && wakeFd >= 0)
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = wakeFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    }
+#endif
+}
+
+IoEngine::~IoEngine()
+{
+    stop();
+
+#ifdef __linux__
+    if (wakeFd >= 0) close(wakeFd);
+    if (epollFd >= 0) close(epollFd);
+#endif
+}
+
+bool IoEngine::start()
+{
+#ifdef __linux__
+    if (isRunning()) return true;
+    if (epollFd < 0 || wakeFd < 0) return false;
+
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&IoEngine::run, this);
+    applyAffinity();
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool IoEngine::setAffinity(const std::vector<int> &cpus)
+{
+    affinity = cpus;
+    return isRunning() ? applyAffinity() : true;
+}
+
+bool IoEngine::applyAffinity()
+{
+#ifdef __linux__
+    if (affinity.empty() || !thread.joinable()) return true;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu: affinity)
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+void IoEngine::stop()
+{
+#ifdef __linux__
+    if (!isRunning()) return;
+
+    running.store(false, std::memory_order_release);
+
+    const uint64_t value = 1;
+    if (write(wakeFd, &value, sizeof(value)) < 0) {}
+
+    if (thread.joinable()) thread.join();
+#endif
+}
+
+bool IoEngine::addReader(int socket, Callback callback)
+{
+#ifdef __linux__
+    if (epollFd < 0 || socket < 0 || !callback) return false;
+
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = socket;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) < 0) return false;
+
+    readers[socket] = Reader{std::move(callback), true};
+    return true;
+#else
+    (void)socket;
+    (void)callback;
+    return false;
+#endif
+}
+
+bool IoEngine::watchWrite(int socket, bool state)
+{
+#ifdef __linux__
+    if (epollFd < 0 || socket < 0) return false;
+
+    epoll_event event = {};
+    event.events = state ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.fd = socket;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, socket, &event) == 0;
+#else
+    (void)socket;
+    (void)state;
+    return false;
+#endif
+}
+
+void IoEngine::removeReader(int socket)
+{
+#ifdef __linux__
+    if (epollFd < 0 || socket < 0) return;
+
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+
+    // Ожидание завершения обработчиков, уже вызванных потоком движка
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    auto reader = readers.find(socket);
+    if (reader == readers.end()) return;
+
+    if (dispatching)
+    {
+        reader->second.active = false;
+        removed = true;
+    }
+    else
+        readers.erase(reader);
+#else
+    (void)socket;
+#endif
+}
+
+void IoEngine::run()
+{
+#ifdef __linux__
+    static const int k_maxEvents = 32;
+    epoll_event events[k_maxEvents];
+
+    while (isRunning())
+    {
+        const int count = epoll_wait(epollFd, events, k_maxEvents, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        dispatching = true;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].data.fd == wakeFd)
+            {
+                uint64_t value = 0;
+                if (read(wakeFd, &value, sizeof(value)) < 0) {}
+                continue;
+            }
+
+            // Сокет мог быть отключен, пока ожидались события
+            auto reader = readers.find(events[i].data.fd);
+            if (reader != readers.end() && reader->second.active) reader->second.callback();
+        }
+
+        dispatching = false;
+        if (!removed) continue;
+
+        removed = false;
+        for (auto reader = readers.begin(); reader != readers.end(); )
+        {
+            if (reader->second.active) ++reader;
+            else reader = readers.erase(reader);
+        }
+    }
+#endif
+}
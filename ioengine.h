@@ -0,0 +1,71 @@
+#ifndef IOENGINE_H
+#define IOENGINE_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+//! \brief Поток ввода-вывода на epoll (Linux)
+//! Сокеты обслуживаются в собственном потоке, независимо от цикла событий Qt:
+//! обработчик готовности сокета вызывается в потоке движка. На других системах start() возвращает false
+class IoEngine
+{
+public:
+    using Callback = std::function<void()>;
+
+    IoEngine();
+    ~IoEngine();
+
+    IoEngine(const IoEngine &) = delete;
+    IoEngine &operator=(const IoEngine &) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    //! \brief Привязка потока движка к процессорам cpus (пустой список - без привязки)
+    //! Действует с ближайшего start() или сразу, если движок запущен
+    bool setAffinity(const std::vector<int> &cpus);
+
+    //! \brief Ожидание готовности сокета к чтению; callback вызывается в потоке движка
+    bool addReader(int socket, Callback callback);
+
+    //! \brief Ожидание готовности сокета к записи в дополнение к чтению: callback зарегистрированного
+    //! сокета вызывается и тогда, когда в буфере отправки освободилось место. Включается на время,
+    //! пока у вызывающего есть неотправленные данные, иначе движок будился бы постоянно
+    bool watchWrite(int socket, bool state);
+
+    //! \brief Отключение сокета; после возврата callback больше не вызывается
+    //! Может вызываться и из самого callback
+    void removeReader(int socket);
+
+    //! \brief Вызов выполняется в потоке движка
+    bool isIoThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+private:
+    void run();
+    bool applyAffinity();
+
+    int epollFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::vector<int> affinity;
+
+    // Удерживается потоком движка на время вызова обработчиков
+    struct Reader
+    {
+        Callback callback;
+        bool active;
+    };
+
+    std::recursive_mutex mutex;
+    std::unordered_map<int, Reader> readers;
+    bool dispatching = false;   // Обработчики вызываются: удаление откладывается до конца вызова
+    bool removed = false;       // Есть отложенные удаления
+};
+
+#endif // IOENGINE_H
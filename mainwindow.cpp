@@ -7,25 +7,41 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
     QString tempIP = getHostIP();
+    ioThread = new QThread(this);
+
+    // Транслятор UDP и сеансы связи с автопилотами работают в ioThread, подключение - после запуска потока
     td = new TcpUdpTranslator;
+    td->setIPAddress(ProtocolType::UDP, DirectionType::Host, tempIP);
+    td->setPort(ProtocolType::UDP, DirectionType::Host, 7072);
+    td->setPort(ProtocolType::UDP, DirectionType::Client, 5026);
 
-    td->setIPAddress(ProtocolType::TCP, DirectionType::Blank, "127.0.0.1");
-    td->setPort(ProtocolType::TCP, DirectionType::Blank, 10003);
-    td->connectToServer(ProtocolType::TCP);
+    // Автопилоты бортов: одно соединение TCP на борт, все - в одном цикле событий
+    AutopilotConfig local;
+    local.name = "local";
+    local.host = "127.0.0.1";
+    local.port = 10003;
 
-    td_1 = new TcpUdpTranslator;
+    AutopilotConfig board;
+    board.name = "board";
+    board.host = "192.168.77.82";
+    board.port = 7071;
 
-    td_1->setIPAddress(ProtocolType::TCP, DirectionType::Blank, "192.168.77.82");
-    td_1->setPort(ProtocolType::TCP, DirectionType::Blank, 7071);
-    td_1->connectToServer(ProtocolType::TCP);
+    autopilots = new ConnectionManager;
+    autopilots->setSessions({local, board});
 
-    td->setIPAddress(ProtocolType::UDP, DirectionType::Host, tempIP);
-    td->setPort(ProtocolType::UDP, DirectionType::Host, 7072);
-    td->setPort(ProtocolType::UDP, DirectionType::Client, 5026);
-    td->connectToServer(ProtocolType::UDP);
+    td->moveToThread(ioThread);
+    autopilots->moveToThread(ioThread);
 
-    connect(td, SIGNAL(tcpReceived()), this, SLOT(showTcpMessage()));
-    connect(td, SIGNAL(udpReceived()), this, SLOT(showUdpMessage()));
+    connect(ioThread, &QThread::started, td, [=]{ td->connectToServer(ProtocolType::UDP); });
+    connect(ioThread, &QThread::started, autopilots, [=]{ autopilots->start(); });
+    connect(ioThread, &QThread::finished, td, &QObject::deleteLater);
+    connect(ioThread, &QThread::finished, autopilots, &QObject::deleteLater);
+
+    connect(autopilots, &ConnectionManager::tcpReceived, this,
+            [=](int session, const QByteArray &data){ if (session == 0) showTcpMessage(data); });
+    connect(td, &TcpUdpTranslator::udpDatagramsReady, this, &MainWindow::takeUdpDatagrams);
+
+    ioThread->start();
 }
 
 /**************************************** Service Functions ****************************************/
@@ -66,16 +82,20 @@ QString MainWindow::getHostIP()
 
 void MainWindow::on_tcpSendButton_clicked()
 {
-    td->write(ProtocolType::TCP, td->sendTelemetryRequest());
-    td->write(ProtocolType::UDP, ui->udpDataLineEdit->text().toUtf8());
+    const QByteArray data = ui->udpDataLineEdit->text().toUtf8();
+    QMetaObject::invokeMethod(autopilots, [=]{ autopilots->write(0, td->sendTelemetryRequest()); });
+    QMetaObject::invokeMethod(td, [=]{ td->write(ProtocolType::UDP, data); });
 }
 
 void MainWindow::on_setSocketButton_clicked()
 {
     QString str = ui->ip4LineEdit_3->text() + '.' + ui->ip4LineEdit_2->text() + '.' + ui->ip4LineEdit_1->text() + '.' + ui->ip4LineEdit_0->text();
-    td->setPort(ProtocolType::UDP, DirectionType::Client, ui->udpPortLineEdit->text().toUInt());
-    td->setIPAddress(ProtocolType::UDP, DirectionType::Host, str);
-    //td->connectToServer(ProtocolType::UDP);
+    const uint port = ui->udpPortLineEdit->text().toUInt();
+    QMetaObject::invokeMethod(td, [=]{
+        td->setPort(ProtocolType::UDP, DirectionType::Client, port);
+        td->setIPAddress(ProtocolType::UDP, DirectionType::Host, str);
+        //td->connectToServer(ProtocolType::UDP);
+    });
 }
 
 void MainWindow::slotReadyRead()
@@ -86,32 +106,38 @@ void MainWindow::slotReadyRead()
 void MainWindow::slotConnected()
 {
     qDebug() << "Received the connected() signal";
-    td->write(ProtocolType::TCP, td->sendTelemetryRequest());
+    on_tryTelemetry_clicked();
+}
+
+void MainWindow::showTcpMessage(const QByteArray &data)
+{
+    ui->tcpDataLabel->setText(data);
 }
 
-void MainWindow::showTcpMessage()
+void MainWindow::showUdpMessage(const QByteArray &data)
 {
-    QByteArray tempBa;
-    tempBa.clear();
-    ui->tcpDataLabel->setText(td->ByteData());
-    td->setByteData(tempBa);
+    ui->udpDataLabel->setText(data);
 }
 
-void MainWindow::showUdpMessage()
+void MainWindow::takeUdpDatagrams()
 {
-    QByteArray tempBa;
-    tempBa.clear();
-    ui->udpDataLabel->setText(td->ByteData());
-    td->setByteData(tempBa);
+    // Очередь транслятора потокобезопасна: забирается все, что накопилось, показывается последняя
+    udpBatch.clear();
+    if (td->takeDatagrams(udpBatch) == 0) return;
+
+    const Datagram &last = udpBatch.back();
+    showUdpMessage(QByteArray(last.data.data(), static_cast<int>(last.data.size())));
 }
 
 void MainWindow::on_tryTelemetry_clicked()
 {
-    td->write(ProtocolType::TCP, td->sendTelemetryRequest());
+    QMetaObject::invokeMethod(autopilots, [=]{ autopilots->write(0, td->sendTelemetryRequest()); });
 }
 
 MainWindow::~MainWindow()
 {
+    ioThread->quit();
+    ioThread->wait();
     delete ui;
 }
 
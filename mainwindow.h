@@ -7,6 +7,7 @@
 #include <QtSerialPort/QSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 #include <QFile>
+#include <QThread>
 #include <QTimer>
 #include <QByteArray>
 #include <QDebug>
@@ -22,6 +23,7 @@
 #include <QDataStream>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include "connectionmanager.h"
 #include "tcpudptranslator.h"
 #include "datatransmitter.h"
 
@@ -47,10 +49,12 @@ public:
 private:
     Ui::MainWindow *ui;
 
-    TcpUdpTranslator        *td;
-    TcpUdpTranslator        *td_1;
+    QThread                 *ioThread;      // Поток трансляторов: сокеты не зависят от перерисовки окна
+    TcpUdpTranslator        *td;            // Обмен UDP
+    ConnectionManager       *autopilots;    // Соединения с автопилотами бортов
     DataTransmitter         *ud;
     QByteArray              ba;
+    std::vector<Datagram>   udpBatch;       // Датаграммы, забранные у td за раз
     QTcpSocket              *tcpSocket;
     QTcpServer              *tcpServer;
     QUdpSocket              *udpSocket;
@@ -69,8 +73,9 @@ private slots:
     void on_setSocketButton_clicked();
     void slotReadyRead();
     void slotConnected();
-    void showTcpMessage();
-    void showUdpMessage();
+    void showTcpMessage(const QByteArray &data);
+    void showUdpMessage(const QByteArray &data);
+    void takeUdpDatagrams();
     void on_tryTelemetry_clicked();
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,575 @@
+#include "msgpackstream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include "coords.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MSGPACKSTREAM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace AutopilotMsgPack
+{
+
+namespace
+{
+    //! Целое в порядке байт msgpack (big-endian)
+    uint64_t load(const char *data, size_t size)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < size; i++)
+            value = (value << 8) | static_cast<uint8_t>(data[i]);
+        return value;
+    }
+
+    //! 8 байт в порядке big-endian: одно чтение вместо побайтного цикла
+    inline uint64_t load64(const char *data)
+    {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return __builtin_bswap64(value);
+#else
+        return load(data, 8);
+#endif
+    }
+
+    //! \brief Строение значения: размер заголовка, размер данных после заголовка
+    //! и количество вложенных значений (элементов массива, ключей и значений словаря)
+    Status layout(const char *data, size_t size, size_t &header, uint64_t &payload, uint64_t &children)
+    {
+        if (size == 0) return Status::NeedMore;
+
+        const uint8_t type = static_cast<uint8_t>(data[0]);
+        header = 1;
+        payload = 0;
+        children = 0;
+
+        if (type <= 0x7f || type >= 0xe0) return Status::Ok;                            // fixint
+        if ((type & 0xf0) == 0x80) { children = 2 * (type & 0x0f); return Status::Ok; } // fixmap
+        if ((type & 0xf0) == 0x90) { children = type & 0x0f; return Status::Ok; }       // fixarray
+        if ((type & 0xe0) == 0xa0) { payload = type & 0x1f; return Status::Ok; }        // fixstr
+
+        size_t lengthSize = 0;
+        uint64_t extra = 0;     // Байт после длины, не входящих в нее (тип ext)
+        bool array = false;
+        bool map = false;
+
+        switch (type)
+        {
+        case 0xc0: case 0xc2: case 0xc3: return Status::Ok;                 // nil, false, true
+        case 0xcc: case 0xd0: payload = 1; return Status::Ok;
+        case 0xcd: case 0xd1: payload = 2; return Status::Ok;
+        case 0xca: case 0xce: case 0xd2: payload = 4; return Status::Ok;
+        case 0xcb: case 0xcf: case 0xd3: payload = 8; return Status::Ok;
+        case 0xd4: payload = 2; return Status::Ok;                          // fixext
+        case 0xd5: payload = 3; return Status::Ok;
+        case 0xd6: payload = 5; return Status::Ok;
+        case 0xd7: payload = 9; return Status::Ok;
+        case 0xd8: payload = 17; return Status::Ok;
+        case 0xc4: case 0xd9: lengthSize = 1; break;                        // bin, str
+        case 0xc5: case 0xda: lengthSize = 2; break;
+        case 0xc6: case 0xdb: lengthSize = 4; break;
+        case 0xc7: lengthSize = 1; extra = 1; break;                        // ext
+        case 0xc8: lengthSize = 2; extra = 1; break;
+        case 0xc9: lengthSize = 4; extra = 1; break;
+        case 0xdc: lengthSize = 2; array = true; break;
+        case 0xdd: lengthSize = 4; array = true; break;
+        case 0xde: lengthSize = 2; map = true; break;
+        case 0xdf: lengthSize = 4; map = true; break;
+        default: return Status::Error;                                      // 0xc1 не используется
+        }
+
+        if (size < 1 + lengthSize) return Status::NeedMore;
+
+        header = 1 + lengthSize;
+        const uint64_t length = load(data + 1, lengthSize);
+
+        if (array) children = length;
+        else if (map) children = 2 * length;
+        else payload = length + extra;
+
+        return Status::Ok;
+    }
+
+    template<size_t N>
+    bool is(const char *key, uint32_t size, const char (&name)[N])
+    {
+        return size == N - 1 && memcmp(key, name, N - 1) == 0;
+    }
+
+    //! \brief Перевод широты и долготы точек маршрута из градусов в радианы
+    //! Широта и долгота лежат в Coords рядом, поэтому пара переводится одним умножением SSE2
+    void degreesToRadians(std::vector<GroupFlight::FlightPoint> &route)
+    {
+        static_assert(offsetof(GroupFlight::Coords, lon) == offsetof(GroupFlight::Coords, lat) + sizeof(double),
+                      "Coords::lat and Coords::lon must be adjacent");
+
+#ifdef MSGPACKSTREAM_SSE2
+        const __m128d factor = _mm_set1_pd(GroupFlight::kDegree);
+        for (GroupFlight::FlightPoint &point: route)
+        {
+            double *pair = &point.point.lat;
+            _mm_storeu_pd(pair, _mm_mul_pd(_mm_loadu_pd(pair), factor));
+        }
+#else
+        for (GroupFlight::FlightPoint &point: route)
+        {
+            point.point.lat *= GroupFlight::kDegree;
+            point.point.lon *= GroupFlight::kDegree;
+        }
+#endif
+    }
+
+    //! Точка маршрута: словарь lat, lon, alt
+    Status decodePoint(Reader &reader, double &lat, double &lon, double &alt)
+    {
+        uint32_t count = 0;
+        Status status = reader.mapHeader(count);
+        if (status != Status::Ok) return status;
+
+        lat = 0;
+        lon = 0;
+        alt = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const char *key = nullptr;
+            uint32_t keySize = 0;
+            status = reader.string(key, keySize);
+            if (status != Status::Ok) return status;
+
+            double *target = nullptr;
+            switch (keyHash(key, keySize))
+            {
+            case keyHash("lat"): if (is(key, keySize, "lat")) target = &lat; break;
+            case keyHash("lon"): if (is(key, keySize, "lon")) target = &lon; break;
+            case keyHash("alt"): if (is(key, keySize, "alt")) target = &alt; break;
+            default: break;
+            }
+
+            status = target ? reader.number(*target) : reader.skip();
+            if (status != Status::Ok) return status;
+        }
+
+        return Status::Ok;
+    }
+}
+
+uint32_t keyHash(const char *data, size_t size)
+{
+    uint32_t hash = k_fnvBasis;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * k_fnvPrime;
+    return hash;
+}
+
+Status Reader::mapHeader(uint32_t &count)
+{
+    const uint8_t type = position < end ? static_cast<uint8_t>(*position) : 0;
+    if (position < end && (type & 0xf0) != 0x80 && type != 0xde && type != 0xdf) return Status::Error;
+
+    size_t header = 0;
+    uint64_t payload = 0;
+    uint64_t children = 0;
+    const Status status = layout(position, static_cast<size_t>(end - position), header, payload, children);
+    if (status != Status::Ok) return status;
+
+    count = static_cast<uint32_t>(children / 2);
+    position += header;
+    return Status::Ok;
+}
+
+Status Reader::arrayHeader(uint32_t &count)
+{
+    const uint8_t type = position < end ? static_cast<uint8_t>(*position) : 0;
+    if (position < end && (type & 0xf0) != 0x90 && type != 0xdc && type != 0xdd) return Status::Error;
+
+    size_t header = 0;
+    uint64_t payload = 0;
+    uint64_t children = 0;
+    const Status status = layout(position, static_cast<size_t>(end - position), header, payload, children);
+    if (status != Status::Ok) return status;
+
+    count = static_cast<uint32_t>(children);
+    position += header;
+    return Status::Ok;
+}
+
+Status Reader::string(const char *&data, uint32_t &size)
+{
+    const uint8_t type = position < end ? static_cast<uint8_t>(*position) : 0;
+
+    // Ключи - короткие строки fixstr
+    if ((type & 0xe0) == 0xa0)
+    {
+        const uint32_t length = type & 0x1f;
+        if (static_cast<size_t>(end - position) < 1 + length) return Status::NeedMore;
+
+        data = position + 1;
+        size = length;
+        position += 1 + length;
+        return Status::Ok;
+    }
+
+    if (position < end && (type & 0xe0) != 0xa0 && (type < 0xd9 || type > 0xdb) && (type < 0xc4 || type > 0xc6))
+        return Status::Error;
+
+    size_t header = 0;
+    uint64_t payload = 0;
+    uint64_t children = 0;
+    const Status status = layout(position, static_cast<size_t>(end - position), header, payload, children);
+    if (status != Status::Ok) return status;
+    if (payload > static_cast<uint64_t>(end - position) - header) return Status::NeedMore;
+
+    data = position + header;
+    size = static_cast<uint32_t>(payload);
+    position += header + payload;
+    return Status::Ok;
+}
+
+Status Reader::number(double &value)
+{
+    if (position == end) return Status::NeedMore;
+
+    const uint8_t type = static_cast<uint8_t>(*position);
+    if (type <= 0x7f || type >= 0xe0)
+    {
+        value = static_cast<int8_t>(type);
+        position++;
+        return Status::Ok;
+    }
+
+    size_t size = 0;
+    switch (type)
+    {
+    case 0xcc: case 0xd0: size = 1; break;
+    case 0xcd: case 0xd1: size = 2; break;
+    case 0xca: case 0xce: case 0xd2: size = 4; break;
+    case 0xcb: case 0xcf: case 0xd3: size = 8; break;
+    default: return Status::Error;
+    }
+
+    if (static_cast<size_t>(end - position) < 1 + size) return Status::NeedMore;
+
+    const uint64_t bits = size == 8 ? load64(position + 1) : load(position + 1, size);
+    switch (type)
+    {
+    case 0xca:
+    {
+        const uint32_t single = static_cast<uint32_t>(bits);
+        float result;
+        memcpy(&result, &single, sizeof(result));
+        value = result;
+        break;
+    }
+    case 0xcb:
+        memcpy(&value, &bits, sizeof(value));
+        break;
+    case 0xd0: value = static_cast<int8_t>(bits); break;
+    case 0xd1: value = static_cast<int16_t>(bits); break;
+    case 0xd2: value = static_cast<int32_t>(bits); break;
+    case 0xd3: value = static_cast<double>(static_cast<int64_t>(bits)); break;
+    default: value = static_cast<double>(bits); break;
+    }
+
+    position += 1 + size;
+    return Status::Ok;
+}
+
+Status Reader::skip()
+{
+    const char *current = position;
+    uint64_t remaining = 1;
+
+    while (remaining > 0)
+    {
+        size_t header = 0;
+        uint64_t payload = 0;
+        uint64_t children = 0;
+        const Status status = layout(current, static_cast<size_t>(end - current), header, payload, children);
+        if (status != Status::Ok) return status;
+        if (payload > static_cast<uint64_t>(end - current) - header) return Status::NeedMore;
+
+        current += header + payload;
+        remaining += children - 1;
+    }
+
+    position = current;
+    return Status::Ok;
+}
+
+Status Framer::next(const char *data, size_t size, size_t &length)
+{
+    if (remaining == 0)
+    {
+        // После ошибки отдельный байт (fixint, nil) не считается сообщением: поиск ведется
+        // до непустого словаря или массива, иначе мусор выходит однобайтовыми сообщениями
+        if (resync && size > 0)
+        {
+            const uint8_t type = static_cast<uint8_t>(data[0]);
+            const bool container = ((type & 0xf0) == 0x80 || (type & 0xf0) == 0x90) ? (type & 0x0f) != 0
+                                 : type >= 0xdc && type <= 0xdf;
+            if (!container) return Status::Error;
+        }
+
+        scan = 0;
+        remaining = 1;
+    }
+
+    while (remaining > 0)
+    {
+        size_t header = 0;
+        uint64_t payload = 0;
+        uint64_t children = 0;
+        const Status status = layout(data + scan, size - scan, header, payload, children);
+        if (status == Status::NeedMore) return status;
+
+        if (status == Status::Error || scan + header + payload > k_maxMessageSize)
+        {
+            reset();
+            resync = true;
+            return Status::Error;
+        }
+
+        if (payload > size - scan - header) return Status::NeedMore;
+
+        scan += header + payload;
+        remaining += children - 1;
+    }
+
+    length = scan;
+    scan = 0;
+    resync = false;
+    return Status::Ok;
+}
+
+void Stream::append(const char *data, size_t size)
+{
+    // Разобранные сообщения больше не нужны: буфер сдвигается к незаконченному
+    if (start > 0)
+    {
+        buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(start));
+        start = 0;
+    }
+
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+bool Stream::next(const char *&data, size_t &size)
+{
+    while (start < buffer.size())
+    {
+        size_t length = 0;
+        const Status status = framer.next(buffer.data() + start, buffer.size() - start, length);
+        if (status == Status::NeedMore) return false;
+
+        if (status == Status::Error)
+        {
+            start++;
+            skippedCount++;
+            continue;
+        }
+
+        data = buffer.data() + start;
+        size = length;
+        start += length;
+        return true;
+    }
+
+    return false;
+}
+
+void Stream::clear()
+{
+    buffer.clear();
+    start = 0;
+    framer.reset();
+}
+
+Content classify(const char *data, size_t size)
+{
+    Reader reader(data, size);
+
+    uint32_t count = 0;
+    if (reader.mapHeader(count) != Status::Ok) return Content::Other;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const char *key = nullptr;
+        uint32_t keySize = 0;
+        if (reader.string(key, keySize) != Status::Ok) return Content::Other;
+
+        switch (keyHash(key, keySize))
+        {
+        case keyHash("latitude"):
+            if (is(key, keySize, "latitude")) return Content::Telemetry;
+            break;
+        case keyHash("longitude"):
+            if (is(key, keySize, "longitude")) return Content::Telemetry;
+            break;
+        case keyHash("points"):
+            if (is(key, keySize, "points")) return Content::Route;
+            break;
+        case keyHash("count"):
+            if (is(key, keySize, "count")) return Content::Route;
+            break;
+        default:
+            break;
+        }
+
+        if (reader.skip() != Status::Ok) return Content::Other;
+    }
+
+    return Content::Other;
+}
+
+bool decodeTelemetry(const char *data, size_t size, GroupFlight::Telemetry &telemetry)
+{
+    Reader reader(data, size);
+
+    uint32_t count = 0;
+    if (reader.mapHeader(count) != Status::Ok) return false;
+
+    GroupFlight::Telemetry result = telemetry;
+    result.pitch = 0;
+    result.roll = 0;
+    result.course = 0;
+    result.speed = 0;
+
+    static const unsigned k_coords = 7;     // Найдены широта, долгота и высота
+    unsigned found = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const char *key = nullptr;
+        uint32_t keySize = 0;
+        const Status keyStatus = reader.string(key, keySize);
+        if (keyStatus == Status::NeedMore) return false;
+        if (keyStatus == Status::Error)
+        {
+            if (reader.skip() != Status::Ok || reader.skip() != Status::Ok) return false;
+            continue;
+        }
+
+        double value = 0;
+        Status status = reader.number(value);
+        if (status == Status::NeedMore) return false;
+        if (status == Status::Error)
+        {
+            // Значение не число: ключ не учитывается
+            if (reader.skip() != Status::Ok) return false;
+            continue;
+        }
+
+        switch (keyHash(key, keySize))
+        {
+        case keyHash("latitude"):
+            if (is(key, keySize, "latitude")) { result.lat = value; found |= 1; }
+            break;
+        case keyHash("longitude"):
+            if (is(key, keySize, "longitude")) { result.lon = value; found |= 2; }
+            break;
+        case keyHash("altitude"):
+            if (is(key, keySize, "altitude")) { result.alt = static_cast<float>(value); found |= 4; }
+            break;
+        case keyHash("pitch"):
+            if (is(key, keySize, "pitch")) result.pitch = GroupFlight::radToDeg(static_cast<float>(value));
+            break;
+        case keyHash("roll"):
+            if (is(key, keySize, "roll")) result.roll = GroupFlight::radToDeg(static_cast<float>(value));
+            break;
+        case keyHash("azimuth"):
+            if (is(key, keySize, "azimuth")) result.course = GroupFlight::radToDeg(static_cast<float>(value));
+            break;
+        case keyHash("speed"):
+            if (is(key, keySize, "speed")) result.speed = static_cast<float>(value);
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (found != k_coords) return false;
+
+    telemetry = result;
+    return true;
+}
+
+bool decodeRoute(const char *data, size_t size, std::vector<GroupFlight::FlightPoint> &route, uint32_t &current)
+{
+    Reader reader(data, size);
+
+    uint32_t count = 0;
+    if (reader.mapHeader(count) != Status::Ok) return false;
+
+    static const unsigned k_required = 7;   // Найдены count, current и points
+    unsigned found = 0;
+    double total = 0;
+    double currentPoint = 0;
+
+    route.clear();
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const char *key = nullptr;
+        uint32_t keySize = 0;
+        if (reader.string(key, keySize) != Status::Ok) return false;
+
+        Status status = Status::Ok;
+        switch (keyHash(key, keySize))
+        {
+        case keyHash("count"):
+            if (!is(key, keySize, "count")) { status = reader.skip(); break; }
+            status = reader.number(total);
+            found |= 1;
+            break;
+        case keyHash("current"):
+            if (!is(key, keySize, "current")) { status = reader.skip(); break; }
+            status = reader.number(currentPoint);
+            found |= 2;
+            break;
+        case keyHash("points"):
+        {
+            if (!is(key, keySize, "points")) { status = reader.skip(); break; }
+
+            uint32_t points = 0;
+            status = reader.arrayHeader(points);
+            if (status != Status::Ok) break;
+
+            // Каждая точка занимает не меньше байта: заголовок не заставит резервировать лишнее
+            route.reserve(std::min<size_t>(points, size - reader.offset()));
+
+            for (uint32_t index = 0; index < points && status == Status::Ok; index++)
+            {
+                double lat = 0;
+                double lon = 0;
+                double alt = 0;
+                status = decodePoint(reader, lat, lon, alt);
+                if (status == Status::Ok)
+                    route.push_back(GroupFlight::FlightPoint(static_cast<uint16_t>(index), lat, lon, static_cast<float>(alt)));
+            }
+            found |= 4;
+            break;
+        }
+        default:
+            status = reader.skip();
+            break;
+        }
+
+        if (status != Status::Ok) return false;
+    }
+
+    if (found != k_required || total < 0 || currentPoint < 0 || currentPoint > UINT32_MAX) return false;
+
+    if (total + 1 < route.size()) route.erase(route.begin() + static_cast<std::ptrdiff_t>(total) + 1, route.end());
+    degreesToRadians(route);
+
+    current = static_cast<uint32_t>(currentPoint);
+    return true;
+}
+
+} // namespace AutopilotMsgPack
@@ -0,0 +1,145 @@
+#ifndef MSGPACKSTREAM_H
+#define MSGPACKSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "protocol.h"
+
+//! Разбор сообщений msgpack автопилота прямо в структуры GroupFlight, без дерева QVariant
+namespace AutopilotMsgPack
+{
+    //! Результат разбора
+    enum class Status
+    {
+        Ok,         //!< Значение разобрано
+        NeedMore,   //!< Данные закончились раньше значения
+        Error       //!< Данные не msgpack или не того типа
+    };
+
+    //! Наибольший размер сообщения; длинные сообщения считаются ошибкой потока
+    static const size_t k_maxMessageSize = 16 * 1024 * 1024;
+
+    static const uint32_t k_fnvBasis = 2166136261u;
+    static const uint32_t k_fnvPrime = 16777619u;
+
+    constexpr uint32_t keyHashStep(const char *key, uint32_t hash)
+    {
+        return *key ? keyHashStep(key + 1, (hash ^ static_cast<uint8_t>(*key)) * k_fnvPrime) : hash;
+    }
+
+    //! \brief Хеш FNV-1a ключа; для строковых констант вычисляется при компиляции
+    constexpr uint32_t keyHash(const char *key) { return keyHashStep(key, k_fnvBasis); }
+
+    //! \brief Хеш FNV-1a ключа из сообщения (строка без завершающего нуля)
+    uint32_t keyHash(const char *data, size_t size);
+
+    //! \brief Последовательное чтение значений msgpack из буфера
+    //! При ошибке или нехватке данных положение не меняется
+    class Reader
+    {
+    public:
+        Reader(const char *data, size_t size): begin(data), position(data), end(data + size){}
+
+        Status mapHeader(uint32_t &count);
+        Status arrayHeader(uint32_t &count);
+
+        //! \brief Строка (str или bin); data указывает внутрь буфера
+        Status string(const char *&data, uint32_t &size);
+
+        //! \brief Число любого типа msgpack (целое, float, double)
+        Status number(double &value);
+
+        //! \brief Пропуск значения вместе с вложенными
+        Status skip();
+
+        size_t offset() const { return static_cast<size_t>(position - begin); }
+        bool atEnd() const { return position == end; }
+
+    private:
+        const char *begin;
+        const char *position;
+        const char *end;
+    };
+
+    //! \brief Поиск конца сообщения msgpack верхнего уровня в буфере вызывающего
+    //! Разбор незаконченного сообщения продолжается с места остановки: при следующем вызове
+    //! передается то же сообщение (начало может быть перенесено в другой буфер) с новыми данными
+    class Framer
+    {
+    public:
+        //! \brief Длина сообщения, начинающегося с data
+        //! \return Ok - length задана; NeedMore - сообщение не закончено; Error - данные не msgpack
+        //! или сообщение длиннее k_maxMessageSize (состояние сбрасывается). До следующего Ok
+        //! сообщением считается только непустой словарь или массив, остальное - тоже Error
+        Status next(const char *data, size_t size, size_t &length);
+
+        //! \brief Байт незаконченного сообщения, уже разобранных
+        size_t scanned() const { return scan; }
+
+        void reset() { scan = 0; remaining = 0; resync = false; }
+
+    private:
+        size_t scan = 0;            // Конец разобранной части незаконченного сообщения
+        uint64_t remaining = 0;     // Значений незаконченного сообщения, которые еще не разобраны
+        bool resync = false;        // Поток поврежден: ищется начало словаря или массива
+    };
+
+    //! \brief Выделение целых сообщений msgpack из потока TCP
+    //! Порции потока дописываются append(); next() возвращает очередное целое сообщение верхнего
+    //! уровня. Разбор незаконченного сообщения продолжается с места остановки при следующей порции,
+    //! а не с начала. Если поток поврежден, сообщение ищется со следующего байта, и до первого целого
+    //! сообщения принимаются только словари и массивы
+    class Stream
+    {
+    public:
+        //! \brief Добавление порции; сообщения, полученные next(), после вызова недействительны
+        void append(const char *data, size_t size);
+
+        //! \brief Очередное целое сообщение; data указывает во внутренний буфер
+        //! \return false, если целых сообщений больше нет
+        bool next(const char *&data, size_t &size);
+
+        //! \brief Байт незаконченного сообщения
+        size_t pending() const { return buffer.size() - start; }
+
+        //! \brief Байт, пропущенных из-за поврежденных данных
+        uint64_t skipped() const { return skippedCount; }
+
+        void clear();
+
+    private:
+        std::vector<char> buffer;
+        size_t start = 0;           // Начало незаконченного сообщения
+        Framer framer;
+        uint64_t skippedCount = 0;
+    };
+
+    //! Вид сообщения автопилота по ключам словаря верхнего уровня
+    enum class Content
+    {
+        Other,      //!< Прочие сообщения (Supervisor)
+        Telemetry,  //!< Есть latitude или longitude
+        Route       //!< Есть points или count
+    };
+
+    //! \brief Вид сообщения; значения не разбираются, только пропускаются
+    Content classify(const char *data, size_t size);
+
+    //! \brief Телеметрия BoardTelemetry: широта, долгота, высота, углы (рад -> град) и скорость
+    //! Неизвестные ключи пропускаются, отсутствующие углы и скорость равны нулю;
+    //! dateTime и поля, которых нет в сообщении, не меняются
+    //! \return false, если в сообщении нет координат или оно повреждено
+    bool decodeTelemetry(const char *data, size_t size, GroupFlight::Telemetry &telemetry);
+
+    //! \brief Маршрут RoutePoints: count, current и points - массив точек lat, lon (град) и alt
+    //! Точки записываются в route сразу, без промежуточных структур; память резервируется по заголовку
+    //! массива, широта и долгота переводятся в радианы одним проходом по готовому маршруту.
+    //! Берется count + 1 точка (точка дома и count точек маршрута), если их столько в массиве
+    //! \param current - номер текущей точки
+    //! \return false, если в сообщении нет нужных ключей или оно повреждено; route тогда не определен
+    bool decodeRoute(const char *data, size_t size, std::vector<GroupFlight::FlightPoint> &route, uint32_t &current);
+}
+
+#endif // MSGPACKSTREAM_H
@@ -0,0 +1,156 @@
+#include "requestscheduler.h"
+
+#include <algorithm>
+
+RequestScheduler::RequestScheduler(size_t _maxOutstanding, Clock::duration _timeout):
+    maxOutstanding(_maxOutstanding > 0 ? _maxOutstanding : 1), timeout(_timeout)
+{
+}
+
+void RequestScheduler::setStream(StreamId stream, const char *request, size_t size, Clock::duration period)
+{
+    Stream *current = find(stream);
+    if (!current)
+    {
+        streams.push_back(Stream{stream, std::vector<char>(), Clock::duration::zero(), Clock::now(), false, Stats()});
+        current = &streams.back();
+    }
+
+    current->request.assign(request, request + size);
+    current->period = period;
+}
+
+void RequestScheduler::setPeriod(StreamId stream, Clock::duration period)
+{
+    if (Stream *current = find(stream)) current->period = period;
+}
+
+bool RequestScheduler::hasStreams() const
+{
+    return std::any_of(streams.begin(), streams.end(),
+                       [](const Stream &stream){ return stream.period > Clock::duration::zero(); });
+}
+
+size_t RequestScheduler::poll(Clock::time_point now, std::vector<char> &out)
+{
+    expire(now);
+
+    size_t count = 0;
+    for (;;)
+    {
+        // Первым отправляется запрос, дольше всех ожидающий своей очереди
+        Stream *next = nullptr;
+        for (Stream &stream: streams)
+        {
+            if (stream.period <= Clock::duration::zero() || stream.due > now) continue;
+            if (!next || stream.due < next->due) next = &stream;
+        }
+
+        if (!next) break;
+
+        if (pending.size() >= maxOutstanding)
+        {
+            for (Stream &stream: streams)
+            {
+                if (stream.period <= Clock::duration::zero() || stream.due > now || stream.deferred) continue;
+                stream.deferred = true;
+                stream.stats.deferred++;
+            }
+            break;
+        }
+
+        out.insert(out.end(), next->request.begin(), next->request.end());
+        pending.push_back(Pending{static_cast<size_t>(next - streams.data()), now});
+
+        next->due += next->period;
+        if (next->due <= now) next->due = now + next->period;
+        next->deferred = false;
+        next->stats.sent++;
+        count++;
+    }
+
+    return count;
+}
+
+bool RequestScheduler::complete(Clock::time_point now, StreamId stream, Clock::duration *latency)
+{
+    expire(now);
+
+    const Stream *current = find(stream);
+    if (!current) return false;
+
+    const size_t index = static_cast<size_t>(current - streams.data());
+    const auto oldest = std::find_if(pending.begin(), pending.end(),
+                                     [index](const Pending &entry){ return entry.stream == index; });
+
+    // Ответ на запрос, ожидание которого уже истекло: сопоставить его нечему
+    if (oldest == pending.end())
+    {
+        streams[index].stats.late++;
+        return false;
+    }
+
+    // Ответы идут по порядку: на более старые запросы ответа уже не будет
+    for (auto entry = pending.begin(); entry != oldest; ++entry)
+        streams[entry->stream].stats.timedOut++;
+
+    if (latency) *latency = now - oldest->sent;
+    streams[index].stats.completed++;
+    pending.erase(pending.begin(), oldest + 1);
+    return true;
+}
+
+RequestScheduler::Clock::time_point RequestScheduler::nextDue() const
+{
+    Clock::time_point result = Clock::time_point::max();
+
+    // Пока окно занято, новые запросы ждут ответа или истечения его ожидания
+    if (pending.size() < maxOutstanding)
+    {
+        for (const Stream &stream: streams)
+            if (stream.period > Clock::duration::zero()) result = std::min(result, stream.due);
+    }
+
+    if (!pending.empty()) result = std::min(result, pending.front().sent + timeout);
+    return result;
+}
+
+void RequestScheduler::reset(Clock::time_point now)
+{
+    pending.clear();
+    for (Stream &stream: streams)
+    {
+        stream.due = now;
+        stream.deferred = false;
+    }
+}
+
+RequestScheduler::Stats RequestScheduler::stats(StreamId stream) const
+{
+    const Stream *current = find(stream);
+    return current ? current->stats : Stats();
+}
+
+RequestScheduler::Stream *RequestScheduler::find(StreamId stream)
+{
+    for (Stream &current: streams)
+        if (current.id == stream) return &current;
+    return nullptr;
+}
+
+const RequestScheduler::Stream *RequestScheduler::find(StreamId stream) const
+{
+    for (const Stream &current: streams)
+        if (current.id == stream) return &current;
+    return nullptr;
+}
+
+void RequestScheduler::expire(Clock::time_point now)
+{
+    // Ответы идут по порядку: если нет ответа на самый старый запрос, его место в очереди освобождается
+    while (!pending.empty() && now - pending.front().sent >= timeout)
+    {
+        streams[pending.front().stream].stats.timedOut++;
+        pending.pop_front();
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+//! \brief Опрос автопилота по одному соединению: несколько потоков запросов со своей частотой
+//! Каждый поток - заранее сериализованный запрос и период его отправки. Запросы отправляются
+//! не дожидаясь ответов на предыдущие (конвейер), но ожидающих ответа не больше maxOutstanding.
+//! Вызывающий определяет поток ответа по его содержимому; ответ сопоставляется самому старому
+//! ожидающему запросу этого потока. Автопилот отвечает в порядке запросов, поэтому более старые
+//! запросы других потоков, оставшиеся без ответа, считаются потерянными. Ответ, не пришедший
+//! за timeout, тоже считается потерянным, а пришедший после этого - отбрасывается.
+//! Класс не привязан к сокету и таймеру: время передается вызывающим
+class RequestScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    //! Номер потока запросов (например, значение AutopilotProtocol)
+    using StreamId = uint8_t;
+
+    explicit RequestScheduler(size_t maxOutstanding = 4,
+                              Clock::duration timeout = std::chrono::seconds(1));
+
+    //! \brief Поток опроса: request отправляется раз в period; period = 0 - поток отключен
+    //! Запрос копируется один раз и затем отправляется без повторной сериализации
+    void setStream(StreamId stream, const char *request, size_t size, Clock::duration period);
+    void setPeriod(StreamId stream, Clock::duration period);
+    bool hasStreams() const;
+
+    void setMaxOutstanding(size_t count) { maxOutstanding = count > 0 ? count : 1; }
+    size_t outstanding() const { return pending.size(); }
+
+    //! \brief Запросы, срок которых наступил к now, дописываются в out - их отправляют одной записью
+    //! Поток, отставший больше чем на период (окно занято), не догоняет пропущенное пачкой запросов
+    //! \return количество запросов
+    size_t poll(Clock::time_point now, std::vector<char> &out);
+
+    //! \brief Пришел ответ потока stream: сопоставление самому старому ожидающему запросу потока
+    //! \param latency - время от отправки запроса до ответа
+    //! \return false, если запросов этого потока не ожидается (ответ опоздал) - ответ отбрасывают
+    bool complete(Clock::time_point now, StreamId stream, Clock::duration *latency = nullptr);
+
+    //! \brief Время ближайшего запроса или истечения ожидания ответа; Clock::time_point::max() - опрашивать нечего
+    Clock::time_point nextDue() const;
+
+    //! \brief Соединение установлено заново: ожидаемые ответы сбрасываются, опрос начинается с now
+    void reset(Clock::time_point now);
+
+    //! Статистика потока запросов
+    struct Stats
+    {
+        uint64_t sent = 0;          //!< Отправлено запросов
+        uint64_t completed = 0;     //!< Получено ответов
+        uint64_t timedOut = 0;      //!< Ответ не пришел за timeout или пропущен автопилотом
+        uint64_t late = 0;          //!< Ответ пришел, когда запросов потока не ожидалось
+        uint64_t deferred = 0;      //!< Запрос отложен: окно ожидающих ответов заполнено
+    };
+
+    Stats stats(StreamId stream) const;
+
+private:
+    struct Stream
+    {
+        StreamId id;
+        std::vector<char> request;
+        Clock::duration period;
+        Clock::time_point due;
+        bool deferred;
+        Stats stats;
+    };
+
+    struct Pending
+    {
+        size_t stream;              // Индекс в streams
+        Clock::time_point sent;
+    };
+
+    Stream *find(StreamId stream);
+    const Stream *find(StreamId stream) const;
+    void expire(Clock::time_point now);
+
+    std::vector<Stream> streams;
+    std::deque<Pending> pending;
+    size_t maxOutstanding;
+    Clock::duration timeout;
+};
+
+#endif // REQUESTSCHEDULER_H
@@ -0,0 +1,137 @@
+#include "sockettuning.h"
+
+#ifdef __linux__
+#define SOCKETTUNING_LINUX
+#endif
+
+#ifdef SOCKETTUNING_LINUX
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+
+namespace SocketTuning
+{
+
+Profile Profile::lowLatency()
+{
+    Profile profile;
+    profile.noDelay = true;
+    profile.quickAck = true;
+    profile.receiveBuffer = 256 * 1024;
+    profile.sendBuffer = 64 * 1024;
+    profile.tos = 46 << 2;      // DSCP EF (Expedited Forwarding)
+    profile.keepAlive = true;
+    profile.keepIdle = 5;
+    profile.keepInterval = 1;
+    profile.keepCount = 3;
+    return profile;
+}
+
+bool supported()
+{
+#ifdef SOCKETTUNING_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef SOCKETTUNING_LINUX
+
+namespace
+{
+    bool set(int socket, int level, int option, int value)
+    {
+        return setsockopt(socket, level, option, &value, sizeof(value)) == 0;
+    }
+
+    int get(int socket, int level, int option, int fallback)
+    {
+        int value = 0;
+        socklen_t size = sizeof(value);
+        return getsockopt(socket, level, option, &value, &size) == 0 ? value : fallback;
+    }
+}
+
+int apply(int socket, const Profile &profile, Profile *effective)
+{
+    int failed = 0;
+
+    if (profile.noDelay && !set(socket, IPPROTO_TCP, TCP_NODELAY, 1)) failed++;
+    if (profile.quickAck && !set(socket, IPPROTO_TCP, TCP_QUICKACK, 1)) failed++;
+    if (profile.receiveBuffer > 0 && !set(socket, SOL_SOCKET, SO_RCVBUF, profile.receiveBuffer)) failed++;
+    if (profile.sendBuffer > 0 && !set(socket, SOL_SOCKET, SO_SNDBUF, profile.sendBuffer)) failed++;
+#ifdef SO_BUSY_POLL
+    // Значение больше net.core.busy_read требует CAP_NET_ADMIN
+    if (profile.busyPoll > 0 && !set(socket, SOL_SOCKET, SO_BUSY_POLL, profile.busyPoll)) failed++;
+#else
+    if (profile.busyPoll > 0) failed++;
+#endif
+    if (profile.tos >= 0 && !set(socket, IPPROTO_IP, IP_TOS, profile.tos)) failed++;
+
+    if (profile.keepAlive)
+    {
+        if (!set(socket, SOL_SOCKET, SO_KEEPALIVE, 1)) failed++;
+        if (profile.keepIdle > 0 && !set(socket, IPPROTO_TCP, TCP_KEEPIDLE, profile.keepIdle)) failed++;
+        if (profile.keepInterval > 0 && !set(socket, IPPROTO_TCP, TCP_KEEPINTVL, profile.keepInterval)) failed++;
+        if (profile.keepCount > 0 && !set(socket, IPPROTO_TCP, TCP_KEEPCNT, profile.keepCount)) failed++;
+    }
+
+    if (effective) *effective = query(socket);
+    return failed;
+}
+
+Profile query(int socket)
+{
+    Profile profile;
+    profile.noDelay = get(socket, IPPROTO_TCP, TCP_NODELAY, 0) != 0;
+    profile.quickAck = get(socket, IPPROTO_TCP, TCP_QUICKACK, 0) != 0;
+    profile.receiveBuffer = get(socket, SOL_SOCKET, SO_RCVBUF, 0);
+    profile.sendBuffer = get(socket, SOL_SOCKET, SO_SNDBUF, 0);
+#ifdef SO_BUSY_POLL
+    profile.busyPoll = get(socket, SOL_SOCKET, SO_BUSY_POLL, 0);
+#endif
+    profile.tos = get(socket, IPPROTO_IP, IP_TOS, -1);
+    profile.keepAlive = get(socket, SOL_SOCKET, SO_KEEPALIVE, 0) != 0;
+    profile.keepIdle = get(socket, IPPROTO_TCP, TCP_KEEPIDLE, 0);
+    profile.keepInterval = get(socket, IPPROTO_TCP, TCP_KEEPINTVL, 0);
+    profile.keepCount = get(socket, IPPROTO_TCP, TCP_KEEPCNT, 0);
+    return profile;
+}
+
+void rearmQuickAck(int socket)
+{
+    set(socket, IPPROTO_TCP, TCP_QUICKACK, 1);
+}
+
+#else
+
+int apply(int, const Profile &profile, Profile *effective)
+{
+    if (effective) *effective = Profile();
+
+    int failed = 0;
+    if (profile.noDelay) failed++;
+    if (profile.quickAck) failed++;
+    if (profile.receiveBuffer > 0) failed++;
+    if (profile.sendBuffer > 0) failed++;
+    if (profile.busyPoll > 0) failed++;
+    if (profile.tos >= 0) failed++;
+    if (profile.keepAlive) failed++;
+    return failed;
+}
+
+Profile query(int)
+{
+    return Profile();
+}
+
+void rearmQuickAck(int)
+{
+}
+
+#endif
+
+} // namespace SocketTuning
@@ -0,0 +1,46 @@
+#ifndef SOCKETTUNING_H
+#define SOCKETTUNING_H
+
+#include <cstdint>
+
+//! Настройка сокетов TCP для малой задержки команд (Linux).
+//! На других системах supported() возвращает false, и применяются только параметры, доступные через Qt
+namespace SocketTuning
+{
+    //! \brief Параметры сокета; нулевые (и tos = -1) не меняются и остаются системными
+    struct Profile
+    {
+        bool noDelay = false;       //!< TCP_NODELAY: короткие запросы уходят сразу (без алгоритма Нейгла)
+        bool quickAck = false;      //!< TCP_QUICKACK: подтверждение без задержки; ядро его сбрасывает, см. rearmQuickAck()
+        int receiveBuffer = 0;      //!< SO_RCVBUF, байт
+        int sendBuffer = 0;         //!< SO_SNDBUF, байт
+        int busyPoll = 0;           //!< SO_BUSY_POLL, мкс опроса очереди сетевой карты при чтении; требует CAP_NET_ADMIN
+                                    //!< и занимает процессор в потоке чтения, поэтому задается явно
+        int tos = -1;               //!< IP_TOS (DSCP << 2)
+        bool keepAlive = false;     //!< SO_KEEPALIVE
+        int keepIdle = 0;           //!< TCP_KEEPIDLE, с без обмена до первой проверки
+        int keepInterval = 0;       //!< TCP_KEEPINTVL, с между проверками
+        int keepCount = 0;          //!< TCP_KEEPCNT, проверок без ответа до разрыва
+
+        //! \brief Профиль канала команд автопилота: без задержек отправки и подтверждения,
+        //! DSCP EF, обнаружение обрыва за несколько секунд. SO_BUSY_POLL не включается
+        static Profile lowLatency();
+    };
+
+    //! \brief Доступна ли настройка через дескриптор сокета
+    bool supported();
+
+    //! \brief Установка параметров profile для сокета TCP socket
+    //! \param effective - действующие после установки значения (ядро может округлить или удвоить их)
+    //! \return количество параметров, которые установить не удалось
+    int apply(int socket, const Profile &profile, Profile *effective = nullptr);
+
+    //! \brief Действующие значения параметров сокета
+    Profile query(int socket);
+
+    //! \brief Повторная установка TCP_QUICKACK: ядро выключает режим после отправки подтверждений,
+    //! поэтому его устанавливают перед каждым чтением
+    void rearmQuickAck(int socket);
+}
+
+#endif // SOCKETTUNING_H
@@ -4,32 +4,45 @@ QT       += network
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++14
 
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    batchio.cpp \
+    connectionmanager.cpp \
+    datagramqueue.cpp \
     datatransmitter.cpp \
+    ioengine.cpp \
     main.cpp \
     mainwindow.cpp \
-    tcpudptranslator.cpp
+    msgpackstream.cpp \
+    requestscheduler.cpp \
+    sockettuning.cpp \
+    tcpudpbridge.cpp \
+    tcpudptranslator.cpp \
+    uringengine.cpp
 
 HEADERS += \
+    batchio.h \
+    connectionmanager.h \
+    datagramqueue.h \
     datatransmitter.h \
+    ioengine.h \
     mainwindow.h \
-    tcpudptranslator.h
+    msgpackstream.h \
+    requestscheduler.h \
+    sockettuning.h \
+    tcpudpbridge.h \
+    tcpudptranslator.h \
+    uringengine.h
 
 FORMS += \
     mainwindow.ui
 
-unix{
-include(/home/deneb/Qt Projects/GroupFlightProject/qmsgpack/qmsgpack.pri)
-}
-win32{
-include(../qmsgpack/qmsgpack.pri)
-}
+include(GroupFlightGlobal/GroupFlightGlobal.pri)
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
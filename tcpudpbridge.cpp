@@ -0,0 +1,605 @@
+#include "tcpudpbridge.h"
+
+#include "batchio.h"
+#include "ioengine.h"
+
+#ifdef __linux__
+#define TCPUDPBRIDGE_LINUX
+#endif
+
+#ifdef TCPUDPBRIDGE_LINUX
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Заголовки старше ядра 4.14
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#ifndef SO_EE_CODE_ZEROCOPY_COPIED
+#define SO_EE_CODE_ZEROCOPY_COPIED 1
+#endif
+#endif
+
+namespace
+{
+    const size_t k_chunkSize = 256 * 1024;      // Буфер приема TCP
+    const size_t k_minRead = 16 * 1024;         // Наименьшее свободное место для чтения
+    const int k_maxReads = 16;                  // Чтений TCP за одно событие: остальные соединения не ждут
+    const size_t k_maxDatagram = 65507;         // Наибольшие данные датаграммы UDP (IPv4)
+    const size_t k_maxInFlight = 256;           // Отправок MSG_ZEROCOPY без уведомления; дальше - с копированием
+    const int k_zeroCopyDrain = 200;            // Ожидание уведомлений MSG_ZEROCOPY при остановке, мс
+}
+
+TcpUdpBridge::TcpUdpBridge(IoEngine &_engine)
+    : engine(_engine), pool(BatchIo::k_maxBatch)
+{
+}
+
+TcpUdpBridge::~TcpUdpBridge()
+{
+    stop();
+}
+
+void TcpUdpBridge::setClosedCallback(ClosedCallback callback)
+{
+    closedCallback = std::move(callback);
+}
+
+TcpUdpBridge::Stats TcpUdpBridge::stats() const
+{
+    Stats result;
+    result.toUdp.messages = toUdp.messages.load(std::memory_order_relaxed);
+    result.toUdp.bytes = toUdp.bytes.load(std::memory_order_relaxed);
+    result.toUdp.dropped = toUdp.dropped.load(std::memory_order_relaxed);
+    result.toTcp.messages = toTcp.messages.load(std::memory_order_relaxed);
+    result.toTcp.bytes = toTcp.bytes.load(std::memory_order_relaxed);
+    result.toTcp.dropped = toTcp.dropped.load(std::memory_order_relaxed);
+    result.zeroCopy = zeroCopyCount.load(std::memory_order_relaxed);
+    result.zeroCopyCopied = zeroCopyCopied.load(std::memory_order_relaxed);
+    result.zeroCopyAbandoned = zeroCopyAbandoned.load(std::memory_order_relaxed);
+    result.skipped = skipped.load(std::memory_order_relaxed);
+    return result;
+}
+
+TcpUdpBridge::Rates TcpUdpBridge::rates()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const Stats snapshot = stats();
+    const double seconds = std::chrono::duration<double>(now - lastRates).count();
+
+    Rates result;
+    if (seconds > 0)
+    {
+        result.toUdp.messages = double(snapshot.toUdp.messages - lastStats.toUdp.messages) / seconds;
+        result.toUdp.bytes = double(snapshot.toUdp.bytes - lastStats.toUdp.bytes) / seconds;
+        result.toTcp.messages = double(snapshot.toTcp.messages - lastStats.toTcp.messages) / seconds;
+        result.toTcp.bytes = double(snapshot.toTcp.bytes - lastStats.toTcp.bytes) / seconds;
+    }
+
+    lastStats = snapshot;
+    lastRates = now;
+    return result;
+}
+
+#ifdef TCPUDPBRIDGE_LINUX
+
+namespace
+{
+    sockaddr_in address(uint32_t host, uint16_t port)
+    {
+        sockaddr_in result;
+        memset(&result, 0, sizeof(result));
+        result.sin_family = AF_INET;
+        result.sin_addr.s_addr = htonl(host);
+        result.sin_port = htons(port);
+        return result;
+    }
+
+    //! Неблокирующий сокет TCP с ожиданием подключения до timeout мс
+    int connectTcp(uint32_t host, uint16_t port, int timeout)
+    {
+        const int result = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (result < 0) return -1;
+
+        const sockaddr_in target = address(host, port);
+        if (connect(result, reinterpret_cast<const sockaddr *>(&target), sizeof(target)) < 0)
+        {
+            pollfd descriptor = {result, POLLOUT, 0};
+            int error = errno == EINPROGRESS ? 0 : errno;
+            socklen_t size = sizeof(error);
+
+            if (error != 0 || poll(&descriptor, 1, timeout) <= 0 ||
+                    getsockopt(result, SOL_SOCKET, SO_ERROR, &error, &size) < 0 || error != 0)
+            {
+                close(result);
+                return -1;
+            }
+        }
+
+        return result;
+    }
+}
+
+bool TcpUdpBridge::start(const Config &_config)
+{
+    if (isRunning() || tcpSocket >= 0) return false;
+    if (_config.listenPort != 0 && _config.listenPort == _config.udpPort) return false;
+
+    config = _config;
+
+    udpSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (udpSocket < 0) return false;
+
+    setsockopt(udpSocket, IPPROTO_IP, IP_MULTICAST_TTL, &config.multicastTtl, sizeof(config.multicastTtl));
+
+    // Без поддержки ядра (до 5.0 для UDP) все сообщения отправляются с копированием
+    const int enable = 1;
+    zeroCopy = config.zeroCopyThreshold > 0 &&
+            setsockopt(udpSocket, SOL_SOCKET, SO_ZEROCOPY, &enable, sizeof(enable)) == 0;
+
+    if (config.listenPort != 0)
+    {
+        listenSocket = BatchIo::open(config.listenPort, config.listenGroup);
+        if (listenSocket < 0)
+        {
+            stop();
+            return false;
+        }
+    }
+
+    tcpSocket = connectTcp(config.tcpHost, config.tcpPort, config.connectTimeout);
+    if (tcpSocket < 0)
+    {
+        stop();
+        return false;
+    }
+
+    SocketTuning::apply(tcpSocket, config.tuning);
+
+    toUdp.messages = 0;
+    toUdp.bytes = 0;
+    toUdp.dropped = 0;
+    toTcp.messages = 0;
+    toTcp.bytes = 0;
+    toTcp.dropped = 0;
+    zeroCopyCount = 0;
+    zeroCopyCopied = 0;
+    zeroCopyAbandoned = 0;
+    skipped = 0;
+    lastStats = Stats();
+    lastRates = std::chrono::steady_clock::now();
+
+    framer.reset();
+    nextZeroCopyId = 0;
+
+    if (!config.request.empty() &&
+            send(tcpSocket, config.request.data(), config.request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(config.request.size()))
+    {
+        stop();
+        return false;
+    }
+
+    running.store(true, std::memory_order_release);
+
+    if (!engine.start() ||
+            !engine.addReader(tcpSocket, [this]{ tcpReadable(); }) ||
+            !engine.addReader(udpSocket, [this]{ completions(); }) ||
+            (listenSocket >= 0 && !engine.addReader(listenSocket, [this]{ udpReadable(); })))
+    {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void TcpUdpBridge::stop()
+{
+    running.store(false, std::memory_order_release);
+
+    // После removeReader обработчики не выполняются: состояние можно сбросить из этого потока
+    for (int *socket: {&tcpSocket, &udpSocket, &listenSocket})
+    {
+        if (*socket < 0) continue;
+
+        engine.removeReader(*socket);
+
+        // Ядро читает данные отправок MSG_ZEROCOPY до уведомления: сокет закрывается после них
+        if (socket == &udpSocket) drainZeroCopy();
+
+        close(*socket);
+        *socket = -1;
+    }
+
+    // Уведомление не пришло: буфер мог быть еще не отправлен. Он остается занятым до конца
+    // работы процесса, иначе ядро отправило бы данные, записанные в эту память позже
+    for (std::unique_ptr<Chunk> &chunk: chunks)
+    {
+        if (chunk->pending == 0) continue;
+
+        chunk.release();
+        add(zeroCopyAbandoned, 1);
+    }
+
+    inFlight.clear();
+    chunks.clear();
+    current = nullptr;
+    messageStart = 0;
+    used = 0;
+    backlog.clear();
+    backlogOffset = 0;
+    writeWatched = false;
+}
+
+void TcpUdpBridge::closed()
+{
+    running.store(false, std::memory_order_release);
+
+    // Сокеты закрывает stop(): здесь только прекращается их обслуживание
+    engine.removeReader(tcpSocket);
+    engine.removeReader(udpSocket);
+    if (listenSocket >= 0) engine.removeReader(listenSocket);
+
+    if (closedCallback) closedCallback();
+}
+
+void TcpUdpBridge::tcpReadable()
+{
+    // Событие может быть и готовностью к записи очереди UDP -> TCP
+    flushBacklog();
+
+    for (int i = 0; i < k_maxReads; i++)
+    {
+        // Режим немедленного подтверждения ядро сбрасывает после отправки подтверждений
+        if (config.tuning.quickAck) SocketTuning::rearmQuickAck(tcpSocket);
+
+        makeRoom();
+
+        const size_t space = current->data.size() - used;
+        const ssize_t received = recv(tcpSocket, current->data.data() + used, space, MSG_DONTWAIT);
+
+        if (received == 0)
+        {
+            closed();
+            return;
+        }
+
+        if (received < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+            closed();
+            return;
+        }
+
+        used += static_cast<size_t>(received);
+        forward();
+
+        if (static_cast<size_t>(received) < space) break;
+    }
+
+    if (!inFlight.empty()) completions();
+}
+
+void TcpUdpBridge::makeRoom()
+{
+    if (current && current->data.size() - used >= k_minRead) return;
+
+    const size_t tail = current ? used - messageStart : 0;
+
+    if (current && current->pending == 0)
+    {
+        // Незаконченное сообщение переносится в начало того же буфера
+        memmove(current->data.data(), current->data.data() + messageStart, tail);
+        messageStart = 0;
+        used = tail;
+
+        // Сообщение длиннее буфера
+        if (current->data.size() - used < k_minRead) current->data.resize(current->data.size() * 2);
+        return;
+    }
+
+    // На буфер ссылаются отправки MSG_ZEROCOPY: незаконченное сообщение переносится в свободный буфер
+    Chunk *next = nullptr;
+    for (const std::unique_ptr<Chunk> &chunk: chunks)
+    {
+        if (chunk.get() != current && chunk->pending == 0 && chunk->data.size() >= tail + k_minRead)
+        {
+            next = chunk.get();
+            break;
+        }
+    }
+
+    if (!next)
+    {
+        chunks.emplace_back(new Chunk);
+        next = chunks.back().get();
+        next->data.resize(std::max(k_chunkSize, 2 * (tail + k_minRead)));
+    }
+
+    if (tail > 0) memcpy(next->data.data(), current->data.data() + messageStart, tail);
+
+    current = next;
+    messageStart = 0;
+    used = tail;
+}
+
+void TcpUdpBridge::forward()
+{
+    while (messageStart < used)
+    {
+        size_t length = 0;
+        const AutopilotMsgPack::Status status = framer.next(current->data.data() + messageStart, used - messageStart, length);
+        if (status == AutopilotMsgPack::Status::NeedMore) return;
+
+        if (status == AutopilotMsgPack::Status::Error)
+        {
+            // Поврежденный поток: словарь или массив ищется со следующего байта
+            messageStart++;
+            add(skipped, 1);
+            continue;
+        }
+
+        sendDatagram(current->data.data() + messageStart, length);
+        messageStart += length;
+    }
+}
+
+void TcpUdpBridge::sendDatagram(const char *data, size_t size)
+{
+    if (size > k_maxDatagram)
+    {
+        add(toUdp.dropped, 1);
+        return;
+    }
+
+    const sockaddr_in target = address(config.udpHost, config.udpPort);
+    bool zeroCopySend = zeroCopy && size >= config.zeroCopyThreshold && inFlight.size() < k_maxInFlight;
+
+    ssize_t sent;
+    do
+        sent = sendto(udpSocket, data, size, MSG_DONTWAIT | (zeroCopySend ? MSG_ZEROCOPY : 0),
+                      reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+    while (sent < 0 && errno == EINTR);
+
+    // Исчерпан лимит памяти уведомлений (optmem_max): сообщение отправляется с копированием
+    if (sent < 0 && zeroCopySend && errno == ENOBUFS)
+    {
+        zeroCopySend = false;
+        sent = sendto(udpSocket, data, size, MSG_DONTWAIT, reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+    }
+
+    if (sent < 0)
+    {
+        add(toUdp.dropped, 1);
+        return;
+    }
+
+    if (zeroCopySend)
+    {
+        // Ядро нумерует успешные отправки MSG_ZEROCOPY сокета подряд, начиная с нуля
+        current->pending++;
+        inFlight.push_back(InFlight{nextZeroCopyId++, current});
+        add(zeroCopyCount, 1);
+    }
+
+    add(toUdp.messages, 1);
+    add(toUdp.bytes, size);
+}
+
+void TcpUdpBridge::completions()
+{
+    char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in))];
+
+    for (;;)
+    {
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        if (recvmsg(udpSocket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header))
+        {
+            if (header->cmsg_level != SOL_IP || header->cmsg_type != IP_RECVERR) continue;
+
+            sock_extended_err error;
+            memcpy(&error, CMSG_DATA(header), sizeof(error));
+            if (error.ee_errno != 0 || error.ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+
+            // Уведомление покрывает отправки с ee_info по ee_data включительно
+            release(error.ee_info, error.ee_data, (error.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0);
+        }
+    }
+
+    // Датаграммы на порт отправки не ожидаются: отбрасываются, чтобы не будить движок
+    char discard[1];
+    while (recv(udpSocket, discard, sizeof(discard), MSG_DONTWAIT | MSG_TRUNC) >= 0) {}
+}
+
+void TcpUdpBridge::drainZeroCopy()
+{
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(k_zeroCopyDrain);
+
+    completions();
+    while (!inFlight.empty())
+    {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0) break;
+
+        // Уведомление в очереди ошибок сообщается как POLLERR без подписки на события
+        pollfd descriptor = {udpSocket, 0, 0};
+        poll(&descriptor, 1, static_cast<int>(left.count()));
+        completions();
+    }
+}
+
+void TcpUdpBridge::release(uint32_t first, uint32_t last, bool copied)
+{
+    const uint32_t range = last - first;
+    for (auto send = inFlight.begin(); send != inFlight.end(); )
+    {
+        if (send->id - first > range)
+        {
+            ++send;
+            continue;
+        }
+
+        send->chunk->pending--;
+        if (copied) add(zeroCopyCopied, 1);
+        send = inFlight.erase(send);
+    }
+}
+
+void TcpUdpBridge::udpReadable()
+{
+    flushBacklog();
+
+    GroupFlight::PacketBufferPool::Buffer buffers[BatchIo::k_maxBatch];
+    size_t count = 0;
+    while (count < BatchIo::k_maxBatch && (buffers[count] = pool.acquire()))
+        count++;
+
+    const int received = BatchIo::receive(listenSocket, buffers, count);
+    if (received <= 0) return;
+
+    iovec vectors[BatchIo::k_maxBatch];
+    size_t size = 0;
+    for (int i = 0; i < received; i++)
+    {
+        vectors[i].iov_base = buffers[i].data();
+        vectors[i].iov_len = buffers[i].size();
+        size += buffers[i].size();
+    }
+
+    writeTcp(vectors, static_cast<size_t>(received), size);
+}
+
+bool TcpUdpBridge::writeTcp(const iovec *vectors, size_t count, size_t size)
+{
+    ssize_t sent = 0;
+
+    // Очередь не пуста: данные дописываются за ней, чтобы не нарушить порядок потока
+    if (backlogOffset == backlog.size())
+    {
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = const_cast<iovec *>(vectors);
+        message.msg_iovlen = count;
+
+        do
+            sent = sendmsg(tcpSocket, &message, MSG_DONTWAIT | MSG_NOSIGNAL);
+        while (sent < 0 && errno == EINTR);
+
+        if (sent < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                add(toTcp.dropped, count);
+                return false;
+            }
+            sent = 0;
+        }
+
+        if (static_cast<size_t>(sent) == size)
+        {
+            add(toTcp.messages, count);
+            add(toTcp.bytes, size);
+            return true;
+        }
+    }
+
+    // Остаток частично записанной датаграммы ставится в очередь всегда, иначе поток был бы поврежден;
+    // не начатые датаграммы - если помещаются в очередь
+    size_t offset = static_cast<size_t>(sent);
+    for (size_t i = 0; i < count; i++)
+    {
+        const char *data = static_cast<const char *>(vectors[i].iov_base);
+        const size_t length = vectors[i].iov_len;
+
+        if (offset >= length)
+        {
+            offset -= length;
+            add(toTcp.messages, 1);
+            add(toTcp.bytes, length);
+            continue;
+        }
+
+        if (offset == 0 && backlog.size() - backlogOffset + length > config.backlogLimit)
+        {
+            add(toTcp.dropped, 1);
+            continue;
+        }
+
+        backlog.insert(backlog.end(), data + offset, data + length);
+        offset = 0;
+        add(toTcp.messages, 1);
+        add(toTcp.bytes, length);
+    }
+
+    // Очередь дописывается, как только сокет TCP будет готов к записи
+    if (backlogOffset < backlog.size() && !writeWatched) writeWatched = engine.watchWrite(tcpSocket, true);
+    return true;
+}
+
+bool TcpUdpBridge::flushBacklog()
+{
+    while (backlogOffset < backlog.size())
+    {
+        const ssize_t sent = send(tcpSocket, backlog.data() + backlogOffset, backlog.size() - backlogOffset,
+                                  MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR) continue;
+
+            // Записанная часть освобождается, когда занимает больше половины очереди
+            if (backlogOffset > backlog.size() / 2)
+            {
+                backlog.erase(backlog.begin(), backlog.begin() + static_cast<std::ptrdiff_t>(backlogOffset));
+                backlogOffset = 0;
+            }
+            return false;
+        }
+
+        backlogOffset += static_cast<size_t>(sent);
+    }
+
+    backlog.clear();
+    backlogOffset = 0;
+
+    if (writeWatched) writeWatched = !engine.watchWrite(tcpSocket, false);
+    return true;
+}
+
+#else
+
+bool TcpUdpBridge::start(const Config &)
+{
+    return false;
+}
+
+void TcpUdpBridge::stop()
+{
+    running.store(false, std::memory_order_release);
+}
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef TCPUDPBRIDGE_H
+#define TCPUDPBRIDGE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "bufferpool.h"
+#include "msgpackstream.h"
+#include "sockettuning.h"
+
+class IoEngine;
+
+//! \brief Мост между соединением TCP автопилота и получателями UDP (multicast) в потоке IoEngine (Linux)
+//! TCP -> UDP: поток читается в буферы моста, каждое целое сообщение msgpack уходит одной датаграммой
+//! прямо из буфера приема, без копирования в промежуточные массивы и без цикла событий Qt.
+//! Сообщения от zeroCopyThreshold байт отправляются с MSG_ZEROCOPY: ядро берет страницы буфера,
+//! а буфер не используется повторно до уведомления о завершении из очереди ошибок сокета.
+//! UDP -> TCP: датаграммы подписчиков принимаются пачкой (recvmmsg) и пишутся в TCP одним sendmsg;
+//! то, что сокет не принял, ждет готовности к записи в ограниченной очереди.
+//! splice не используется: он не сохраняет границ сообщений, а датаграмма должна нести целое сообщение.
+//! На других системах start() возвращает false
+class TcpUdpBridge
+{
+public:
+    //! Параметры моста; адреса и порты - в порядке байт узла
+    struct Config
+    {
+        uint32_t tcpHost = 0;               //!< Автопилот
+        uint16_t tcpPort = 0;
+        uint32_t udpHost = 0;               //!< Получатели сообщений автопилота (адрес группы multicast или узла)
+        uint16_t udpPort = 0;
+        uint16_t listenPort = 0;            //!< Прием команд подписчиков для автопилота (0 - только TCP -> UDP)
+        uint32_t listenGroup = 0;           //!< Группа multicast для приема (0 - без подключения)
+        int multicastTtl = 1;
+        size_t zeroCopyThreshold = 16 * 1024;   //!< Наименьшее сообщение для MSG_ZEROCOPY (0 - без него)
+        int connectTimeout = 3000;          //!< Ожидание подключения, мс
+        size_t backlogLimit = 1024 * 1024;  //!< Наибольшая очередь записи в TCP, байт
+        SocketTuning::Profile tuning = SocketTuning::Profile::lowLatency(); //!< Параметры сокета TCP
+        std::vector<char> request;          //!< Запрос автопилоту сразу после подключения
+    };
+
+    //! Статистика одного направления
+    struct Direction
+    {
+        uint64_t messages = 0;      //!< Переслано сообщений (датаграмм)
+        uint64_t bytes = 0;
+        uint64_t dropped = 0;       //!< Отброшено: не помещается в датаграмму, ошибка отправки, переполнена очередь TCP
+    };
+
+    struct Stats
+    {
+        Direction toUdp;
+        Direction toTcp;
+        uint64_t zeroCopy = 0;          //!< Датаграмм, отправленных с MSG_ZEROCOPY
+        uint64_t zeroCopyCopied = 0;    //!< Из них ядро все же скопировало (например, на петлевом интерфейсе)
+        uint64_t zeroCopyAbandoned = 0; //!< Буферов, оставленных занятыми: при stop() уведомление не пришло
+        uint64_t skipped = 0;           //!< Байт потока TCP, пропущенных из-за поврежденных данных
+    };
+
+    //! Скорость направления, в секунду
+    struct Rate
+    {
+        double messages = 0;
+        double bytes = 0;
+    };
+
+    struct Rates
+    {
+        Rate toUdp;
+        Rate toTcp;
+    };
+
+    //! \brief Обработчик разрыва соединения TCP; вызывается в потоке движка
+    using ClosedCallback = std::function<void()>;
+
+    //! \param engine - поток ввода-вывода; запускается при start(), если еще не запущен
+    explicit TcpUdpBridge(IoEngine &engine);
+    ~TcpUdpBridge();
+
+    TcpUdpBridge(const TcpUdpBridge &) = delete;
+    TcpUdpBridge &operator=(const TcpUdpBridge &) = delete;
+
+    //! \brief Подключение к автопилоту (с ожиданием до connectTimeout) и запуск пересылки
+    //! \return false, если подключиться или открыть сокеты UDP не удалось;
+    //! listenPort должен отличаться от udpPort, иначе мост принимал бы собственные датаграммы
+    bool start(const Config &config);
+
+    //! \brief Остановка и закрытие сокетов; не вызывается из потока движка.
+    //! Ждет уведомлений о завершении отправок MSG_ZEROCOPY не дольше 200 мс
+    void stop();
+
+    //! \brief Пересылка идет: соединение TCP не разорвано
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    //! \brief Задается до start()
+    void setClosedCallback(ClosedCallback callback);
+
+    //! \brief Используется ли MSG_ZEROCOPY (ядро 5.0+)
+    bool zeroCopyActive() const { return zeroCopy; }
+
+    Stats stats() const;
+
+    //! \brief Скорость по направлениям со времени предыдущего вызова (или start())
+    Rates rates();
+
+private:
+    // Буфер приема TCP; не используется повторно, пока на него ссылаются отправки MSG_ZEROCOPY
+    struct Chunk
+    {
+        std::vector<char> data;
+        size_t pending = 0;
+    };
+
+    // Отправка MSG_ZEROCOPY, ожидающая уведомления ядра
+    struct InFlight
+    {
+        uint32_t id;
+        Chunk *chunk;
+    };
+
+    struct Counter
+    {
+        std::atomic<uint64_t> messages{0};
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    void tcpReadable();
+    void udpReadable();
+    void completions();
+    void closed();
+
+    void makeRoom();
+    void forward();
+    void sendDatagram(const char *data, size_t size);
+    void drainZeroCopy();
+    void release(uint32_t first, uint32_t last, bool copied);
+    bool writeTcp(const struct iovec *vectors, size_t count, size_t size);
+    bool flushBacklog();
+
+    static void add(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    IoEngine &engine;
+    Config config;
+    ClosedCallback closedCallback;
+    std::atomic<bool> running{false};
+    bool zeroCopy = false;
+
+    int tcpSocket = -1;
+    int udpSocket = -1;         // Отправка получателям; в очереди ошибок - уведомления MSG_ZEROCOPY
+    int listenSocket = -1;
+
+    // TCP -> UDP; поля ниже меняются только в потоке движка
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    Chunk *current = nullptr;
+    size_t messageStart = 0;    // Начало незаконченного сообщения в current
+    size_t used = 0;            // Конец принятых данных в current
+    AutopilotMsgPack::Framer framer;
+    std::deque<InFlight> inFlight;
+    uint32_t nextZeroCopyId = 0;
+
+    // UDP -> TCP
+    GroupFlight::PacketBufferPool pool;
+    std::vector<char> backlog;  // Не принятое сокетом TCP
+    size_t backlogOffset = 0;
+    bool writeWatched = false;  // Ожидается готовность TCP к записи
+
+    Counter toUdp;
+    Counter toTcp;
+    std::atomic<uint64_t> zeroCopyCount{0};
+    std::atomic<uint64_t> zeroCopyCopied{0};
+    std::atomic<uint64_t> zeroCopyAbandoned{0};
+    std::atomic<uint64_t> skipped{0};
+
+    Stats lastStats;
+    std::chrono::steady_clock::time_point lastRates;
+};
+
+#endif // TCPUDPBRIDGE_H
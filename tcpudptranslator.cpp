@@ -1,5 +1,9 @@
 #include "tcpudptranslator.h"
 
+#include <algorithm>
+
+#include "ioengine.h"
+
 TcpUdpTranslator::TcpUdpTranslator(QObject *parent)
     : QObject{parent}
 {
@@ -8,8 +12,28 @@ TcpUdpTranslator::TcpUdpTranslator(QObject *parent)
     m_udpHostIPAddr.clear();
     m_tcpServerPort = 0;
     m_udpDstPort = 0;
-    m_tcpSocket = new QTcpSocket;
-    m_udpSocket = new QUdpSocket;
+    m_udpSrcPort = 0;
+    m_udpBatchSocket = -1;
+    m_udpNotifier = nullptr;
+    // Сокеты - дочерние объекты, чтобы переходить в поток транслятора вместе с ним (moveToThread).
+    // Сокет UDP и таймер опроса создаются при первом использовании: клиенту только TCP они не нужны
+    m_tcpSocket = new QTcpSocket(this);
+    m_udpSocket = nullptr;
+    m_pollTimer = nullptr;
+
+    // Соединения сигналов TCP - один раз: сокет переподключается без их повторения
+    QObject::connect(m_tcpSocket, &QTcpSocket::connected, [=]{this->slotConnected(m_apType);});
+    QObject::connect(m_tcpSocket, &QTcpSocket::readyRead, [=]{this->dataRead(ProtocolType::TCP);});
+    QObject::connect(m_tcpSocket, &QTcpSocket::stateChanged, [=](QAbstractSocket::SocketState state)
+    {
+        // Сюда приходят и разрыв соединения, и неудачная попытка подключения
+        if (state != QAbstractSocket::UnconnectedState) return;
+        if (m_pollTimer) m_pollTimer->stop();
+        emit tcpDisconnected();
+    });
+
+    qRegisterMetaType<GroupFlight::Telemetry>();
+    qRegisterMetaType<std::vector<GroupFlight::FlightPoint>>();
     m_apType = AutopilotProtocol::BoardTelemetry;
 }
 
@@ -58,6 +82,7 @@ void TcpUdpTranslator::setTelemetry(GroupFlight::Telemetry telemetry)
 void TcpUdpTranslator::setAPType(AutopilotProtocol type)
 {
     this->m_apType = type;
+    m_tcpStream.clear();
 }
 
 void TcpUdpTranslator::setHomePoint(GroupFlight::Coords point)
@@ -141,20 +166,199 @@ std::vector<GroupFlight::FlightPoint> TcpUdpTranslator::route()
     return m_route;
 }
 
+void TcpUdpTranslator::setPollPeriod(AutopilotProtocol protocol, int msec)
+{
+    QByteArray request;
+    switch (protocol) {
+    case AutopilotProtocol::BoardTelemetry:
+        request = sendTelemetryRequest();
+        break;
+    case AutopilotProtocol::RoutePoints:
+        request = sendRoutePointsRequest();
+        break;
+    case AutopilotProtocol::Supervisor:
+        request = sendSupervisorRequest();
+        break;
+    }
+
+    m_scheduler.setStream(static_cast<RequestScheduler::StreamId>(protocol), request.constData(),
+                          static_cast<size_t>(request.size()), std::chrono::milliseconds(msec > 0 ? msec : 0));
+
+    if (m_tcpSocket->state() == QAbstractSocket::ConnectedState) pollRequests();
+}
+
+RequestScheduler::Stats TcpUdpTranslator::pollStats(AutopilotProtocol protocol)
+{
+    return m_scheduler.stats(static_cast<RequestScheduler::StreamId>(protocol));
+}
+
+void TcpUdpTranslator::setSocketTuning(const SocketTuning::Profile &profile)
+{
+    m_tuning = profile;
+    if (isConnected()) applySocketTuning();
+}
+
+SocketTuning::Profile TcpUdpTranslator::socketTuning()
+{
+    return m_tuning;
+}
+
+SocketTuning::Profile TcpUdpTranslator::effectiveSocketTuning()
+{
+    return m_effectiveTuning;
+}
+
+void TcpUdpTranslator::applySocketTuning()
+{
+    if (SocketTuning::supported())
+    {
+        const int failed = SocketTuning::apply(static_cast<int>(m_tcpSocket->socketDescriptor()), m_tuning, &m_effectiveTuning);
+        if (failed > 0) qDebug() << "Socket tuning:" << failed << "options not applied";
+    }
+    else
+    {
+        // Без дескриптора - только параметры, которые устанавливает Qt
+        if (m_tuning.noDelay) m_tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        if (m_tuning.keepAlive) m_tcpSocket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+        if (m_tuning.tos >= 0) m_tcpSocket->setSocketOption(QAbstractSocket::TypeOfServiceOption, m_tuning.tos);
+        if (m_tuning.receiveBuffer > 0) m_tcpSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, m_tuning.receiveBuffer);
+        if (m_tuning.sendBuffer > 0) m_tcpSocket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, m_tuning.sendBuffer);
+
+        m_effectiveTuning = SocketTuning::Profile();
+        m_effectiveTuning.noDelay = m_tcpSocket->socketOption(QAbstractSocket::LowDelayOption).toInt() != 0;
+        m_effectiveTuning.keepAlive = m_tcpSocket->socketOption(QAbstractSocket::KeepAliveOption).toInt() != 0;
+        m_effectiveTuning.tos = m_tcpSocket->socketOption(QAbstractSocket::TypeOfServiceOption).toInt();
+        m_effectiveTuning.receiveBuffer = m_tcpSocket->socketOption(QAbstractSocket::ReceiveBufferSizeSocketOption).toInt();
+        m_effectiveTuning.sendBuffer = m_tcpSocket->socketOption(QAbstractSocket::SendBufferSizeSocketOption).toInt();
+    }
+}
+
+bool TcpUdpTranslator::startBridge(IoEngine *engine, int connectTimeout)
+{
+    stopBridge();
+
+    if (!engine)
+    {
+        if (!m_bridgeEngine) m_bridgeEngine.reset(new IoEngine);
+        engine = m_bridgeEngine.get();
+    }
+
+    QByteArray request;
+    switch (m_apType) {
+    case AutopilotProtocol::BoardTelemetry:
+        request = sendTelemetryRequest();
+        break;
+    case AutopilotProtocol::RoutePoints:
+        request = sendRoutePointsRequest();
+        break;
+    case AutopilotProtocol::Supervisor:
+        request = sendSupervisorRequest();
+        break;
+    }
+
+    const QHostAddress group(m_udpHostIPAddr);
+
+    TcpUdpBridge::Config config;
+    config.tcpHost = QHostAddress(m_tcpServerIPAddr).toIPv4Address();
+    config.tcpPort = static_cast<uint16_t>(m_tcpServerPort);
+    config.udpHost = group.toIPv4Address();
+    config.udpPort = static_cast<uint16_t>(m_udpDstPort);
+    config.listenPort = static_cast<uint16_t>(m_udpSrcPort);
+    config.listenGroup = group.isMulticast() ? group.toIPv4Address() : 0;
+    config.connectTimeout = connectTimeout;
+    config.tuning = m_tuning;
+    config.request.assign(request.constData(), request.constData() + request.size());
+
+    m_bridge.reset(new TcpUdpBridge(*engine));
+    // Вызывается в потоке моста: сигнал отправляется из потока транслятора
+    m_bridge->setClosedCallback([=]{ QMetaObject::invokeMethod(this, [=]{ emit tcpDisconnected(); }, Qt::QueuedConnection); });
+
+    if (!m_bridge->start(config))
+    {
+        qDebug() << "Bridge: cannot connect to" << m_tcpServerIPAddr << m_tcpServerPort;
+        m_bridge.reset();
+        return false;
+    }
+
+    qDebug() << "Bridge:" << m_tcpServerIPAddr << m_tcpServerPort << "->" << m_udpHostIPAddr << m_udpDstPort
+             << "zero-copy" << m_bridge->zeroCopyActive();
+    emit tcpConnected();
+    return true;
+}
+
+void TcpUdpTranslator::stopBridge()
+{
+    if (!m_bridge) return;
+
+    m_bridge->stop();
+    m_bridge.reset();
+}
+
+bool TcpUdpTranslator::bridgeActive()
+{
+    return m_bridge && m_bridge->isRunning();
+}
+
+TcpUdpBridge::Stats TcpUdpTranslator::bridgeStats()
+{
+    return m_bridge ? m_bridge->stats() : TcpUdpBridge::Stats();
+}
+
+TcpUdpBridge::Rates TcpUdpTranslator::bridgeRates()
+{
+    return m_bridge ? m_bridge->rates() : TcpUdpBridge::Rates();
+}
+
+size_t TcpUdpTranslator::takeDatagrams(std::vector<Datagram> &out, size_t max)
+{
+    return m_udpQueue.take(out, max);
+}
+
+void TcpUdpTranslator::setUdpQueueLimits(size_t perSender, size_t senders)
+{
+    m_udpQueue.setLimits(perSender, senders);
+}
+
+DatagramQueue::Stats TcpUdpTranslator::udpQueueStats()
+{
+    return m_udpQueue.stats();
+}
+
+GroupFlight::LatencyTracker::Snapshot TcpUdpTranslator::latency()
+{
+    return m_latency.snapshot();
+}
+
+void TcpUdpTranslator::resetLatency()
+{
+    m_latency.reset();
+}
+
 void TcpUdpTranslator::connectToServer(ProtocolType type)
 {
     switch (type) {
     case ProtocolType::TCP:
-        QObject::connect(m_tcpSocket, &QTcpSocket::connected, [=]{this->slotConnected(m_apType);});
+        if (m_tcpSocket->state() != QAbstractSocket::UnconnectedState) m_tcpSocket->abort();
         m_tcpSocket->connectToHost(m_tcpServerIPAddr, m_tcpServerPort, QIODevice::ReadWrite, QAbstractSocket::IPv4Protocol);
         break;
     case ProtocolType::UDP:
-        if(startUdp())
-            QObject::connect(m_udpSocket, &QUdpSocket::readyRead, [=]{this->dataRead(ProtocolType::UDP);});
+        startUdp();
         break;
     }
 }
 
+void TcpUdpTranslator::disconnectFromServer()
+{
+    if (m_pollTimer) m_pollTimer->stop();
+    m_tcpSocket->abort();
+    m_tcpStream.clear();
+}
+
+bool TcpUdpTranslator::isConnected()
+{
+    return m_tcpSocket->state() == QAbstractSocket::ConnectedState;
+}
+
 void TcpUdpTranslator::write(ProtocolType type, QByteArray data)
 {
     switch (type) {
@@ -162,33 +366,79 @@ void TcpUdpTranslator::write(ProtocolType type, QByteArray data)
         this->m_tcpSocket->write(data);
         break;
     case ProtocolType::UDP:
-        this->m_udpSocket->writeDatagram(data, QHostAddress(m_udpHostIPAddr), m_udpDstPort);
+        if (m_udpBatchSocket >= 0)
+        {
+            // Отправка с порта приема, как и через QUdpSocket
+            const GroupFlight::PackSlice slice(0, static_cast<size_t>(data.size()));
+            BatchIo::send(m_udpBatchSocket, QHostAddress(m_udpHostIPAddr).toIPv4Address(), static_cast<uint16_t>(m_udpDstPort),
+                          data.constData(), &slice, 1);
+        }
+        else
+            udpSocket()->writeDatagram(data, QHostAddress(m_udpHostIPAddr), m_udpDstPort);
         break;
     }
 }
 
 bool TcpUdpTranslator::startUdp()
 {
-    if (!m_udpSocket) return false;
+    if (m_udpBatchSocket >= 0) return true;
+
+    const QHostAddress group("239.1.2.3");
+
+    // Linux: прием пачками recvmmsg с адресом отправителя и временем приема ядром
+    if (BatchIo::supported())
+    {
+        m_udpBatchSocket = BatchIo::open(static_cast<uint16_t>(m_udpSrcPort), group.isMulticast() ? group.toIPv4Address() : 0);
+        if (m_udpBatchSocket >= 0)
+        {
+            if (!BatchIo::enableTimestamps(m_udpBatchSocket)) qDebug() << "UDP: kernel receive timestamps are not available";
+
+            if (!m_udpPool) m_udpPool.reset(new GroupFlight::PacketBufferPool(BatchIo::k_maxBatch));
+            m_udpNotifier = new QSocketNotifier(m_udpBatchSocket, QSocketNotifier::Read, this);
+            QObject::connect(m_udpNotifier, &QSocketNotifier::activated, [=]{this->dataRead(ProtocolType::UDP);});
+            return true;
+        }
+    }
+
+    udpSocket();
 
     bool result = m_udpSocket->bind(QHostAddress::AnyIPv4, m_udpSrcPort,
                                   QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint);
 
-    if (QHostAddress("239.1.2.3").isMulticast())
+    if (group.isMulticast())
     {
         static const QVariant multiCastUDPconst(1);
 
         m_udpSocket->setSocketOption(QAbstractSocket::MulticastTtlOption, multiCastUDPconst);      //проблема с записью числа int '1'; решил её использовав статик конст QVariant со значением интовой 1
-        m_udpSocket->joinMulticastGroup(QHostAddress("239.1.2.3"));
+        m_udpSocket->joinMulticastGroup(group);
     }
 
+    if (result)
+        QObject::connect(m_udpSocket, &QUdpSocket::readyRead, [=]{this->dataRead(ProtocolType::UDP);});
+
     return result;
 }
 
+QUdpSocket *TcpUdpTranslator::udpSocket()
+{
+    if (!m_udpSocket) m_udpSocket = new QUdpSocket(this);
+    return m_udpSocket;
+}
+
 void TcpUdpTranslator::slotConnected(AutopilotProtocol prot)
 {
     qDebug() << "Received the connected() signal";
-    QObject::connect(m_tcpSocket, &QTcpSocket::readyRead, [=]{this->dataRead(ProtocolType::TCP);});
+    applySocketTuning();
+    emit tcpConnected();
+
+    m_tcpStream.clear();
+    if (m_scheduler.hasStreams())
+    {
+        m_scheduler.reset(RequestScheduler::Clock::now());
+        pollRequests();
+        return;
+    }
+
     switch (prot) {
     case AutopilotProtocol::BoardTelemetry:
         qDebug() << "Telemetry requested";
@@ -207,132 +457,276 @@ void TcpUdpTranslator::slotConnected(AutopilotProtocol prot)
 
 void TcpUdpTranslator::dataRead(ProtocolType type)
 {
-    QVariantMap map;
-    uint curPoint = 0;
-    uint totalPoints = 0;
-    QList<QVariant> tempList;
-    QVariantMap tempMap;
     QByteArray tempBa;
+    int64_t received = 0;
 
     switch (type) {
     case ProtocolType::TCP:
 
+        // Режим немедленного подтверждения ядро сбрасывает: без повторной установки ответ ждал бы delayed ACK
+        if (m_tuning.quickAck) SocketTuning::rearmQuickAck(static_cast<int>(m_tcpSocket->socketDescriptor()));
+
         tempBa = m_tcpSocket->readAll();
 
-        switch (m_apType) {
-        case AutopilotProtocol::BoardTelemetry:
+        // QTcpSocket забирает данные из сокета до readyRead: отметка ядра недоступна, время приема - время чтения
+        received = GroupFlight::wallClock();
 
-            map = MsgPack::unpack(m_tcpSocket->readAll()).toMap();
+        // Опрос по расписанию: тип ответа определяется по его ключам, а не по очереди запросов -
+        // ответ, опоздавший после истечения ожидания, не сдвигает разбор следующих
+        if (m_scheduler.hasStreams())
+        {
+            m_tcpStream.append(tempBa.constData(), static_cast<size_t>(tempBa.size()));
 
-            if (map.isEmpty()) return;
+            const char *message = nullptr;
+            size_t messageSize = 0;
+            while (m_tcpStream.next(message, messageSize))
+            {
+                AutopilotProtocol protocol = AutopilotProtocol::Supervisor;
+                switch (AutopilotMsgPack::classify(message, messageSize)) {
+                case AutopilotMsgPack::Content::Telemetry:
+                    protocol = AutopilotProtocol::BoardTelemetry;
+                    break;
+                case AutopilotMsgPack::Content::Route:
+                    protocol = AutopilotProtocol::RoutePoints;
+                    break;
+                case AutopilotMsgPack::Content::Other:
+                    break;
+                }
+
+                // Запроса этого типа не ожидается: ответ отбрасывается
+                if (!m_scheduler.complete(RequestScheduler::Clock::now(), static_cast<RequestScheduler::StreamId>(protocol)))
+                    continue;
+
+                handleMessage(protocol, message, messageSize, received);
+            }
 
-            if (!map.contains(QLatin1String("latitude")) ||
-                !map.contains(QLatin1String("longitude")) ||
-                !map.contains(QLatin1String("altitude"))) return;
+            // Ответы освободили окно ожидающих запросов
+            pollRequests();
+            return;
+        }
 
-            m_telemetry.lat = map.value("latitude").toDouble();
-            m_telemetry.lon = map.value("longitude").toDouble();
-            m_telemetry.alt = map.value("altitude").toFloat();
-            m_telemetry.pitch = GroupFlight::radToDeg(map.value("pitch").toFloat());
-            m_telemetry.roll = GroupFlight::radToDeg(map.value("roll").toFloat());
-            m_telemetry.course = GroupFlight::radToDeg(map.value("azimuth").toFloat());
-            m_telemetry.speed = map.value("speed").toFloat();
-            m_telemetry.dateTime = uint32_t(QDateTime::currentDateTime().toSecsSinceEpoch());
-            break;
+        switch (m_apType) {
+        case AutopilotProtocol::BoardTelemetry:
         case AutopilotProtocol::RoutePoints:
+        {
+            // Порция потока может содержать часть сообщения или несколько сообщений
+            m_tcpStream.append(tempBa.constData(), static_cast<size_t>(tempBa.size()));
 
-            map = MsgPack::unpack(tempBa).toMap();
-
-            if (map.isEmpty()) return;
-
-            if (!map.contains(QLatin1String("count")) ||
-                !map.contains(QLatin1String("current")) ||
-                !map.contains(QLatin1String("points"))) return;
-
-            m_route.clear();
-            curPoint = map.value("current").toUInt();
-            totalPoints = map.value("count").toUInt();
-            tempList = map.value("points").toList();
-
-            for(uint i = 0; i < (totalPoints + 1); i++)
-            {
-                tempMap = tempList.at(i).toMap();
-                m_route.push_back(GroupFlight::FlightPoint(GroupFlight::Coords(i, tempMap.value("lat").toDouble() * GroupFlight::kPi / 180,
-                                                                               tempMap.value("lon").toDouble() * GroupFlight::kPi / 180,
-                                                                               tempMap.value("alt").toDouble())));
-                if(i == 0) m_homePoint = m_route.at(0).point;
-                if(i == curPoint) m_currentPoint = m_route.at(i).point;
-            }
-            qDebug() << "Got Route";
+            const char *message = nullptr;
+            size_t messageSize = 0;
+            while (m_tcpStream.next(message, messageSize))
+                handleMessage(m_apType, message, messageSize, received);
             break;
+        }
         case AutopilotProtocol::Supervisor:
             m_ba = tempBa;
+            emit tcpReceived(m_ba);
             break;
         }
-
-        emit tcpReceived();
         break;
     case ProtocolType::UDP:
-        if (!m_udpSocket) return;
+        // Все датаграммы - в очередь takeDatagrams(); для отображения - последняя
+        if (!drainUdp(m_ba)) return;
 
-        QHostAddress sender;
-        quint16 senderPort;
-        //QByteArray data;
+        emit udpReceived(m_ba);
+        emit udpDatagramsReady(static_cast<int>(m_udpQueue.size()));
+        break;
+    }
+}
 
+bool TcpUdpTranslator::drainUdp(QByteArray &last)
+{
+    size_t received = 0;
+    Datagram datagram;
+
+    // Последняя датаграмма ставится в очередь после цикла: last копируется из нее один раз
+    Datagram newest;
+    auto hold = [&]
+    {
+        if (received > 0) m_udpQueue.push(std::move(newest));
+        newest = std::move(datagram);
+        received++;
+    };
+
+    if (m_udpBatchSocket >= 0)
+    {
+        GroupFlight::PacketBufferPool::Buffer buffers[BatchIo::k_maxBatch];
+        BatchIo::Origin origins[BatchIo::k_maxBatch];
+
+        // Остальное - при следующем уведомлении: поток датаграмм не занимает цикл событий целиком
+        static const int k_maxBatches = 16;
+
+        for (int round = 0; round < k_maxBatches; round++)
+        {
+            size_t count = 0;
+            while (count < BatchIo::k_maxBatch && (buffers[count] = m_udpPool->acquire()))
+                count++;
+
+            const int batch = BatchIo::receive(m_udpBatchSocket, buffers, origins, count);
+            if (batch <= 0) break;
+
+            for (int i = 0; i < batch; i++)
+            {
+                datagram.data.assign(buffers[i].data(), buffers[i].data() + buffers[i].size());
+                datagram.host = origins[i].host;
+                datagram.port = origins[i].port;
+                datagram.timestamp = origins[i].timestamp != 0 ? origins[i].timestamp : GroupFlight::wallClock();
+                hold();
+            }
+
+            // Очередь сокета пуста
+            if (static_cast<size_t>(batch) < count) break;
+        }
+    }
+    else if (m_udpSocket)
+    {
         while (m_udpSocket->hasPendingDatagrams())
         {
-            this->m_ba.resize(m_udpSocket->pendingDatagramSize());
-            m_udpSocket->readDatagram(this->m_ba.data(), this->m_ba.size(), &sender, &senderPort);
+            QHostAddress sender;
+            quint16 senderPort = 0;
+
+            datagram.data.resize(static_cast<size_t>(std::max<qint64>(m_udpSocket->pendingDatagramSize(), 0)));
+            const qint64 size = m_udpSocket->readDatagram(datagram.data.data(), static_cast<qint64>(datagram.data.size()),
+                                                          &sender, &senderPort);
+            if (size < 0) break;
+
+            datagram.data.resize(static_cast<size_t>(size));
+            datagram.host = sender.toIPv4Address();
+            datagram.port = senderPort;
+            datagram.timestamp = GroupFlight::wallClock();
+            hold();
         }
+    }
 
-        qDebug() << "Message from: " << sender.toString();
-        qDebug() << "Message port: " << senderPort;
-        qDebug() << "Message: " << this->m_ba;
+    if (received == 0) return false;
 
-        emit udpReceived();
+    last = QByteArray(newest.data.data(), static_cast<int>(newest.data.size()));
+    m_udpQueue.push(std::move(newest));
+    return true;
+}
+
+void TcpUdpTranslator::pollRequests()
+{
+    if (!m_scheduler.hasStreams() || m_tcpSocket->state() != QAbstractSocket::ConnectedState) return;
+
+    const RequestScheduler::Clock::time_point now = RequestScheduler::Clock::now();
+
+    m_requests.clear();
+    if (m_scheduler.poll(now, m_requests) > 0)
+        m_tcpSocket->write(m_requests.data(), static_cast<qint64>(m_requests.size()));
+
+    const RequestScheduler::Clock::time_point due = m_scheduler.nextDue();
+    if (due == RequestScheduler::Clock::time_point::max()) return;
+
+    const auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - now);
+    if (!m_pollTimer)
+    {
+        m_pollTimer = new QTimer(this);
+        m_pollTimer->setSingleShot(true);
+        m_pollTimer->setTimerType(Qt::PreciseTimer);
+        QObject::connect(m_pollTimer, &QTimer::timeout, [=]{this->pollRequests();});
+    }
+
+    m_pollTimer->start(std::max<int>(0, static_cast<int>(wait.count())));
+}
+
+void TcpUdpTranslator::handleMessage(AutopilotProtocol protocol, const char *data, size_t size, int64_t received)
+{
+    GroupFlight::Timestamps stamps;
+    stamps.wire = received;
+
+    switch (protocol) {
+    case AutopilotProtocol::BoardTelemetry:
+        if (!AutopilotMsgPack::decodeTelemetry(data, size, m_telemetry)) return;
+
+        stamps.decoded = GroupFlight::wallClock();
+        m_latency.decoded(stamps);
+
+        // Время телеметрии - время приема порции, в которой пришло сообщение, а не время разбора
+        m_telemetry.dateTime = uint32_t(received / 1000000000);
+        m_latency.delivered(stamps, GroupFlight::wallClock());
+        emit telemetryReceived(m_telemetry);
+        break;
+    case AutopilotProtocol::RoutePoints:
+    {
+        std::vector<GroupFlight::FlightPoint> route;
+        uint32_t curPoint = 0;
+        if (!AutopilotMsgPack::decodeRoute(data, size, route, curPoint)) return;
+
+        stamps.decoded = GroupFlight::wallClock();
+        m_latency.decoded(stamps);
+
+        m_route.swap(route);
+        if (!m_route.empty()) m_homePoint = m_route.front().point;
+        if (curPoint < m_route.size()) m_currentPoint = m_route[curPoint].point;
+
+        qDebug() << "Got Route";
+        m_latency.delivered(stamps, GroupFlight::wallClock());
+        emit routeReceived(m_route);
+        break;
+    }
+    case AutopilotProtocol::Supervisor:
+        m_ba = QByteArray(data, static_cast<int>(size));
+        emit tcpReceived(m_ba);
         break;
     }
 }
 
 QByteArray TcpUdpTranslator::sendTelemetryRequest()
 {
-    QJsonObject msg = {
-        { "type",       "Board" }, //GroupFlightModule
-        { "id",         4 },
-        { "protocol",   "BoardTelemetry" }  //Supervisor BoardTelemetry
-    };
-
-    QByteArray data = QJsonDocument(msg).toJson(QJsonDocument::Compact);
-    return data;
+    // Запрос не меняется: сериализуется один раз
+    static const QByteArray request = []{
+        QJsonObject msg = {
+            { "type",       "Board" }, //GroupFlightModule
+            { "id",         4 },
+            { "protocol",   "BoardTelemetry" }  //Supervisor BoardTelemetry
+        };
+
+        return QJsonDocument(msg).toJson(QJsonDocument::Compact);
+    }();
+
+    return request;
 }
 
 QByteArray TcpUdpTranslator::sendSupervisorRequest()
 {
-    QJsonObject msg = {
-        { "type",       "Board" }, //GroupFlightModule
-        { "id",         3 },
-        { "protocol",   "Supervisor" }  //Supervisor BoardTelemetry
-    };
-
-    QByteArray data = QJsonDocument(msg).toJson(QJsonDocument::Compact);
-    return data;
+    // Запрос не меняется: сериализуется один раз
+    static const QByteArray request = []{
+        QJsonObject msg = {
+            { "type",       "Board" }, //GroupFlightModule
+            { "id",         3 },
+            { "protocol",   "Supervisor" }  //Supervisor BoardTelemetry
+        };
+
+        return QJsonDocument(msg).toJson(QJsonDocument::Compact);
+    }();
+
+    return request;
 }
 
 QByteArray TcpUdpTranslator::sendRoutePointsRequest()
 {
-    QJsonObject msg = {
-        { "type",       "Board" }, //GroupFlightModule
-        { "id",         4 },
-        { "protocol",   "RoutePoints" }  //Supervisor BoardTelemetry
-    };
-
-    QByteArray data = QJsonDocument(msg).toJson(QJsonDocument::Compact);
-    return data;
+    // Запрос не меняется: сериализуется один раз
+    static const QByteArray request = []{
+        QJsonObject msg = {
+            { "type",       "Board" }, //GroupFlightModule
+            { "id",         4 },
+            { "protocol",   "RoutePoints" }  //Supervisor BoardTelemetry
+        };
+
+        return QJsonDocument(msg).toJson(QJsonDocument::Compact);
+    }();
+
+    return request;
 }
 
 TcpUdpTranslator::~TcpUdpTranslator()
 {
+    stopBridge();
     this->m_tcpSocket->close();
     qDebug() << "Close";
-    this->m_udpSocket->close();
+    if (m_udpSocket) m_udpSocket->close();
+
+    delete m_udpNotifier;
+    BatchIo::close(m_udpBatchSocket);
 }
@@ -20,9 +20,19 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QObject>
-#include <msgpack.h>
+#include <QSocketNotifier>
+#include <limits>
 #include "GroupFlightGlobal/interface.h"
 #include "GroupFlightGlobal/coords.h"
+#include "batchio.h"
+#include "datagramqueue.h"
+#include "msgpackstream.h"
+#include "requestscheduler.h"
+#include "sockettuning.h"
+#include "tcpudpbridge.h"
+
+Q_DECLARE_METATYPE(GroupFlight::Telemetry)
+Q_DECLARE_METATYPE(std::vector<GroupFlight::FlightPoint>)
 
 //! TCP или UDP
 enum class ProtocolType : uint8_t
@@ -87,7 +97,54 @@ public:
     GroupFlight::Coords currentPoint();
     std::vector<GroupFlight::FlightPoint> route();
 
+    //! \brief Опрос потока protocol раз в msec миллисекунд по общему соединению TCP (0 - без опроса)
+    //! Если опрашивается хотя бы один поток, после подключения запросы всех потоков отправляются
+    //! по расписанию, не дожидаясь ответов, а ответы разбираются по типу запроса, на который
+    //! они пришли. Без опроса после подключения отправляется один запрос типа apType()
+    void setPollPeriod(AutopilotProtocol protocol, int msec);
+    RequestScheduler::Stats pollStats(AutopilotProtocol protocol);
+
+    //! \brief Параметры сокета TCP, устанавливаемые при каждом подключении
+    //! Размеры буферов устанавливаются после подключения и не влияют на согласованный масштаб окна
+    void setSocketTuning(const SocketTuning::Profile &profile);
+    SocketTuning::Profile socketTuning();
+
+    //! \brief Действующие параметры сокета после последнего подключения
+    SocketTuning::Profile effectiveSocketTuning();
+
+    //! \brief Режим моста: поток TCP автопилота (адрес и порт TCP) пересылается получателям UDP
+    //! (IPAddress и Port UDP Host) по сообщению msgpack на датаграмму, а датаграммы, принятые на порт
+    //! UDP Client, - автопилоту. Пересылка идет в потоке engine (nullptr - собственный поток),
+    //! без разбора сообщений и без сигналов: сокеты транслятора при этом не используются.
+    //! Подключение ожидается до connectTimeout мс; после подключения отправляется запрос типа apType()
+    //! \return false, если подключиться не удалось или порты UDP Host и Client совпадают
+    bool startBridge(IoEngine *engine = nullptr, int connectTimeout = 3000);
+    void stopBridge();
+    bool bridgeActive();
+
+    //! \brief Статистика моста по направлениям; скорость - со времени предыдущего вызова bridgeRates()
+    TcpUdpBridge::Stats bridgeStats();
+    TcpUdpBridge::Rates bridgeRates();
+
+    //! \brief Принятые датаграммы UDP с отправителем, портом и временем приема (в Linux - ядром, SO_TIMESTAMPNS)
+    //! Переносит до max датаграмм в конец out; вызывается из любого потока, обычно по udpDatagramsReady()
+    //! \return количество перенесенных датаграмм
+    size_t takeDatagrams(std::vector<Datagram> &out, size_t max = std::numeric_limits<size_t>::max());
+
+    //! \brief Пределы очереди приема UDP: датаграмм на отправителя и отправителей
+    void setUdpQueueLimits(size_t perSender, size_t senders);
+    DatagramQueue::Stats udpQueueStats();
+
+    //! \brief Задержки сообщений TCP автопилота (телеметрия, маршрут) от чтения из сокета до разбора
+    //! и до отправки сигнала; время приема записывается и в Telemetry::dateTime
+    GroupFlight::LatencyTracker::Snapshot latency();
+    void resetLatency();
+
     void connectToServer(ProtocolType type);
+
+    //! \brief Разрыв соединения TCP без ожидания отправки; очередь опроса и незаконченное сообщение сбрасываются
+    void disconnectFromServer();
+    bool isConnected();
     void write(ProtocolType type, QByteArray data);
     bool startUdp();
     QByteArray sendTelemetryRequest();
@@ -95,9 +152,15 @@ public:
     QByteArray sendRoutePointsRequest();
 
 private:
+    void pollRequests();
+    void applySocketTuning();
+    void handleMessage(AutopilotProtocol protocol, const char *data, size_t size, int64_t received);
+    bool drainUdp(QByteArray &last);
+    QUdpSocket *udpSocket();
+
     QByteArray                              m_ba;
     QTcpSocket                              *m_tcpSocket;
-    QUdpSocket                              *m_udpSocket;
+    QUdpSocket                              *m_udpSocket;           // Создается при первом использовании UDP
     QString                                 m_tcpServerIPAddr;
     uint                                    m_tcpServerPort;
     QString                                 m_udpHostIPAddr;
@@ -108,14 +171,38 @@ private:
     GroupFlight::Coords                     m_homePoint;            // Точка дом
     GroupFlight::Coords                     m_currentPoint;         // Текущая точка маршрута
     AutopilotProtocol                       m_apType;
+    AutopilotMsgPack::Stream                m_tcpStream;            // Незаконченное сообщение автопилота между readyRead
+    RequestScheduler                        m_scheduler;            // Опрос нескольких потоков по одному соединению
+    QTimer                                  *m_pollTimer;           // Создается при первом опросе по расписанию
+    std::vector<char>                       m_requests;             // Запросы, отправляемые одной записью
+    SocketTuning::Profile                   m_tuning;
+    SocketTuning::Profile                   m_effectiveTuning;
+    int                                     m_udpBatchSocket;       // Прием UDP с отправителем и временем ядра (Linux)
+    QSocketNotifier                         *m_udpNotifier;
+    std::unique_ptr<GroupFlight::PacketBufferPool> m_udpPool;
+    DatagramQueue                           m_udpQueue;             // Все принятые датаграммы до takeDatagrams()
+    std::unique_ptr<IoEngine>               m_bridgeEngine;         // Поток моста, если он не задан в startBridge()
+    std::unique_ptr<TcpUdpBridge>           m_bridge;
+    GroupFlight::LatencyTracker             m_latency;              // Телеметрия и маршрут: прием -> разбор -> сигнал
 
 public slots:
     void slotConnected(AutopilotProtocol prot);
     void dataRead(ProtocolType type);
 
 signals:
-    void tcpReceived();
-    void udpReceived();
+    //! Сигналы несут принятые данные: транслятор работает в отдельном потоке,
+    //! и получатели в потоке интерфейса не обращаются к его полям
+    void tcpReceived(const QByteArray &data);
+    void udpReceived(const QByteArray &data);       // Последняя датаграмма из принятых за раз
+
+    //! Приняты датаграммы; pending - сколько их в очереди takeDatagrams()
+    void udpDatagramsReady(int pending);
+    void telemetryReceived(const GroupFlight::Telemetry &telemetry);
+    void routeReceived(const std::vector<GroupFlight::FlightPoint> &route);
+
+    //! Соединение TCP установлено; разорвано или подключиться не удалось
+    void tcpConnected();
+    void tcpDisconnected();
 };
 
 #endif // TCPUDPTRANSLATOR_H
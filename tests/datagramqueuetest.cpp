@@ -0,0 +1,85 @@
+#include <map>
+#include <vector>
+
+#include "datagramqueue.h"
+#include "tests.h"
+
+namespace
+{
+    //! Датаграмма отправителя port с номером sequence в первом байте
+    Datagram datagram(uint16_t port, uint8_t sequence)
+    {
+        Datagram result;
+        result.data.push_back(static_cast<char>(sequence));
+        result.host = 0x7f000001u;
+        result.port = port;
+        return result;
+    }
+
+    uint8_t sequence(const Datagram &value) { return static_cast<uint8_t>(value.data[0]); }
+
+    //! Частый отправитель не вытесняет остальных: take() берет по одной датаграмме от каждого по кругу
+    void fairness()
+    {
+        const char *test = "DatagramQueue.fairness";
+
+        DatagramQueue queue;
+        for (uint8_t i = 0; i < 100; i++) queue.push(datagram(1000, i));
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            queue.push(datagram(2000, i));
+            queue.push(datagram(3000, i));
+        }
+
+        std::vector<Datagram> taken;
+        check(queue.take(taken, 9) == 9, test, "batch taken");
+
+        std::map<uint16_t, std::vector<uint8_t>> bySender;
+        for (const Datagram &value: taken) bySender[value.port].push_back(sequence(value));
+        const std::vector<uint8_t> first = {0, 1, 2};
+        check(bySender[1000] == first && bySender[2000] == first && bySender[3000] == first,
+              test, "one datagram per sender per round, in order of arrival");
+
+        taken.clear();
+        queue.take(taken);
+        bool ordered = taken.size() == 97;
+        for (size_t i = 0; ordered && i < taken.size(); i++)
+            ordered = taken[i].port == 1000 && sequence(taken[i]) == i + 3;
+        check(ordered && queue.size() == 0, test, "rest of the frequent sender");
+    }
+
+    //! Переполнение вытесняет самые старые датаграммы отправителя; новые отправители сверх предела отбрасываются
+    void limits()
+    {
+        const char *test = "DatagramQueue.limits";
+
+        DatagramQueue queue(4, 2);
+        size_t rejected = 0;
+        for (uint8_t i = 0; i < 10; i++)
+            if (!queue.push(datagram(1000, i))) rejected++;
+        check(rejected == 6 && queue.size() == 4, test, "per-sender limit");
+
+        check(queue.push(datagram(2000, 0)) && !queue.push(datagram(3000, 0)), test, "senders limit");
+        check(queue.stats().dropped == 7 && queue.stats().received == 11 && queue.stats().senders == 2, test, "stats");
+
+        std::vector<Datagram> taken;
+        queue.take(taken);
+        check(taken.size() == 5 && sequence(taken[0]) == 6 && sequence(taken.back()) == 9, test, "newest kept");
+
+        // Опустевший отправитель освобождает место
+        check(queue.push(datagram(3000, 1)) && queue.stats().senders == 1, test, "empty sender released");
+
+        // Уменьшение предела вытесняет лишние датаграммы
+        for (uint8_t i = 2; i < 6; i++) queue.push(datagram(3000, i));
+        queue.setLimits(2, 2);
+        taken.clear();
+        queue.take(taken);
+        check(taken.size() == 2 && sequence(taken[0]) == 4 && sequence(taken[1]) == 5, test, "setLimits trims queues");
+    }
+}
+
+void testDatagramQueue()
+{
+    fairness();
+    limits();
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "fragmenter.h"
+#include "parser.h"
+#include "tests.h"
+
+using namespace GroupFlight;
+
+namespace
+{
+    using Clock = Reassembler::Clock;
+
+    //! Маршрут борта board из points точек: по 5 пар и разделитель на точку
+    Package route(uint32_t board, size_t points)
+    {
+        Package package(Header(DataSource::Computer, DataType::FlightByPoints, board));
+        for (size_t i = 0; i < points; i++)
+        {
+            for (uint16_t value = 0; value < 5; value++)
+                package.pairs.push_back(Pair(DataKey::PointNumber, static_cast<uint16_t>(board + i + value)));
+            package.pairs.push_back(Pair(DataKey::Separator, 0));
+        }
+        return package;
+    }
+
+    bool same(const Package &a, const Package &b)
+    {
+        if (a.header.boardNumber != b.header.boardNumber || a.header.type != b.header.type ||
+            a.pairs.size() != b.pairs.size())
+            return false;
+
+        for (size_t i = 0; i < a.pairs.size(); i++)
+            if (a.pairs[i].key != b.pairs[i].key || a.pairs[i].value != b.pairs[i].value) return false;
+        return true;
+    }
+
+    //! Фрагменты помещаются в заданный размер и собираются в исходный пакет в обратном порядке
+    void outOfOrder()
+    {
+        const char *test = "Reassembler.outOfOrder";
+
+        const Package source = route(3, 400);
+        std::vector<Package> parts;
+        const size_t count = fragment(source, 11, parts, k_minFragmentSize);
+        check(count > 4 && count == parts.size(), test, "package split into fragments");
+
+        bool fits = true;
+        for (const Package &part: parts)
+        {
+            std::vector<char> bytes;
+            if (pack(part, bytes) != PackStatus::Success || bytes.size() > k_minFragmentSize) fits = false;
+        }
+        check(fits, test, "fragments fit into maxPackageSize");
+
+        Reassembler reassembler;
+        Package result;
+        size_t completed = 0;
+        for (size_t i = parts.size(); i > 0; i--)
+            if (reassembler.add(parts[i - 1], result)) completed++;
+
+        check(completed == 1 && same(source, result), test, "reversed fragments reassembled");
+        check(reassembler.pending() == 0, test, "no pending messages left");
+    }
+
+    //! Фрагменты двух бортов вперемешку, с повтором, через PackageView
+    void interleaved()
+    {
+        const char *test = "Reassembler.interleaved";
+
+        const Package first = route(1, 300);
+        const Package second = route(2, 250);
+        std::vector<Package> firstParts;
+        std::vector<Package> secondParts;
+        fragment(first, 5, firstParts, k_minFragmentSize);
+        fragment(second, 5, secondParts, k_minFragmentSize);
+
+        std::vector<Package> stream;
+        for (size_t i = 0; i < std::max(firstParts.size(), secondParts.size()); i++)
+        {
+            if (i < secondParts.size()) stream.push_back(secondParts[secondParts.size() - 1 - i]);
+            if (i < firstParts.size()) stream.push_back(firstParts[i]);
+        }
+        stream.insert(stream.begin() + 2, firstParts[0]);
+
+        Reassembler reassembler;
+        std::vector<Package> results;
+        for (const Package &part: stream)
+        {
+            std::vector<char> bytes;
+            pack(part, bytes);
+            PackageView view;
+            if (view.parse(bytes.data(), bytes.size()) != UnpackStatus::Success) continue;
+
+            Package result;
+            if (reassembler.add(view, result)) results.push_back(result);
+        }
+
+        check(results.size() == 2, test, "both messages reassembled");
+        check(results.size() == 2 && same(first, results[0].header.boardNumber == 1 ? results[0] : results[1]) &&
+              same(second, results[0].header.boardNumber == 2 ? results[0] : results[1]), test, "pairs restored");
+        check(reassembler.stats().duplicates == 1, test, "duplicate fragment counted");
+    }
+
+    //! Сверх пределов вытесняются сообщения, дольше всех не получавшие фрагментов
+    void eviction()
+    {
+        const char *test = "Reassembler.eviction";
+
+        Reassembler reassembler(std::chrono::milliseconds(5000), 2, 3);
+        const Clock::time_point start = Clock::now();
+        Package result;
+
+        // Три сообщения борта 1 при пределе 2 на борт: первое вытесняется
+        std::vector<std::vector<Package>> board(3);
+        for (uint16_t id = 0; id < 3; id++)
+        {
+            fragment(route(1, 200), id, board[id], k_minFragmentSize);
+            reassembler.add(board[id][0], result, start + std::chrono::milliseconds(id));
+        }
+        check(reassembler.pending() == 2 && reassembler.stats().evicted == 1, test, "per-board limit");
+
+        // Остаток вытесненного сообщения не собирается: его первый фрагмент потерян
+        bool completed = false;
+        for (size_t i = 1; i < board[0].size(); i++)
+            completed = reassembler.add(board[0][i], result, start + std::chrono::milliseconds(10)) || completed;
+        check(!completed, test, "evicted message not completed");
+
+        // Предел всех сообщений: два новых борта вытесняют самые старые
+        reassembler.clear();
+        for (uint32_t number = 10; number < 15; number++)
+        {
+            std::vector<Package> parts;
+            fragment(route(number, 200), 0, parts, k_minFragmentSize);
+            reassembler.add(parts[0], result, start + std::chrono::milliseconds(number));
+        }
+        check(reassembler.pending() == 3, test, "total limit");
+
+        // Истекшие по времени сообщения удаляются
+        check(reassembler.expire(start + std::chrono::seconds(10)) == 3 && reassembler.pending() == 0,
+              test, "expired messages removed");
+    }
+
+    //! Неверные номера фрагментов не принимаются
+    void invalid()
+    {
+        const char *test = "Reassembler.invalid";
+
+        Package package(Header(DataSource::Computer, DataType::FlightByPoints, 1));
+        package.pairs.push_back(Pair(DataKey::FragmentMessageId, 1));
+        package.pairs.push_back(Pair(DataKey::FragmentIndex, 4));
+        package.pairs.push_back(Pair(DataKey::FragmentCount, 4));
+
+        Reassembler reassembler;
+        Package result;
+        check(!reassembler.add(package, result), test, "index beyond count rejected");
+
+        package.pairs[1].value = 0;
+        package.pairs[2].value = 0;
+        check(!reassembler.add(package, result), test, "zero count rejected");
+        check(reassembler.stats().invalid == 2 && reassembler.pending() == 0, test, "nothing kept");
+    }
+}
+
+void testFragmenter()
+{
+    outOfOrder();
+    interleaved();
+    eviction();
+    invalid();
+}
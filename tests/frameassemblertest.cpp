@@ -0,0 +1,143 @@
+#include <vector>
+
+#include "frameassembler.h"
+#include "parser.h"
+#include "tests.h"
+
+using namespace GroupFlight;
+
+namespace
+{
+    //! Пакет борта board с count парами; значения пар зависят от board
+    std::vector<char> packet(uint32_t board, size_t count)
+    {
+        Package package(Header(DataSource::Computer, DataType::FlightByPoints, board));
+        for (size_t i = 0; i < count; i++)
+            package.pairs.push_back(Pair(DataKey::PointNumber, static_cast<uint16_t>(board + i)));
+
+        std::vector<char> result;
+        pack(package, result);
+        return result;
+    }
+
+    //! Пакет борта board с count парами выделен без искажений
+    bool intact(const PackageView &view, uint32_t board, size_t count)
+    {
+        if (view.header().boardNumber != board || view.pairsCount() != count) return false;
+        for (size_t i = 0; i < count; i++)
+            if (view.pair(i).value != static_cast<uint16_t>(board + i)) return false;
+        return true;
+    }
+
+    //! Сборка потока порциями по chunk байт; boards - номера выделенных пакетов
+    size_t feed(FrameAssembler &assembler, const std::vector<char> &stream, size_t chunk,
+                std::vector<uint32_t> &boards, bool &ok)
+    {
+        size_t count = 0;
+        for (size_t offset = 0; offset < stream.size(); offset += chunk)
+        {
+            const size_t size = stream.size() - offset < chunk ? stream.size() - offset : chunk;
+            count += assembler.feed(stream.data() + offset, size, [&](const PackageView &view)
+            {
+                boards.push_back(view.header().boardNumber);
+                if (!intact(view, view.header().boardNumber, view.header().boardNumber % 40)) ok = false;
+            });
+        }
+        return count;
+    }
+
+    //! Пакеты разрезаны между порциями в любом месте, включая маркер и поле размера
+    void splitChunks()
+    {
+        const char *test = "FrameAssembler.splitChunks";
+
+        std::vector<char> stream;
+        for (uint32_t board = 1; board <= 60; board++)
+        {
+            const std::vector<char> bytes = packet(board, board % 40);
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+        }
+
+        for (size_t chunk: {size_t(1), size_t(2), size_t(7), size_t(100), size_t(4096)})
+        {
+            FrameAssembler assembler;
+            std::vector<uint32_t> boards;
+            bool ok = true;
+
+            check(feed(assembler, stream, chunk, boards, ok) == 60, test, "all packages extracted");
+            check(ok, test, "packages intact");
+            check(boards.size() == 60 && boards.front() == 1 && boards.back() == 60, test, "packages in order");
+            check(assembler.stats().resyncs == 0 && assembler.stats().droppedBytes == 0, test, "no resync");
+            check(assembler.buffered() == 0, test, "nothing left");
+        }
+    }
+
+    //! Битое поле размера и ложный маркер за ним не задерживают целые пакеты
+    void corruptSize()
+    {
+        const char *test = "FrameAssembler.corruptSize";
+
+        std::vector<char> stream = packet(40, 0);
+        stream[3] = static_cast<char>(0xff);     // Размер больше, чем будет принято всего
+        stream[4] = static_cast<char>(0x7f);
+
+        const char fake[] = {k_headSymbol1, k_headSymbol2, k_headSymbol3, 0x00, 0x70};
+        stream.insert(stream.end(), fake, fake + sizeof(fake));
+
+        for (uint32_t board = 1; board <= 100; board++)
+        {
+            const std::vector<char> bytes = packet(board, board % 40);
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+        }
+
+        for (size_t chunk: {size_t(37), size_t(stream.size())})
+        {
+            FrameAssembler assembler;
+            std::vector<uint32_t> boards;
+            bool ok = true;
+
+            check(feed(assembler, stream, chunk, boards, ok) == 100, test, "packages behind bad size extracted");
+            check(ok, test, "packages intact");
+            check(!boards.empty() && boards.front() == 1, test, "bad package skipped");
+            check(assembler.stats().resyncs >= 2, test, "resyncs counted");
+        }
+    }
+
+    //! Пакет с неверной контрольной суммой пропускается, соседние выделяются
+    void corruptCrc()
+    {
+        const char *test = "FrameAssembler.corruptCrc";
+
+        std::vector<char> stream;
+        size_t damaged = 0;
+        for (uint32_t board = 1; board <= 5; board++)
+        {
+            const std::vector<char> bytes = packet(board, board % 40);
+            if (board == 3) damaged = stream.size() + k_headerSize;
+            stream.insert(stream.end(), bytes.begin(), bytes.end());
+        }
+        stream[damaged] ^= 0x55;
+
+        // Мусор перед первым пакетом и в конце потока
+        const char garbage[] = {0x01, k_headSymbol1, 0x02, k_headSymbol1, k_headSymbol2};
+        stream.insert(stream.begin(), garbage, garbage + sizeof(garbage));
+        stream.insert(stream.end(), garbage, garbage + 3);
+
+        FrameAssembler assembler;
+        std::vector<uint32_t> boards;
+        bool ok = true;
+
+        check(feed(assembler, stream, 11, boards, ok) == 4, test, "good packages extracted");
+        check(ok, test, "packages intact");
+        check(boards == std::vector<uint32_t>({1, 2, 4, 5}), test, "damaged package skipped");
+        check(assembler.stats().crcErrors == 1, test, "crc error counted");
+        check(assembler.buffered() <= 2, test, "garbage dropped");
+    }
+}
+
+void testFrameAssembler()
+{
+    splitChunks();
+    corruptSize();
+    corruptCrc();
+}
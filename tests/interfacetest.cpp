@@ -0,0 +1,151 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "interface.h"
+#include "parser.h"
+#include "tests.h"
+
+using namespace GroupFlight;
+
+namespace
+{
+    //! Ожидание условия не дольше двух секунд
+    template<typename Condition>
+    bool waitFor(Condition condition)
+    {
+        for (int i = 0; i < 2000 && !condition(); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return condition();
+    }
+
+    Package route(uint32_t board)
+    {
+        return Package(Header(DataSource::Computer, DataType::FlightByPoints, board));
+    }
+
+    struct Counter : Handler
+    {
+        ErrorType setPackage(const Package &) override { calls++; return ErrorType::NoError; }
+        std::atomic<int> calls{0};
+    };
+
+    //! Асинхронный обработчик удаляет другой обработчик, пока рассылка ждет места в его очереди
+    struct Remover : Handler
+    {
+        ErrorType setPackage(const Package &) override
+        {
+            if (done) return ErrorType::NoError;
+            done = true;
+
+            waitFor([this]{ return owner->asyncStats(this).blocked > 0; });
+            owner->removeHandler(target);
+            owner->removeHandler(this);
+            return ErrorType::NoError;
+        }
+
+        Interface *owner = nullptr;
+        Handler *target = nullptr;
+        bool done = false;
+    };
+
+    void removeFromWorker()
+    {
+        const char *test = "Interface.removeFromWorker";
+
+        Interface interface;
+        Counter counter;
+        Remover remover;
+        remover.owner = &interface;
+        remover.target = &counter;
+
+        interface.addAsyncHandler(&remover, 1);
+        interface.addHandler(&counter);
+
+        // Первый пакет занимает обработчик, следующие заполняют очередь, и рассылка ждет места
+        for (uint32_t board = 0; board < 8; board++)
+            interface.setPackageToHandlers(route(board));
+
+        check(waitFor([&interface]{ return interface.handlersCount() == 0; }), test, "handlers removed");
+
+        // Поток удаленного обработчика завершается следующей рассылкой
+        const int calls = counter.calls;
+        interface.setPackageToHandlers(route(8));
+        check(calls > 0 && counter.calls == calls, test, "removed handler not called again");
+    }
+
+    //! Синхронный обработчик, долго обрабатывающий пакет
+    struct Slow : Handler
+    {
+        ErrorType setPackage(const Package &) override
+        {
+            inside = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            inside = false;
+            return ErrorType::NoError;
+        }
+
+        std::atomic<bool> inside{false};
+    };
+
+    //! Удаление из другого потока возвращается только после конца рассылки
+    void removeWaitsForDispatch()
+    {
+        const char *test = "Interface.removeWaitsForDispatch";
+
+        Interface interface;
+        Slow slow;
+        interface.addHandler(&slow);
+
+        std::thread dispatch([&interface]{ interface.setPackageToHandlers(route(1)); });
+        check(waitFor([&slow]{ return slow.inside.load(); }), test, "dispatch started");
+
+        interface.removeHandler(&slow);
+        const bool finished = !slow.inside;
+        dispatch.join();
+
+        check(finished && interface.handlersCount() == 0, test, "handler finished before removeHandler returned");
+    }
+
+    //! Задержки учитываются для каждого пакета пачки с отметками, а не по первому пакету
+    void batchLatency()
+    {
+        const char *test = "Interface.batchLatency";
+
+        Interface interface;
+        Counter counter;
+        interface.addHandler(&counter);
+
+        std::vector<std::vector<char>> bytes(3);
+        PackageView views[3];
+        for (size_t i = 0; i < 3; i++)
+        {
+            pack(route(static_cast<uint32_t>(i)), bytes[i]);
+            views[i].parse(bytes[i].data(), bytes[i].size());
+        }
+
+        // Первый пакет без отметок, второй только с отметкой разбора, третий с обеими
+        const int64_t now = wallClock();
+        Timestamps decoded;
+        decoded.decoded = now;
+        Timestamps both;
+        both.wire = now - 1000;
+        both.decoded = now;
+        views[1].setTimestamps(decoded);
+        views[2].setTimestamps(both);
+
+        Arena arena;
+        interface.setPackageBatchToHandlers(views, 3, arena);
+
+        const LatencyTracker::Snapshot latency = interface.latency();
+        check(latency.decodeToHandler.count == 2, test, "decode-to-handler for stamped packages");
+        check(latency.wireToHandler.count == 1 && latency.wireToDecode.count == 1, test, "wire latency for wire stamps");
+    }
+}
+
+void testInterface()
+{
+    removeFromWorker();
+    removeWaitsForDispatch();
+    batchLatency();
+}
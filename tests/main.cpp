@@ -0,0 +1,31 @@
+#include <cstdio>
+
+#include "tests.h"
+
+namespace
+{
+    int g_failures = 0;
+}
+
+void check(bool condition, const char *test, const char *what)
+{
+    if (condition) return;
+    fprintf(stderr, "FAIL %s: %s\n", test, what);
+    g_failures++;
+}
+
+int main()
+{
+    testRequestScheduler();
+    testFrameAssembler();
+    testSchema();
+    testFragmenter();
+    testPolicyQueue();
+    testMsgPackStream();
+    testDatagramQueue();
+    testInterface();
+
+    if (g_failures > 0) return 1;
+    printf("all tests passed\n");
+    return 0;
+}
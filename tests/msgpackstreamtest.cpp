@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "coords.h"
+#include "msgpackstream.h"
+#include "tests.h"
+
+using namespace AutopilotMsgPack;
+
+namespace
+{
+    //! Запись значений msgpack для тестовых сообщений
+    struct Writer
+    {
+        std::vector<char> data;
+
+        Writer &byte(uint8_t value) { data.push_back(static_cast<char>(value)); return *this; }
+        Writer &map(uint8_t count) { return byte(0x80 | count); }
+        Writer &array(uint8_t count) { return byte(0x90 | count); }
+        Writer &integer(uint8_t value) { return byte(value & 0x7f); }
+
+        Writer &string(const char *value)
+        {
+            const size_t size = std::strlen(value);
+            byte(0xa0 | static_cast<uint8_t>(size));
+            data.insert(data.end(), value, value + size);
+            return *this;
+        }
+
+        Writer &number(double value)
+        {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            byte(0xcb);
+            for (int shift = 56; shift >= 0; shift -= 8) byte(static_cast<uint8_t>(bits >> shift));
+            return *this;
+        }
+
+        Writer &append(const std::vector<char> &other)
+        {
+            data.insert(data.end(), other.begin(), other.end());
+            return *this;
+        }
+    };
+
+    //! Маршрут RoutePoints из points точек
+    std::vector<char> route(uint8_t points, uint8_t count, uint8_t current)
+    {
+        Writer writer;
+        writer.map(4).string("type").string("RoutePoints")
+              .string("count").integer(count)
+              .string("current").integer(current)
+              .string("points").array(points);
+
+        for (uint8_t i = 0; i < points; i++)
+            writer.map(3).string("lat").number(55.5 + i).string("lon").number(37.25 + i).string("alt").number(100 + i);
+        return writer.data;
+    }
+
+    std::vector<char> telemetry()
+    {
+        Writer writer;
+        writer.map(3).string("latitude").number(55.75).string("longitude").number(37.5).string("altitude").number(250);
+        return writer.data;
+    }
+
+    //! Все целые сообщения, выделенные из потока
+    std::vector<std::string> messages(Stream &stream)
+    {
+        std::vector<std::string> result;
+        const char *data = nullptr;
+        size_t size = 0;
+        while (stream.next(data, size)) result.push_back(std::string(data, size));
+        return result;
+    }
+
+    std::string text(const std::vector<char> &data) { return std::string(data.begin(), data.end()); }
+
+    //! Сообщения разрезаны между порциями в любом месте
+    void streamChunks()
+    {
+        const char *test = "MsgPack.Stream.chunks";
+
+        const std::vector<char> first = route(3, 2, 1);
+        const std::vector<char> second = telemetry();
+        const std::vector<char> third = Writer().array(2).integer(1).string("x").data;
+        const std::vector<char> all = Writer().append(first).append(second).append(third).data;
+
+        for (size_t chunk: {size_t(1), size_t(3), size_t(17), all.size()})
+        {
+            Stream stream;
+            std::vector<std::string> result;
+            for (size_t offset = 0; offset < all.size(); offset += chunk)
+            {
+                stream.append(all.data() + offset, std::min(chunk, all.size() - offset));
+                const std::vector<std::string> part = messages(stream);
+                result.insert(result.end(), part.begin(), part.end());
+            }
+
+            check(result.size() == 3 && result[0] == text(first) && result[1] == text(second) && result[2] == text(third),
+                  test, "messages restored");
+            check(stream.pending() == 0 && stream.skipped() == 0, test, "nothing left or skipped");
+        }
+    }
+
+    //! Незаконченное сообщение ждет продолжения и не выдается
+    void streamTruncated()
+    {
+        const char *test = "MsgPack.Stream.truncated";
+
+        const std::vector<char> message = route(2, 1, 0);
+        Stream stream;
+        stream.append(message.data(), message.size() - 1);
+        check(messages(stream).empty() && stream.pending() == message.size() - 1, test, "partial message kept");
+
+        stream.append(message.data() + message.size() - 1, 1);
+        const std::vector<std::string> result = messages(stream);
+        check(result.size() == 1 && result[0] == text(message), test, "completed by the last byte");
+    }
+
+    //! Поврежденные данные пропускаются до следующего словаря или массива
+    void streamGarbage()
+    {
+        const char *test = "MsgPack.Stream.garbage";
+
+        const std::vector<char> message = telemetry();
+        Writer writer;
+        writer.byte(0xc1).byte(0xc1).integer(5).string("noise").byte(0xc1).append(message).byte(0xc1).append(message);
+
+        Stream stream;
+        stream.append(writer.data.data(), writer.data.size());
+        const std::vector<std::string> result = messages(stream);
+
+        check(result.size() == 2 && result[0] == text(message) && result[1] == text(message), test, "messages found");
+        check(stream.skipped() == writer.data.size() - 2 * message.size(), test, "garbage bytes counted");
+    }
+
+    //! Framer: NeedMore на каждом префиксе, Ok с длиной на целом сообщении
+    void framerPrefixes()
+    {
+        const char *test = "MsgPack.Framer.prefixes";
+
+        const std::vector<char> message = Writer().append(route(4, 3, 2)).integer(7).data;
+        const size_t size = message.size() - 1;
+
+        Framer framer;
+        bool needMore = true;
+        size_t length = 0;
+        for (size_t prefix = 0; prefix < size; prefix++)
+            if (framer.next(message.data(), prefix, length) != Status::NeedMore) needMore = false;
+
+        check(needMore, test, "NeedMore for every prefix");
+        check(framer.next(message.data(), message.size(), length) == Status::Ok && length == size,
+              test, "length of the whole message");
+    }
+
+    void framerErrors()
+    {
+        const char *test = "MsgPack.Framer.errors";
+
+        const char reserved[] = {char(0xc1)};
+        Framer framer;
+        size_t length = 0;
+        check(framer.next(reserved, sizeof(reserved), length) == Status::Error, test, "reserved byte");
+
+        // После ошибки скаляр или пустой словарь не считается началом сообщения
+        const char scalar[] = {0x05};
+        const char empty[] = {char(0x80)};
+        check(framer.next(scalar, sizeof(scalar), length) == Status::Error, test, "scalar while resyncing");
+        check(framer.next(empty, sizeof(empty), length) == Status::Error, test, "empty map while resyncing");
+
+        const std::vector<char> message = telemetry();
+        check(framer.next(message.data(), message.size(), length) == Status::Ok && length == message.size(),
+              test, "map accepted after resync");
+
+        // Длина строки больше k_maxMessageSize - ошибка сразу, а не ожидание данных
+        const char huge[] = {char(0x91), char(0xdb), 0x7f, char(0xff), char(0xff), char(0xff)};
+        check(framer.next(huge, sizeof(huge), length) == Status::Error, test, "oversized message");
+    }
+
+    //! decodeRoute: count + 1 точка, градусы переводятся в радианы
+    void routeDecoded()
+    {
+        const char *test = "MsgPack.decodeRoute.decoded";
+
+        const std::vector<char> message = route(5, 3, 2);
+        std::vector<GroupFlight::FlightPoint> points;
+        uint32_t current = 0;
+        check(decodeRoute(message.data(), message.size(), points, current), test, "route decoded");
+        check(points.size() == 4 && current == 2, test, "count + 1 points and current");
+
+        bool exact = points.size() == 4;
+        for (size_t i = 0; exact && i < points.size(); i++)
+        {
+            const GroupFlight::Coords &point = points[i].point;
+            exact = point.num == i && std::fabs(point.lat - GroupFlight::degToRad(55.5 + i)) < 1e-12 &&
+                    std::fabs(point.lon - GroupFlight::degToRad(37.25 + i)) < 1e-12 && point.alt == 100.f + i;
+        }
+        check(exact, test, "points converted to radians");
+    }
+
+    //! Обрезанное сообщение не разбирается ни на одном префиксе
+    void routeTruncated()
+    {
+        const char *test = "MsgPack.decodeRoute.truncated";
+
+        const std::vector<char> message = route(3, 2, 1);
+        bool rejected = true;
+        for (size_t prefix = 0; prefix < message.size(); prefix++)
+        {
+            std::vector<GroupFlight::FlightPoint> points;
+            uint32_t current = 0;
+            const std::vector<char> copy(message.begin(), message.begin() + prefix);
+            if (decodeRoute(copy.data(), copy.size(), points, current)) rejected = false;
+        }
+        check(rejected, test, "every prefix rejected");
+    }
+
+    void routeGarbage()
+    {
+        const char *test = "MsgPack.decodeRoute.garbage";
+
+        std::vector<GroupFlight::FlightPoint> points;
+        uint32_t current = 0;
+
+        const std::vector<char> notMap = Writer().array(1).integer(1).data;
+        check(!decodeRoute(notMap.data(), notMap.size(), points, current), test, "not a map");
+
+        const std::vector<char> numberKey = Writer().map(1).integer(1).integer(2).data;
+        check(!decodeRoute(numberKey.data(), numberKey.size(), points, current), test, "non-string key");
+
+        const std::vector<char> missing = Writer().map(2).string("count").integer(1).string("current").integer(0).data;
+        check(!decodeRoute(missing.data(), missing.size(), points, current), test, "points missing");
+
+        const std::vector<char> badPoint = Writer().map(3).string("count").integer(1).string("current").integer(0)
+                .string("points").array(1).string("lat").data;
+        check(!decodeRoute(badPoint.data(), badPoint.size(), points, current), test, "point is not a map");
+
+        const std::vector<char> badNumber = Writer().map(3).string("count").integer(0).string("current").integer(0)
+                .string("points").array(1).map(1).string("lat").string("north").data;
+        check(!decodeRoute(badNumber.data(), badNumber.size(), points, current), test, "latitude is not a number");
+
+        // Заголовок массива обещает больше точек, чем есть в сообщении
+        const std::vector<char> header = Writer().map(3).string("count").integer(1).string("current").integer(0)
+                .string("points").byte(0xdd).byte(0xff).byte(0xff).byte(0xff).byte(0xff).data;
+        check(!decodeRoute(header.data(), header.size(), points, current), test, "huge points header");
+
+        const std::vector<char> reserved = Writer().map(1).string("count").byte(0xc1).data;
+        check(!decodeRoute(reserved.data(), reserved.size(), points, current), test, "reserved byte");
+    }
+}
+
+void testMsgPackStream()
+{
+    streamChunks();
+    streamTruncated();
+    streamGarbage();
+    framerPrefixes();
+    framerErrors();
+    routeDecoded();
+    routeTruncated();
+    routeGarbage();
+}
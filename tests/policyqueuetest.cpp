@@ -0,0 +1,131 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "policyqueue.h"
+#include "tests.h"
+
+using namespace GroupFlight;
+
+namespace
+{
+    //! Все элементы очереди по порядку
+    std::vector<int> drain(PolicyQueue<int> &queue)
+    {
+        std::vector<int> result;
+        int value = 0;
+        while (queue.pop(value)) result.push_back(value);
+        return result;
+    }
+
+    //! Ожидание, пока писатель не начнет ждать места в очереди
+    bool waitBlocked(const PolicyQueue<int> &queue, uint64_t blocked)
+    {
+        for (int i = 0; i < 2000 && queue.stats().blocked < blocked; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return queue.stats().blocked >= blocked;
+    }
+
+    void dropNewest()
+    {
+        const char *test = "PolicyQueue.dropNewest";
+
+        PolicyQueue<int> queue(3, QueuePolicy::DropNewest);
+        for (int i = 0; i < 5; i++) queue.push(int(i), true);
+
+        check(drain(queue) == std::vector<int>({0, 1, 2}), test, "newest values dropped");
+        check(queue.stats().dropped == 2 && queue.stats().queued == 3, test, "stats");
+    }
+
+    void dropOldest()
+    {
+        const char *test = "PolicyQueue.dropOldest";
+
+        PolicyQueue<int> queue(3, QueuePolicy::DropOldest);
+        for (int i = 0; i < 5; i++) queue.push(int(i), true);
+
+        check(drain(queue) == std::vector<int>({2, 3, 4}), test, "oldest values dropped");
+        check(queue.stats().dropped == 2 && queue.stats().queued == 5, test, "stats");
+    }
+
+    void coalesce()
+    {
+        const char *test = "PolicyQueue.coalesceLatestPerBoard";
+
+        PolicyQueue<int> queue(3, QueuePolicy::CoalesceLatestPerBoard);
+        queue.push(10, true, 1);
+        queue.push(20, true, 2);
+        queue.push(11, true, 1);
+        queue.push(12, true, 1);
+        check(drain(queue) == std::vector<int>({12, 20}), test, "latest value per board kept in place");
+        check(queue.stats().coalesced == 2, test, "coalesced counted");
+
+        // Без совпадающего борта полная очередь вытесняет самый старый элемент
+        for (uint32_t board = 1; board <= 4; board++) queue.push(int(board), true, board);
+        check(drain(queue) == std::vector<int>({2, 3, 4}), test, "oldest board dropped when full");
+    }
+
+    void block()
+    {
+        const char *test = "PolicyQueue.block";
+
+        PolicyQueue<int> queue(2, QueuePolicy::Block);
+        queue.push(0, true);
+        queue.push(1, true);
+
+        bool pushed = false;
+        std::thread writer([&]{ pushed = queue.push(2, true); });
+        const bool blocked = waitBlocked(queue, 1);
+        int value = -1;
+        queue.pop(value);
+        writer.join();
+
+        check(blocked && pushed && value == 0, test, "writer waits for space");
+        check(drain(queue) == std::vector<int>({1, 2}), test, "nothing dropped");
+
+        // close() освобождает ждущего писателя, элемент отбрасывается
+        queue.push(3, true);
+        queue.push(4, true);
+        std::thread closing([&]{ pushed = queue.push(5, true); });
+        waitBlocked(queue, 2);
+        queue.close();
+        closing.join();
+        check(!pushed && drain(queue) == std::vector<int>({3, 4}), test, "close releases writer");
+    }
+
+    //! Невытесняемые элементы не теряются при любой политике и читаются первыми
+    void lossless()
+    {
+        const char *test = "PolicyQueue.lossless";
+
+        PolicyQueue<int> queue(1, QueuePolicy::DropNewest, 2);
+        queue.push(100, true);
+        queue.push(101, true);
+        queue.push(1, false);
+        queue.push(2, false);
+
+        bool pushed = false;
+        std::thread writer([&]{ pushed = queue.push(3, false); });
+        const bool blocked = waitBlocked(queue, 1);
+        int value = -1;
+        queue.popLossless(value);
+        writer.join();
+
+        check(blocked && pushed && value == 1, test, "lossless writer waits for space");
+        check(drain(queue) == std::vector<int>({2, 3, 100}), test, "lossless values first");
+
+        PolicyQueue<int> dropping(1, QueuePolicy::DropOldest, 2, false);
+        for (int i = 0; i < 3; i++) dropping.push(int(i), false);
+        check(drain(dropping) == std::vector<int>({0, 1}) && dropping.stats().dropped == 1,
+              test, "dropped without blockLossless");
+    }
+}
+
+void testPolicyQueue()
+{
+    dropNewest();
+    dropOldest();
+    coalesce();
+    block();
+    lossless();
+}
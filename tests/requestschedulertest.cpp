@@ -0,0 +1,87 @@
+#include <vector>
+
+#include "requestscheduler.h"
+#include "tests.h"
+
+namespace
+{
+    const RequestScheduler::StreamId k_telemetry = 1;
+    const RequestScheduler::StreamId k_route = 2;
+
+    //! Ответ на телеметрию опоздал: ожидание истекло, пока шел следующий запрос маршрута
+    void lateReplyAfterTimeout()
+    {
+        const char *test = "lateReplyAfterTimeout";
+        using std::chrono::milliseconds;
+
+        RequestScheduler scheduler(4, milliseconds(100));
+        scheduler.setStream(k_telemetry, "t", 1, milliseconds(1000));
+        scheduler.setStream(k_route, "r", 1, milliseconds(1000));
+
+        const RequestScheduler::Clock::time_point start = RequestScheduler::Clock::now();
+        scheduler.reset(start);
+
+        std::vector<char> out;
+        check(scheduler.poll(start, out) == 2, test, "both streams sent");
+
+        // Ожидание обоих ответов истекло
+        const RequestScheduler::Clock::time_point expired = start + milliseconds(150);
+        out.clear();
+        scheduler.poll(expired, out);
+        check(scheduler.outstanding() == 0, test, "expired requests released");
+        check(scheduler.stats(k_telemetry).timedOut == 1, test, "telemetry timed out");
+
+        // Опоздавший ответ отбрасывается и не занимает место ответа на новый запрос
+        check(!scheduler.complete(expired, k_telemetry), test, "late reply dropped");
+        check(scheduler.stats(k_telemetry).late == 1, test, "late reply counted");
+
+        // Новый раунд: телеметрия, затем маршрут; ответы сопоставляются по потоку
+        const RequestScheduler::Clock::time_point next = start + milliseconds(1000);
+        out.clear();
+        check(scheduler.poll(next, out) == 2, test, "next round sent");
+        check(out.size() == 2 && out[0] == 't' && out[1] == 'r', test, "request order");
+
+        // Автопилот пропустил телеметрию: ответ на маршрут не разбирается как телеметрия
+        RequestScheduler::Clock::duration latency;
+        check(scheduler.complete(next + milliseconds(5), k_route, &latency), test, "route matched");
+        check(latency == milliseconds(5), test, "route latency");
+        check(scheduler.stats(k_route).completed == 1, test, "route completed");
+        check(scheduler.stats(k_telemetry).timedOut == 2, test, "skipped telemetry lost");
+        check(scheduler.outstanding() == 0, test, "older requests released");
+
+        check(!scheduler.complete(next + milliseconds(6), k_telemetry), test, "telemetry after its slot dropped");
+        check(scheduler.stats(k_telemetry).completed == 0, test, "no telemetry completed");
+    }
+
+    //! Ответы по порядку запросов: каждый сопоставляется своему запросу
+    void inOrderReplies()
+    {
+        const char *test = "inOrderReplies";
+        using std::chrono::milliseconds;
+
+        RequestScheduler scheduler(4, milliseconds(100));
+        scheduler.setStream(k_telemetry, "t", 1, milliseconds(10));
+
+        const RequestScheduler::Clock::time_point start = RequestScheduler::Clock::now();
+        scheduler.reset(start);
+
+        std::vector<char> out;
+        scheduler.poll(start, out);
+        scheduler.poll(start + milliseconds(10), out);
+        check(scheduler.outstanding() == 2, test, "two requests pending");
+
+        RequestScheduler::Clock::duration latency;
+        check(scheduler.complete(start + milliseconds(12), k_telemetry, &latency), test, "first matched");
+        check(latency == milliseconds(12), test, "first latency from first request");
+        check(scheduler.complete(start + milliseconds(13), k_telemetry, &latency), test, "second matched");
+        check(latency == milliseconds(3), test, "second latency from second request");
+        check(!scheduler.complete(start + milliseconds(14), k_telemetry), test, "nothing pending");
+        check(scheduler.stats(k_telemetry).timedOut == 0, test, "nothing lost");
+    }
+}
+
+void testRequestScheduler()
+{
+    lateReplyAfterTimeout();
+    inOrderReplies();
+}
@@ -0,0 +1,183 @@
+#include <cmath>
+#include <vector>
+
+#include "parser.h"
+#include "tests.h"
+
+using namespace GroupFlight;
+
+namespace
+{
+    //! Координаты передаются с точностью 1e-7 градуса
+    bool near(double a, double b) { return std::fabs(a - b) < 1e-6; }
+
+    //! \brief Структура -> пары -> структура: из вектора пар и из принятого пакета (PackageView)
+    template<typename T>
+    bool roundTrip(const T &value, T &fromVector, T &fromView)
+    {
+        std::vector<Pair> pairs;
+        toPairs(value, pairs);
+        fromPairs(pairs, fromVector);
+
+        std::vector<char> bytes;
+        if (pack(Package(Header(DataSource::Computer, DataType::SelfId, 7), pairs), bytes) != PackStatus::Success)
+            return false;
+
+        PackageView view;
+        if (view.parse(bytes.data(), bytes.size()) != UnpackStatus::Success) return false;
+        fromPairs(view, fromView);
+        return true;
+    }
+
+    bool same(const Coords &a, const Coords &b, bool altitude = true)
+    {
+        return a.num == b.num && near(a.lat, b.lat) && near(a.lon, b.lon) && (!altitude || a.alt == b.alt);
+    }
+
+    bool same(const std::vector<FlightPoint> &a, const std::vector<FlightPoint> &b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++)
+            if (!same(a[i].point, b[i].point) || a[i].holdRadius != b[i].holdRadius || a[i].holdTime != b[i].holdTime)
+                return false;
+        return true;
+    }
+
+    bool same(const std::vector<Coords> &a, const std::vector<Coords> &b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++)
+            if (!same(a[i], b[i])) return false;
+        return true;
+    }
+
+    //! Высота точек области не передается: она равна высоте области
+    template<typename Area>
+    bool samePoints(const Area &a, const Area &b)
+    {
+        if (a.points.size() != b.points.size()) return false;
+        for (size_t i = 0; i < a.points.size(); i++)
+            if (!same(a.points[i], b.points[i], false) || b.points[i].alt != b.altitude) return false;
+        return true;
+    }
+
+    bool same(const AreaAfs &a, const AreaAfs &b)
+    {
+        return samePoints(a, b) && a.altitude == b.altitude && a.crossOverlap == b.crossOverlap
+                && a.alongOverlap == b.alongOverlap && a.resolution == b.resolution;
+    }
+
+    bool same(const AreaRln &a, const AreaRln &b)
+    {
+        return samePoints(a, b) && a.altitude == b.altitude && a.overlap == b.overlap
+                && a.distance == b.distance && a.format == b.format;
+    }
+
+    bool same(const ShootPoint &a, const ShootPoint &b)
+    {
+        return near(a.point.lat, b.point.lat) && near(a.point.lon, b.point.lon) && a.point.alt == b.point.alt
+                && a.focalLength == b.focalLength && a.flyAround == b.flyAround;
+    }
+
+    bool same(const TrackerEnable &a, const TrackerEnable &b)
+    {
+        return a.x == b.x && a.y == b.y && a.enable == b.enable;
+    }
+
+    bool same(const GroupMode &a, const GroupMode &b)
+    {
+        return a.mode == b.mode && a.master == b.master && a.distancingX == b.distancingX
+                && a.distancingY == b.distancingY && a.distancingZ == b.distancingZ;
+    }
+
+    bool same(const SelfId &a, const SelfId &b)
+    {
+        return a.number == b.number && a.type == b.type;
+    }
+
+    bool same(const Telemetry &a, const Telemetry &b)
+    {
+        return near(a.lat, b.lat) && near(a.lon, b.lon) && a.alt == b.alt && a.pitch == b.pitch && a.roll == b.roll
+                && a.course == b.course && a.speed == b.speed && a.flightTimeLeft == b.flightTimeLeft
+                && a.groupFlightStatus == b.groupFlightStatus && a.dateTime == b.dateTime
+                && a.boardStatus == b.boardStatus && a.currentPoint == b.currentPoint;
+    }
+
+    bool same(const NetworkParams &a, const NetworkParams &b)
+    {
+        return a.portIn == b.portIn && a.portOut == b.portOut && a.host == b.host;
+    }
+
+    bool same(const ManualControl &a, const ManualControl &b)
+    {
+        return a.moveLeft == b.moveLeft && a.moveRight == b.moveRight && a.moveUp == b.moveUp
+                && a.holdCourse == b.holdCourse && a.course == b.course && a.currentPoint == b.currentPoint;
+    }
+
+    template<typename T>
+    void checkRoundTrip(const char *test, const T &value)
+    {
+        T fromVector;
+        T fromView;
+        check(roundTrip(value, fromVector, fromView), test, "package packed and parsed");
+        check(same(value, fromVector), test, "decoded from pairs");
+        check(same(value, fromView), test, "decoded from PackageView");
+    }
+
+    std::vector<Coords> area()
+    {
+        return {Coords(1, 0.9712345, 0.6512345, 0.f), Coords(2, -0.5, -2.25, 0.f), Coords(3, 1.25, 3.0000001, 0.f)};
+    }
+
+    void roundTrips()
+    {
+        std::vector<FlightPoint> route;
+        for (uint16_t i = 0; i < 12; i++)
+            route.push_back(FlightPoint(i, 0.97 + i * 1e-4, 0.65 - i * 1e-4, 100.f + i, 50 + i, i));
+        checkRoundTrip("Schema.route", route);
+        checkRoundTrip("Schema.emptyRoute", std::vector<FlightPoint>());
+
+        std::vector<Coords> points = {Coords(0, 0.5, 0.25, -12.f), Coords(1, -1.5, 2.75, 300.f)};
+        checkRoundTrip("Schema.points", points);
+
+        checkRoundTrip("Schema.areaAfs", AreaAfs(area(), 250.f, 60, 70, 5));
+        checkRoundTrip("Schema.areaRln", AreaRln(area(), -20.f, 30, 1200, 1));
+        checkRoundTrip("Schema.shootPoint", ShootPoint(Coords(0.97, 0.65, 45.f), 300, 150));
+        checkRoundTrip("Schema.trackerEnable", TrackerEnable(640, 480, true));
+        checkRoundTrip("Schema.groupMode", GroupMode(GroupModeKey::Disabled, true, -150, 20, 300));
+        checkRoundTrip("Schema.selfId", SelfId(4321, 7));
+
+        Telemetry telemetry = Telemetry();
+        telemetry.lat = 0.9712345;
+        telemetry.lon = -0.6512345;
+        telemetry.alt = 512.f;
+        telemetry.pitch = -12.5f;
+        telemetry.roll = 30.5f;
+        telemetry.course = 359.5f;
+        telemetry.speed = 42.f;
+        telemetry.flightTimeLeft = 95;
+        telemetry.groupFlightStatus = 3;
+        telemetry.dateTime = 1760000000u;
+        telemetry.boardStatus = 2;
+        telemetry.currentPoint = 17;
+        checkRoundTrip("Schema.telemetry", telemetry);
+
+        NetworkParams params = NetworkParams();
+        params.portIn = 5000;
+        params.portOut = 5001;
+        params.host = 0xc0a80102u;
+        checkRoundTrip("Schema.networkParams", params);
+
+        ManualControl control;
+        control.moveRight = true;
+        control.holdCourse = true;
+        control.course = 270;
+        control.currentPoint = 9;
+        checkRoundTrip("Schema.manualControl", control);
+    }
+}
+
+void testSchema()
+{
+    roundTrips();
+}
@@ -0,0 +1,17 @@
+#ifndef TESTS_H
+#define TESTS_H
+
+//! \brief Проверка условия; при ошибке печатаются имена теста и проверки, а итог теста - неудача
+void check(bool condition, const char *test, const char *what);
+
+//! Тесты модулей: каждый вызывает check() для своих проверок
+void testRequestScheduler();
+void testFrameAssembler();
+void testSchema();
+void testFragmenter();
+void testPolicyQueue();
+void testMsgPackStream();
+void testDatagramQueue();
+void testInterface();
+
+#endif // TESTS_H
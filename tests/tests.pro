@@ -0,0 +1,28 @@
+CONFIG += c++14 console
+CONFIG -= app_bundle qt
+
+TARGET = gftests
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../datagramqueue.cpp \
+    ../msgpackstream.cpp \
+    ../requestscheduler.cpp \
+    datagramqueuetest.cpp \
+    frameassemblertest.cpp \
+    fragmentertest.cpp \
+    interfacetest.cpp \
+    main.cpp \
+    msgpackstreamtest.cpp \
+    policyqueuetest.cpp \
+    requestschedulertest.cpp \
+    schematest.cpp
+
+HEADERS += \
+    ../datagramqueue.h \
+    ../msgpackstream.h \
+    ../requestscheduler.h \
+    tests.h
+
+include(../GroupFlightGlobal/GroupFlightGlobal.pri)
@@ -0,0 +1,621 @@
+#include "uringengine.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#if defined(IORING_RECV_MULTISHOT) && defined(IORING_SETUP_SUBMIT_ALL)
+#define URINGENGINE_IO_URING
+#endif
+#endif
+#endif
+
+#ifdef URINGENGINE_IO_URING
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef URINGENGINE_IO_URING
+
+namespace
+{
+    static const unsigned k_ringEntries = 256;  // Заявок в очереди
+    static const size_t k_sendSlots = 256;      // Датаграмм в очереди отправки
+    static const uint16_t k_bufferGroup = 0;
+
+    // Старшие 32 бита user_data - операция, младшие - сокет или место в очереди отправки
+    enum Operation : uint64_t
+    {
+        Receive = 1,
+        Send = 2,
+        Wake = 3,
+        Cancel = 4
+    };
+
+    inline uint64_t userData(Operation operation, uint32_t value)
+    {
+        return (static_cast<uint64_t>(operation) << 32) | value;
+    }
+
+    inline Operation operationOf(uint64_t data) { return static_cast<Operation>(data >> 32); }
+    inline uint32_t valueOf(uint64_t data) { return static_cast<uint32_t>(data); }
+
+    int ringSetup(unsigned entries, io_uring_params *params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ringEnter(int fd, unsigned submit, unsigned wait, unsigned flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+    }
+
+    int ringRegister(int fd, unsigned opcode, void *argument, unsigned count)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, argument, count));
+    }
+} // namespace
+
+// Кольца io_uring, кольцо предоставленных буферов и места очереди отправки
+struct UringEngine::Ring
+{
+    ~Ring()
+    {
+        if (bufferRing) free(bufferRing);
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (rings != MAP_FAILED) munmap(rings, ringsSize);
+        if (fd >= 0) close(fd);
+    }
+
+    bool setup(size_t buffersCount, size_t bufferSize);
+
+    // Свободная заявка; передается ядру вызовом push() и submit()
+    io_uring_sqe *acquire()
+    {
+        const unsigned tail = *sqTail;
+        if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+        {
+            submit();
+            if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) return nullptr;
+        }
+
+        io_uring_sqe *sqe = &sqes[tail & sqMask];
+        memset(sqe, 0, sizeof(io_uring_sqe));
+        return sqe;
+    }
+
+    void push()
+    {
+        const unsigned tail = *sqTail;
+        sqArray[tail & sqMask] = tail & sqMask;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        pending++;
+    }
+
+    int submit()
+    {
+        if (pending == 0) return 0;
+
+        int result;
+        do
+            result = ringEnter(fd, pending, 0, 0);
+        while (result < 0 && errno == EINTR);
+
+        if (result > 0) pending -= static_cast<unsigned>(result);
+        return result;
+    }
+
+    // Возврат буфера приема в кольцо; ядро увидит его после publish()
+    void recycle(uint16_t id)
+    {
+        io_uring_buf &buffer = bufferRing[bufferTail & bufferMask];
+        buffer.addr = reinterpret_cast<uint64_t>(memory.data() + id * bufferSize);
+        buffer.len = static_cast<uint32_t>(bufferSize);
+        buffer.bid = id;
+        bufferTail++;
+    }
+
+    // Хвост кольца совмещен с полем resv первого элемента (io_uring_buf_ring::tail)
+    void publish() { __atomic_store_n(&bufferRing[0].resv, bufferTail, __ATOMIC_RELEASE); }
+
+    const char *buffer(uint16_t id) const { return memory.data() + id * bufferSize; }
+
+    int fd = -1;
+
+    void *rings = MAP_FAILED;
+    size_t ringsSize = 0;
+    io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned *sqHead = nullptr;
+    unsigned *sqTail = nullptr;
+    unsigned *sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned pending = 0;
+
+    unsigned *cqHead = nullptr;
+    unsigned *cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe *cqes = nullptr;
+
+    // Не io_uring_buf_ring: в C++ гибкий массив bufs объявлен со смещением
+    io_uring_buf *bufferRing = nullptr;
+    unsigned bufferMask = 0;
+    uint16_t bufferTail = 0;
+    size_t bufferSize = 0;
+    std::vector<char> memory;
+
+    // Место очереди отправки: данные и заголовок живут до завершения операции
+    struct SendSlot
+    {
+        msghdr message;
+        iovec vector;
+        sockaddr_in address;
+        std::vector<char> data;
+    };
+
+    std::vector<SendSlot> slots;
+    std::vector<uint32_t> freeSlots;
+
+    // Операции в ядре (прием и отправка), завершения которых еще не получены
+    size_t outstanding = 0;
+};
+
+bool UringEngine::Ring::setup(size_t buffersCount, size_t size)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SUBMIT_ALL;
+
+    fd = ringSetup(k_ringEntries, &params);
+    if (fd < 0) return false;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) return false;
+
+    const size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    const size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ringsSize = sqSize > cqSize ? sqSize : cqSize;
+
+    rings = mmap(nullptr, ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (rings == MAP_FAILED) return false;
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                            MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    if (sqes == MAP_FAILED) return false;
+
+    char *base = static_cast<char *>(rings);
+    sqHead = reinterpret_cast<unsigned *>(base + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned *>(base + params.sq_off.tail);
+    sqArray = reinterpret_cast<unsigned *>(base + params.sq_off.array);
+    sqMask = *reinterpret_cast<unsigned *>(base + params.sq_off.ring_mask);
+    sqEntries = params.sq_entries;
+    cqHead = reinterpret_cast<unsigned *>(base + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned *>(base + params.cq_off.tail);
+    cqMask = *reinterpret_cast<unsigned *>(base + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe *>(base + params.cq_off.cqes);
+
+    // Многократный recv появился в ядре 6.0 вместе с IORING_OP_SEND_ZC
+    const unsigned opsCount = 256;
+    std::vector<char> probeMemory(sizeof(io_uring_probe) + opsCount * sizeof(io_uring_probe_op), 0);
+    io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(probeMemory.data());
+    if (ringRegister(fd, IORING_REGISTER_PROBE, probe, opsCount) < 0) return false;
+    if (probe->ops_len <= IORING_OP_SEND_ZC || !(probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED))
+        return false;
+
+    // Кольцо предоставленных буферов: размер - степень двойки
+    unsigned entries = 1;
+    while (entries < buffersCount && entries < 32768) entries <<= 1;
+
+    void *ringMemory = nullptr;
+    if (posix_memalign(&ringMemory, static_cast<size_t>(sysconf(_SC_PAGESIZE)), entries * sizeof(io_uring_buf)) != 0)
+        return false;
+    memset(ringMemory, 0, entries * sizeof(io_uring_buf));
+    bufferRing = static_cast<io_uring_buf *>(ringMemory);
+    bufferMask = entries - 1;
+    bufferSize = size;
+    memory.resize(entries * bufferSize);
+
+    io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(bufferRing);
+    registration.ring_entries = entries;
+    registration.bgid = k_bufferGroup;
+    if (ringRegister(fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) return false;
+
+    for (unsigned i = 0; i < entries; i++)
+        recycle(static_cast<uint16_t>(i));
+    publish();
+
+    slots.resize(k_sendSlots);
+    freeSlots.reserve(k_sendSlots);
+    for (size_t i = k_sendSlots; i > 0; i--)
+        freeSlots.push_back(static_cast<uint32_t>(i - 1));
+
+    return true;
+}
+
+#else
+
+struct UringEngine::Ring
+{
+};
+
+#endif
+
+UringEngine::UringEngine(size_t buffers, size_t size):
+    buffersCount(buffers > 0 ? buffers : 1),
+    bufferSize(size > 0 ? size : GroupFlight::k_maxPackageSize)
+{
+}
+
+UringEngine::~UringEngine()
+{
+    stop();
+}
+
+bool UringEngine::start()
+{
+#ifdef URINGENGINE_IO_URING
+    if (isRunning()) return true;
+
+    std::unique_ptr<Ring> created(new Ring);
+    if (!created->setup(buffersCount, bufferSize)) return false;
+    ring = std::move(created);
+
+    running.store(true, std::memory_order_release);
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        for (const auto &receiver: receivers)
+            arm(receiver.first);
+        ring->submit();
+    }
+
+    thread = std::thread(&UringEngine::run, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UringEngine::stop()
+{
+#ifdef URINGENGINE_IO_URING
+    if (!isRunning()) return;
+
+    {
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        running.store(false, std::memory_order_release);
+
+        // Отмена всех операций; поток движка завершится, получив их завершения
+        io_uring_sqe *sqe = ring->acquire();
+        if (sqe)
+        {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+            sqe->user_data = userData(Cancel, 0);
+            ring->push();
+        }
+
+        sqe = ring->acquire();
+        if (sqe)
+        {
+            sqe->opcode = IORING_OP_NOP;
+            sqe->user_data = userData(Wake, 0);
+            ring->push();
+        }
+
+        ring->submit();
+    }
+
+    if (thread.joinable()) thread.join();
+    ring.reset();
+#endif
+}
+
+bool UringEngine::addReceiver(int socket, Callback callback)
+{
+    if (socket < 0 || !callback) return false;
+
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (receivers.count(socket)) return false;
+
+    bool stream = false;
+
+#ifdef URINGENGINE_IO_URING
+    int type = 0;
+    socklen_t length = sizeof(type);
+    if (getsockopt(socket, SOL_SOCKET, SO_TYPE, &type, &length) == 0) stream = (type == SOCK_STREAM);
+#endif
+
+    receivers[socket] = Receiver{std::move(callback), true, stream};
+
+#ifdef URINGENGINE_IO_URING
+    if (isRunning())
+    {
+        std::lock_guard<std::mutex> submitLock(submitMutex);
+        arm(socket);
+        ring->submit();
+    }
+#endif
+
+    return true;
+}
+
+void UringEngine::removeReceiver(int socket)
+{
+    // Ожидание завершения обработчиков, уже вызванных потоком движка
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+
+    auto receiver = receivers.find(socket);
+    if (receiver == receivers.end()) return;
+
+    if (dispatching)
+    {
+        receiver->second.active = false;
+        removed = true;
+    }
+    else
+        receivers.erase(receiver);
+
+#ifdef URINGENGINE_IO_URING
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    if (!isRunning()) return;
+
+    io_uring_sqe *sqe = ring->acquire();
+    if (!sqe) return;
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = userData(Receive, static_cast<uint32_t>(socket));
+    sqe->user_data = userData(Cancel, 0);
+    ring->push();
+    ring->submit();
+#endif
+}
+
+int UringEngine::send(int socket, uint32_t host, uint16_t port,
+                      const char *data, const GroupFlight::PackSlice *slices, size_t count)
+{
+#ifdef URINGENGINE_IO_URING
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    if (!isRunning()) return -1;
+
+    size_t queued = 0;
+    for (; queued < count; queued++)
+    {
+        if (ring->freeSlots.empty()) break;
+
+        io_uring_sqe *sqe = ring->acquire();
+        if (!sqe) break;
+
+        const uint32_t index = ring->freeSlots.back();
+        ring->freeSlots.pop_back();
+
+        Ring::SendSlot &slot = ring->slots[index];
+        const GroupFlight::PackSlice &slice = slices[queued];
+        slot.data.assign(data + slice.offset, data + slice.offset + slice.size);
+
+        sqe->fd = socket;
+        sqe->user_data = userData(Send, index);
+
+        if (host != 0)
+        {
+            memset(&slot.address, 0, sizeof(slot.address));
+            slot.address.sin_family = AF_INET;
+            slot.address.sin_addr.s_addr = htonl(host);
+            slot.address.sin_port = htons(port);
+
+            slot.vector.iov_base = slot.data.data();
+            slot.vector.iov_len = slot.data.size();
+
+            memset(&slot.message, 0, sizeof(slot.message));
+            slot.message.msg_name = &slot.address;
+            slot.message.msg_namelen = sizeof(slot.address);
+            slot.message.msg_iov = &slot.vector;
+            slot.message.msg_iovlen = 1;
+
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->addr = reinterpret_cast<uint64_t>(&slot.message);
+            sqe->len = 1;
+        }
+        else
+        {
+            sqe->opcode = IORING_OP_SEND;
+            sqe->addr = reinterpret_cast<uint64_t>(slot.data.data());
+            sqe->len = static_cast<uint32_t>(slot.data.size());
+        }
+
+        ring->push();
+        ring->outstanding++;
+    }
+
+    if (queued < count) sendErrorsCount.fetch_add(count - queued, std::memory_order_relaxed);
+
+    ring->submit();
+    return static_cast<int>(queued);
+#else
+    (void)socket;
+    (void)host;
+    (void)port;
+    (void)data;
+    (void)slices;
+    (void)count;
+    return -1;
+#endif
+}
+
+UringEngine::Stats UringEngine::stats() const
+{
+    Stats result;
+    result.chunks = chunksCount.load(std::memory_order_relaxed);
+    result.rearms = rearmsCount.load(std::memory_order_relaxed);
+    result.sent = sentCount.load(std::memory_order_relaxed);
+    result.sendErrors = sendErrorsCount.load(std::memory_order_relaxed);
+    return result;
+}
+
+void UringEngine::arm(int socket)
+{
+#ifdef URINGENGINE_IO_URING
+    io_uring_sqe *sqe = ring->acquire();
+    if (!sqe) return;
+
+    // Многократный прием: буфер для каждой порции ядро берет из кольца группы k_bufferGroup
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = k_bufferGroup;
+    sqe->user_data = userData(Receive, static_cast<uint32_t>(socket));
+    ring->push();
+    ring->outstanding++;
+#else
+    (void)socket;
+#endif
+}
+
+void UringEngine::run()
+{
+#ifdef URINGENGINE_IO_URING
+    std::vector<io_uring_cqe> events;
+    events.reserve(2 * k_ringEntries);
+    std::vector<Chunk> chunks;
+    chunks.reserve(2 * k_ringEntries);
+    std::vector<int> sockets;
+    std::vector<int> rearm;
+    std::vector<int> closed;
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> submitLock(submitMutex);
+            if (!isRunning() && ring->outstanding == 0) break;
+        }
+
+        if (ringEnter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) break;
+
+        events.clear();
+        unsigned head = *ring->cqHead;
+        const unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++)
+            events.push_back(ring->cqes[head & ring->cqMask]);
+        __atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+
+        sockets.clear();
+        rearm.clear();
+        closed.clear();
+        size_t finished = 0;
+
+        for (const io_uring_cqe &event: events)
+        {
+            const Operation operation = operationOf(event.user_data);
+
+            if (operation == Send)
+            {
+                {
+                    std::lock_guard<std::mutex> submitLock(submitMutex);
+                    ring->freeSlots.push_back(valueOf(event.user_data));
+                }
+                finished++;
+
+                if (event.res < 0) sendErrorsCount.fetch_add(1, std::memory_order_relaxed);
+                else sentCount.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (operation != Receive) continue;
+
+            const int socket = static_cast<int>(valueOf(event.user_data));
+            if (std::find(sockets.begin(), sockets.end(), socket) == sockets.end()) sockets.push_back(socket);
+
+            // Прием прекращен: закончились буферы, ошибка или пустая датаграмма. Отмененный прием не возобновляется
+            if (!(event.flags & IORING_CQE_F_MORE))
+            {
+                finished++;
+                if (event.res != -ECANCELED) rearm.push_back(socket);
+            }
+        }
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            dispatching = true;
+
+            for (int socket: sockets)
+            {
+                chunks.clear();
+                bool finishedStream = false;
+
+                for (const io_uring_cqe &event: events)
+                {
+                    if (operationOf(event.user_data) != Receive || static_cast<int>(valueOf(event.user_data)) != socket)
+                        continue;
+
+                    if (event.res > 0 && (event.flags & IORING_CQE_F_BUFFER))
+                    {
+                        const uint16_t id = static_cast<uint16_t>(event.flags >> IORING_CQE_BUFFER_SHIFT);
+                        chunks.push_back(Chunk{ring->buffer(id), static_cast<size_t>(event.res)});
+                    }
+                    else if (event.res == 0)
+                        finishedStream = true;
+                }
+
+                chunksCount.fetch_add(chunks.size(), std::memory_order_relaxed);
+
+                // Сокет мог быть отключен, пока ожидались завершения
+                auto receiver = receivers.find(socket);
+                if (receiver == receivers.end() || !receiver->second.active) continue;
+
+                finishedStream = finishedStream && receiver->second.stream;
+                if (finishedStream) closed.push_back(socket);
+
+                if (!chunks.empty()) receiver->second.callback(chunks.data(), chunks.size());
+                if (finishedStream && receiver->second.active) receiver->second.callback(nullptr, 0);
+            }
+
+            dispatching = false;
+            if (removed)
+            {
+                removed = false;
+                for (auto receiver = receivers.begin(); receiver != receivers.end(); )
+                {
+                    if (receiver->second.active) ++receiver;
+                    else receiver = receivers.erase(receiver);
+                }
+            }
+
+            // Буферы возвращаются в кольцо после обработки, затем прием возобновляется
+            for (const io_uring_cqe &event: events)
+                if (operationOf(event.user_data) == Receive && (event.flags & IORING_CQE_F_BUFFER))
+                    ring->recycle(static_cast<uint16_t>(event.flags >> IORING_CQE_BUFFER_SHIFT));
+            ring->publish();
+
+            std::lock_guard<std::mutex> submitLock(submitMutex);
+            ring->outstanding -= finished;
+
+            if (isRunning())
+            {
+                for (int socket: rearm)
+                {
+                    if (!receivers.count(socket)) continue;
+                    if (std::find(closed.begin(), closed.end(), socket) != closed.end()) continue;
+                    arm(socket);
+                    rearmsCount.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            ring->submit();
+        }
+    }
+#endif
+}
@@ -0,0 +1,112 @@
+#ifndef URINGENGINE_H
+#define URINGENGINE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "parser.h"
+
+//! \brief Поток ввода-вывода на io_uring (Linux 6.0+)
+//! Прием: на каждый сокет - одна многократная (multishot) операция recv, данные которой ядро
+//! записывает в буферы из кольца предоставленных буферов (provided buffer ring), зарегистрированного
+//! при start(). Системный вызов не нужен ни на каждую датаграмму, ни на каждую порцию: поток движка
+//! только ожидает завершений. Отправка: группа операций за один вызов io_uring_enter.
+//! Если ядро не поддерживает нужных операций, start() возвращает false - тогда используется IoEngine (epoll).
+//! Движок используется только для приема и отправки UDP в DataTransmitter. Сокеты TCP он обслуживать
+//! может, но TCP автопилота (TcpUdpTranslator - QTcpSocket, TcpUdpBridge - IoEngine) через него не идет
+class UringEngine
+{
+public:
+    //! Принятые данные: датаграмма (UDP) или очередная порция потока (TCP)
+    struct Chunk
+    {
+        const char *data;
+        size_t size;
+    };
+
+    //! \brief Обработчик принятых данных, вызывается в потоке движка
+    //! Данные действительны только во время вызова; count = 0 - соединение закрыто (TCP)
+    using Callback = std::function<void(const Chunk *chunks, size_t count)>;
+
+    //! \param buffers - количество буферов приема (округляется до степени двойки)
+    //! \param bufferSize - размер буфера приема
+    explicit UringEngine(size_t buffers = 64, size_t bufferSize = GroupFlight::k_maxPackageSize);
+    ~UringEngine();
+
+    UringEngine(const UringEngine &) = delete;
+    UringEngine &operator=(const UringEngine &) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    //! \brief Прием из сокета; callback вызывается в потоке движка
+    bool addReceiver(int socket, Callback callback);
+
+    //! \brief Отключение сокета; после возврата callback больше не вызывается
+    //! Может вызываться и из самого callback
+    void removeReceiver(int socket);
+
+    //! \brief Постановка группы датаграмм в очередь отправки; каждая датаграмма - срез общего буфера
+    //! Данные копируются, буфер можно использовать сразу после возврата
+    //! \param host, port - адрес получателя (порядок байт узла); host = 0 - сокет с установленным соединением
+    //! \return количество датаграмм, поставленных в очередь, -1 - движок не запущен
+    int send(int socket, uint32_t host, uint16_t port,
+             const char *data, const GroupFlight::PackSlice *slices, size_t count);
+
+    //! \brief Вызов выполняется в потоке движка
+    bool isIoThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+    //! Статистика работы движка
+    struct Stats
+    {
+        uint64_t chunks = 0;        //!< Принято датаграмм (порций)
+        uint64_t rearms = 0;        //!< Повторных запусков приема (закончились буферы)
+        uint64_t sent = 0;          //!< Отправлено датаграмм
+        uint64_t sendErrors = 0;    //!< Ошибок отправки, в том числе нехватки мест в очереди
+    };
+
+    Stats stats() const;
+
+private:
+    struct Ring;
+
+    void run();
+    void arm(int socket);
+
+    size_t buffersCount;
+    size_t bufferSize;
+
+    std::unique_ptr<Ring> ring;
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    // Очередь отправки и переустановка приема обращаются к очереди заявок из разных потоков
+    std::mutex submitMutex;
+
+    struct Receiver
+    {
+        Callback callback;
+        bool active;
+        bool stream;    // TCP: нулевой прием - закрытие соединения
+    };
+
+    std::recursive_mutex mutex;
+    std::unordered_map<int, Receiver> receivers;
+    bool dispatching = false;
+    bool removed = false;
+
+    std::atomic<uint64_t> chunksCount{0};
+    std::atomic<uint64_t> rearmsCount{0};
+    std::atomic<uint64_t> sentCount{0};
+    std::atomic<uint64_t> sendErrorsCount{0};
+};
+
+#endif // URINGENGINE_H